@@ -0,0 +1,50 @@
+#ifndef ANIMATION_MODE_H
+#define ANIMATION_MODE_H
+
+#include <stdint.h>
+#include "config.h"
+
+// What the strip, segments and layers can run. The numbers are stored in
+// presets, segments.json and schedule.json, so new modes go at the end.
+enum AnimationMode {
+    ANIMATION_STATIC = 0,
+    ANIMATION_RAINBOW,
+    ANIMATION_CHASE,
+    ANIMATION_TWINKLE,
+    ANIMATION_FADE,
+    ANIMATION_SPARKLE,
+    ANIMATION_CANDY_CANE,
+    ANIMATION_SNOW,
+    ANIMATION_FIRE,
+    // Spatial animations (use calibration data)
+    ANIMATION_SPATIAL_WAVE,
+    ANIMATION_SPATIAL_RAINBOW,
+    ANIMATION_SPATIAL_PULSE,
+    ANIMATION_SPATIAL_ROTATE,
+    ANIMATION_SPATIAL_PLANES,
+    // Sweep animations (walk cached calibration orderings)
+    ANIMATION_SWEEP_WIPE,
+    ANIMATION_SWEEP_RIPPLE,
+    ANIMATION_SWEEP_ANGULAR,
+    ANIMATION_CUSTOM,
+    ANIMATION_SEQUENCE,     // Frames from a FrameSource (FSEQ playback)
+    // Audio-reactive animations (need an AudioInput source)
+    ANIMATION_AUDIO_SPECTRUM,
+    ANIMATION_AUDIO_BEAT,
+    // Noise animations (simplex noise at calibrated positions, palette-mapped)
+    ANIMATION_NOISE_CLOUDS,
+    ANIMATION_NOISE_LAVA,
+    ANIMATION_NOISE_AURORA,
+    // Particle animations (pooled particles splatted onto calibrated LEDs)
+    ANIMATION_PARTICLE_SNOW,
+    ANIMATION_PARTICLE_FIREWORKS,
+    ANIMATION_PARTICLE_EMBERS
+};
+
+// Custom is drawn from outside and Sequence plays frames, so neither has
+// anything to show in a segment, layer or scheduled scene
+inline bool animationHasContent(uint8_t mode) {
+    return mode < MAX_ANIMATIONS && mode != ANIMATION_CUSTOM && mode != ANIMATION_SEQUENCE;
+}
+
+#endif // ANIMATION_MODE_H
@@ -0,0 +1,71 @@
+#ifndef AUDIO_ANALYZER_H
+#define AUDIO_ANALYZER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "config.h"
+
+// What the audio task publishes for the renderer
+struct AudioSnapshot {
+    uint8_t bands[AUDIO_BANDS];  // Loudness per band, 0..255, bass first
+    uint8_t level;               // Overall loudness, 0..255
+    uint32_t beats;              // Onsets detected so far
+    uint32_t blocks;             // Blocks analysed so far (0 = no audio yet)
+};
+
+// Band energies and beat onsets from mono PCM.
+//
+// Every AUDIO_HOP_SIZE samples the last AUDIO_FFT_SIZE are windowed and run
+// through a Q15 fixed-point FFT (scaled by 1/2 per stage, so it can't
+// overflow). Band levels follow their own recent peak, so quiet and loud
+// rooms both use the full 0..255 range. A beat is a jump in bass energy
+// well above its running average.
+//
+// The result is published as a seqlock: one task feeds, any number of
+// others read() without locks and without ever seeing a half-written
+// snapshot. Pure C++ so tools/audio_tool can run it on WAV files.
+class AudioAnalyzer {
+public:
+    AudioAnalyzer();
+    void reset();
+
+    // Append samples; returns how many blocks were analysed
+    uint16_t feed(const int16_t* samples, size_t count);
+    bool lastBlockWasBeat() const { return _lastBeat; }
+
+    // Latest snapshot. Safe from any task; false if the writer kept
+    // interrupting (out is then left unchanged).
+    bool read(AudioSnapshot& out) const;
+
+private:
+    int16_t _ring[AUDIO_FFT_SIZE];
+    uint16_t _ringPos;
+    uint16_t _sinceHop;
+
+    int16_t _window[AUDIO_FFT_SIZE];  // Hann, Q15
+    int16_t _cos[AUDIO_FFT_SIZE / 2];
+    int16_t _sin[AUDIO_FFT_SIZE / 2];
+    int16_t _re[AUDIO_FFT_SIZE];
+    int16_t _im[AUDIO_FFT_SIZE];
+    uint16_t _bandStart[AUDIO_BANDS + 1];  // FFT bins
+
+    float _bandPeak[AUDIO_BANDS];  // dB, decays slowly
+    float _levelPeak;
+    float _prevBass;
+    float _fluxMean;
+    float _fluxVar;
+    uint16_t _sinceBeat;
+    bool _lastBeat;
+
+    AudioSnapshot _state;              // Writer's working copy
+    AudioSnapshot _published;
+    std::atomic<uint32_t> _sequence;   // Odd while _published is being written
+
+    void analyse();
+    void fft();
+    uint8_t toLevel(float db, float& peak, uint8_t previous);
+    void publish();
+};
+
+#endif // AUDIO_ANALYZER_H
@@ -0,0 +1,51 @@
+#ifndef AUDIO_INPUT_H
+#define AUDIO_INPUT_H
+
+#include <Arduino.h>
+#include <WiFiUdp.h>
+#include <atomic>
+#include "config.h"
+#include "audio_analyzer.h"
+
+// Feeds the analyzer from an I2S microphone or a UDP PCM stream on its own
+// task (core 0), so the FFT never competes with the LED loop. The source
+// can be switched from any task; the audio task picks it up.
+//
+// UDP packets are raw signed 16-bit little-endian mono at AUDIO_SAMPLE_RATE,
+// for example:  ffmpeg -re -i song.mp3 -ac 1 -ar 16000 -f s16le udp://<ip>:7000?pkt_size=512
+class AudioInput {
+public:
+    AudioInput(AudioAnalyzer& analyzer);
+    void begin();
+
+    const AudioAnalyzer& getAnalyzer() const { return _analyzer; }
+
+    void setSource(uint8_t source);
+    uint8_t getSource() const { return _requested; }
+    bool isReceiving() const;  // Samples arrived in the last second
+
+    // CPU time spent analysing one block (average of the last second, peak)
+    uint32_t getBlockMicros() const { return _blockMicros; }
+    uint32_t getPeakBlockMicros() const { return _peakBlockMicros; }
+
+private:
+    AudioAnalyzer& _analyzer;
+    std::atomic<uint8_t> _requested;
+    uint8_t _source;  // Audio task only
+    WiFiUDP _udp;
+    volatile unsigned long _lastSamples;
+    volatile uint32_t _blockMicros;
+    volatile uint32_t _peakBlockMicros;
+    uint32_t _statMicros;
+    uint32_t _statBlocks;
+    unsigned long _statStart;
+
+    static void taskEntry(void* param);
+    void run();
+    void openSource(uint8_t source);
+    void closeSource();
+    size_t readI2S(int16_t* samples, size_t max);
+    size_t readUdp(int16_t* samples, size_t max);
+};
+
+#endif // AUDIO_INPUT_H
@@ -6,11 +6,18 @@
 #include <SPI.h>
 #include <ArduinoJson.h>
 #include "config.h"
+#include "state_events.h"
+#include "led_position.h"
+#include "spatial_index.h"
 
-struct LEDPosition {
-    float x;  // -1.0 to 1.0 normalized coordinates
-    float y;  // -1.0 to 1.0
-    float z;  // -1.0 to 1.0
+// Cached orderings of the LEDs
+enum SortOrder {
+    SORT_BY_X = 0,
+    SORT_BY_Y,
+    SORT_BY_Z,
+    SORT_BY_ANGLE,   // Around the Y axis
+    SORT_BY_RADIUS,  // Distance from center
+    SORT_ORDER_COUNT
 };
 
 class Calibration {
@@ -26,6 +33,24 @@ public:
     LEDPosition getPosition(uint16_t index) const;
     LEDPosition* getAllPositions() { return _positions; }
 
+    // Replace every position at once (one index rebuild, one change event)
+    void setPositions(const LEDPosition* positions);
+
+    // Apply a batch of edits atomically: nothing changes if any index is out
+    // of range. One revision bump and one change event for the whole batch.
+    bool setPositions(const uint16_t* indices, const LEDPosition* positions, uint16_t count);
+
+    // Incremented whenever any position changes (for caches derived from positions)
+    uint32_t getRevision() const { return _revision; }
+
+    // Grid index for sphere / box / nearest-neighbour queries, kept in step with positions
+    const SpatialIndex& getSpatialIndex() const { return _spatialIndex; }
+
+    // Orderings computed once per calibration change.
+    // getOrder() lists LED indices in sorted order; getRanks() gives each LED's place in it.
+    const uint16_t* getOrder(SortOrder order) const;
+    const uint16_t* getRanks(SortOrder order) const;
+
     // Get sorted indices for directional animations
     // Returns indices sorted by position along an axis
     void getSortedByAxis(uint8_t axis, uint16_t* outIndices) const;  // 0=X, 1=Y, 2=Z
@@ -42,18 +67,31 @@ public:
     void resetToLinear();  // Default: evenly spaced along X axis
 
     // Calibration mode helpers
-    void setCalibrationLED(int16_t index) { _calibrationLED = index; }
+    void setCalibrationLED(int16_t index);
     int16_t getCalibrationLED() const { return _calibrationLED; }
     bool isCalibrating() const { return _calibrationLED >= 0; }
 
+    // Change notifications (calibration LED, positions)
+    void addListener(StateListener listener, void* context) { _events.addListener(listener, context); }
+
 private:
     LEDPosition _positions[NUM_LEDS];
+    SpatialIndex _spatialIndex;
     int16_t _calibrationLED;  // -1 = not calibrating
+    uint32_t _revision;
+    StateNotifier _events;
+
+    // Sort cache, rebuilt lazily when _revision moves on
+    mutable uint16_t _order[SORT_ORDER_COUNT][NUM_LEDS];
+    mutable uint16_t _rank[SORT_ORDER_COUNT][NUM_LEDS];
+    mutable uint32_t _orderRevision;
+    mutable bool _ordersValid;
     bool _sdAvailable;
     SPIClass* _sdSPI;
 
     bool initSD();
     bool ensureDirectory(const char* path);
+    void updateOrders() const;
 };
 
 #endif // CALIBRATION_H
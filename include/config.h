@@ -24,6 +24,13 @@
 #define COLOR_ORDER RGB
 #define DEFAULT_BRIGHTNESS 128 // 0-255
 
+// ============================================
+// Spatial Index
+// ============================================
+// Uniform grid over the normalized -1..1 cube used for region queries
+#define SPATIAL_GRID_SIZE 8      // Cells per axis
+#define SPATIAL_MAX_NEAREST 16   // Largest k for nearest-neighbour queries
+
 // ============================================
 // Display Configuration - ST7789T3
 // ============================================
@@ -41,14 +48,24 @@
 #define LCD_HEIGHT  320
 #define LCD_ROTATION 0   // 0, 1, 2, or 3 (90 degree increments)
 
+// LVGL draw buffer strategy
+//   DISPLAY_BUFFER_PARTIAL: two DISPLAY_BUFFER_LINES-high bands in internal DMA RAM
+//   DISPLAY_BUFFER_FULL:    two full-frame buffers in PSRAM, LVGL direct mode
+#define DISPLAY_BUFFER_PARTIAL 0
+#define DISPLAY_BUFFER_FULL    1
+#define DISPLAY_BUFFER_MODE    DISPLAY_BUFFER_PARTIAL
+#define DISPLAY_BUFFER_LINES   40
+
 // ============================================
 // Touch Configuration - CST816D
 // ============================================
 // I2C interface pins for touch controller (from Waveshare ESP32-S3-LCD-2 demo)
 #define TOUCH_SDA   48   // I2C Data
 #define TOUCH_SCL   47   // I2C Clock
+#define TOUCH_INT   46   // Touch interrupt (active low), -1 = poll over I2C instead
 
 #define TOUCH_I2C_ADDR 0x15  // CST816D I2C address
+#define TOUCH_HELD_POLL_MS 40 // Re-read interval while pressed, in case a release edge is missed
 
 // ============================================
 // SD Card Configuration
@@ -62,6 +79,16 @@
 // Calibration file path on SD card
 #define CALIBRATION_FILE_PATH "/xmas/calibration.json"
 
+// ============================================
+// Calibration Import
+// ============================================
+#define TRIANGULATION_MAX_VIEWS 8        // Camera views accepted by /api/calibration/import
+#define TRIANGULATION_MIN_SEPARATION 10  // Views closer than this (degrees) can't fix depth
+#define TRIANGULATION_PASSES 4           // Solve / re-centre iterations
+#define CALIBRATION_IMPORT_MAX_BODY 32768
+#define GRAYCODE_DEFAULT_HOLD 250        // ms per structured-light frame
+#define GRAYCODE_MIN_HOLD 20             // Faster than this and FastLED.show() dominates
+
 // ============================================
 // WiFi Configuration
 // ============================================
@@ -77,18 +104,167 @@
 // Web Server Configuration
 // ============================================
 #define WEB_SERVER_PORT 80
+#define WEB_EVENT_INTERVAL 50    // Minimum ms between pushed state updates (server-sent events)
 
 // ============================================
 // Animation Settings
 // ============================================
 #define DEFAULT_ANIMATION_SPEED 50 // ms between frames
-#define MAX_ANIMATIONS 15
+#define MAX_ANIMATIONS 27
+#define ANIMATION_PHASE_STEPS 126    // Frames per animation cycle (phase advances 2*PI / 126)
+
+// Periodic animations can play one precomputed cycle from PSRAM
+#define FRAME_CACHE_DEFAULT true
+#define FRAME_CACHE_PSRAM_RESERVE (256 * 1024)  // Free PSRAM the cache must leave untouched
+
+// Transitions between animations
+#define TRANSITION_LINEAR 0          // Crossfade
+#define TRANSITION_WIPE   1          // New animation sweeps in along a calibration axis
+#define TRANSITION_DEFAULT_TYPE TRANSITION_LINEAR
+#define TRANSITION_DEFAULT_MS 800    // 0 = switch instantly
+#define TRANSITION_DEFAULT_AXIS 1    // Wipe axis: 0 = X, 1 = Y, 2 = Z
+#define TRANSITION_FRAME_INTERVAL 16 // ms between composited frames while transitioning
+
+// Overlay layers composited over the main animation
+#define OVERLAY_LAYERS 3
+
+// Strip segments: named index ranges running their own animation
+#define MAX_SEGMENTS 4
+#define SEGMENT_NAME_LENGTH 12
+#define SEGMENTS_FILE_PATH "/xmas/segments.json"
+#define SEGMENTS_SAVE_DELAY 2000  // ms after the last change before writing to SD
+
+#define FRAME_POOL_BUFFERS (3 + OVERLAY_LAYERS)  // Current + outgoing animation + segments + overlays
+
+// Noise animations: 3D simplex noise sampled at each LED's calibrated position
+#define NOISE_SCALE 1.5f             // Lattice cells per unit of position (the tree spans 2 units)
+#define NOISE_OCTAVES 2              // Each one twice the detail and half the amplitude of the last
+#define NOISE_GRADIENTS 64           // Rotating gradient vectors, power of two
+#define NOISE_FLOW_STEP 96           // Gradient rotation per frame, 1/65536 turn
+
+// Fire: heat simulated on a coarse grid around the tree (angle x height)
+#define FIRE_GRID_COLUMNS 12         // Around the vertical axis (wraps)
+#define FIRE_GRID_ROWS 16            // Bottom to top
+#define FIRE_GRIDS 4                 // Fire animations that can run at once (main, layers, segments)
+#define FIRE_COOLING 55              // Higher = shorter flames
+#define FIRE_SPARKING 120            // Chance (of 255) per column per frame of a new spark
+#define FIRE_MIN_HEIGHT 0.1f         // Calibrated height below which fire runs along the strip instead
+
+// Particle animations: a pooled particle system splatted onto nearby LEDs
+#define PARTICLE_CAPACITY 4096       // Pool size (one PSRAM allocation at boot)
+#define PARTICLE_EMITTERS 3          // Snowfall, fireworks, embers
+#define PARTICLE_RADIUS 0.25f        // LEDs this close to a particle pick up its light
+#define PARTICLE_MAX_STEP_MS 100     // Longest integration step, so a stall doesn't fling particles
+#define PARTICLE_IDLE_MS 1000        // An emitter stops once nothing has drawn it for this long
+
+// ============================================
+// Output Stage
+// ============================================
+// Gamma is applied per channel through 256-entry LUTs with 8 fractional
+// bits; the fraction is carried between frames (temporal dithering)
+#define OUTPUT_GAMMA_R 2.2f
+#define OUTPUT_GAMMA_G 2.2f
+#define OUTPUT_GAMMA_B 2.2f
+#define OUTPUT_COLOR_CORRECTION 0xFFFFFF  // Per-channel scale as 0xRRGGBB (FastLED's TypicalLEDStrip is 0xFFB0F0)
+#define OUTPUT_DITHER 1              // 0 = round to nearest instead
+#define OUTPUT_MAPPING 0             // 0 = normal, 1 = reversed, 2 = mirrored
+
+// Pixel kernels: use the ESP32-S3 PIE vector unit when available
+#define PIXEL_KERNELS_SIMD 1
+#define OUTPUT_REFRESH_INTERVAL 8    // ms between output refreshes while dithering
+
+// ============================================
+// Power Limiting
+// ============================================
+// Current is estimated from the emitted channel values in the output pass
+#define LED_MA_PER_CHANNEL 20        // Draw of one colour channel at full duty
+#define LED_IDLE_MA 1                // Quiescent draw per pixel
+#define POWER_BUDGET_MA 2500         // Per supply / output (0 = no limit)
+#define POWER_MAX_OUTPUTS 4          // Strips with separate supplies
+#define POWER_LIMIT_HYSTERESIS 8     // Headroom (of 256) needed before the limiter releases
+#define POWER_LIMIT_RELEASE 16       // Release rate divisor: larger = slower recovery
+
+// ============================================
+// Audio Input
+// ============================================
+#define AUDIO_SOURCE_OFF 0
+#define AUDIO_SOURCE_I2S 1           // I2S MEMS microphone (INMP441, SPH0645...)
+#define AUDIO_SOURCE_UDP 2           // Raw s16le mono PCM at AUDIO_SAMPLE_RATE over UDP
+#define AUDIO_DEFAULT_SOURCE AUDIO_SOURCE_OFF
+
+// I2S microphone pins (free camera-header pins; change to match the wiring)
+#define AUDIO_I2S_SCK 15
+#define AUDIO_I2S_WS  16
+#define AUDIO_I2S_SD  17
+#define AUDIO_I2S_SHIFT 14           // 32-bit mic sample >> this = 16-bit PCM (lower = more gain)
+#define AUDIO_UDP_PORT 7000
+
+// Analysis: fixed-point FFT on the audio task
+#define AUDIO_SAMPLE_RATE 16000
+#define AUDIO_FFT_SIZE 512           // 32 ms window, power of two
+#define AUDIO_HOP_SIZE 256           // New result every 16 ms (50% overlap)
+#define AUDIO_BANDS 8                // Log-spaced from AUDIO_MIN_FREQ to Nyquist, bass first
+#define AUDIO_MIN_FREQ 60
+#define AUDIO_DYNAMIC_RANGE_DB 30    // Range below the recent peak mapped onto 0..255
+#define AUDIO_NOISE_GATE_DB 24       // Quieter bands read 0
+#define AUDIO_RELEASE 20             // Level lost per block when a band drops (attack is instant)
+#define AUDIO_BEAT_THRESHOLD 2.0f    // Onset when the bass rise beats its mean by this many std devs
+#define AUDIO_BEAT_MIN_RISE_DB 4.0f  // ...and by at least this much
+#define AUDIO_BEAT_MIN_INTERVAL_MS 250
+#define AUDIO_PULSE_MS 400           // Beat ring travel time, centre to edge
+#define AUDIO_TASK_STACK 4096
+#define AUDIO_TASK_PRIORITY 2
+
+// ============================================
+// Show Scheduler
+// ============================================
+// A looping playlist of scenes, overridden by time-of-day rules
+#define SCHEDULE_MAX_SCENES 8
+#define SCHEDULE_MAX_RULES 8
+#define SCHEDULE_FILE_PATH "/xmas/schedule.json"
+#define SCHEDULE_TIMEZONE "UTC0"             // POSIX TZ, e.g. "GMT0BST,M3.5.0/1,M10.5.0"
+#define SCHEDULE_NTP_SERVER "pool.ntp.org"   // "" = only set the clock via /api/clock
+
+// ============================================
+// Sequence Playback
+// ============================================
+// xLights FSEQ v2 files streamed from the SD card
+#define SEQUENCE_DIR "/xmas/sequences"
+#define FSEQ_START_CHANNEL 0         // First file channel mapped to LED 0 (3 channels per LED)
+#define FSEQ_READ_AHEAD 4096         // Bytes read from the card at a time
+#define FSEQ_MAX_SPANS 8             // Sparse ranges overlapping the strip
+#define SEQUENCE_NAME_LENGTH 32
+
+// ============================================
+// Presets
+// ============================================
+// Snapshots of the full render state, kept as binary records in NVS
+#define MAX_PRESETS 8
+#define PRESET_NAME_LENGTH 16
 
 // ============================================
 // UI Settings
 // ============================================
 #define UI_UPDATE_INTERVAL 16    // ~60fps for LVGL
 #define DISPLAY_TIMEOUT 30000    // Screen dim after 30 seconds of inactivity (0 = disabled)
+#define DISPLAY_OFF_TIMEOUT 120000 // Panel sleeps this long after dimming (0 = stay dimmed)
+#define DISPLAY_DIM_LEVEL 30     // Backlight level while dimmed
+#define DISPLAY_DIMMED_REFRESH 250 // Minimum ms between LVGL passes while dimmed
+
+// Live LED preview on the control tab
+#define PREVIEW_STRIP    0       // LEDs in strip order, downsampled to fit
+#define PREVIEW_SPATIAL  1       // LEDs projected onto the calibrated X/Y plane
+#define UI_PREVIEW_MODE  PREVIEW_STRIP
+#define UI_PREVIEW_INTERVAL 50   // ms between preview refreshes
+
+// ============================================
+// Diagnostics
+// ============================================
+#define RUN_BENCHMARKS 0         // Run startup benchmarks and print results to serial
+#define DISPLAY_BENCHMARK_FRAMES 20
+#define OUTPUT_BENCHMARK_FRAMES 200
+#define PIXEL_BENCHMARK_PIXELS 2048
+#define PIXEL_BENCHMARK_ROUNDS 100
 
 // ============================================
 // Animation Names for UI
@@ -108,7 +284,19 @@ static const char* ANIMATION_NAMES[] = {
     "Pulse",
     "Rotate",
     "Planes",
-    "Custom"
+    "Wipe",
+    "Ripple",
+    "Sweep",
+    "Custom",
+    "Sequence",
+    "Spectrum",
+    "Beat",
+    "Clouds",
+    "Lava",
+    "Aurora",
+    "Snowfall",
+    "Fireworks",
+    "Embers"
 };
 
 #endif // CONFIG_H
@@ -4,6 +4,12 @@
 #include <Arduino.h>
 #include <lvgl.h>
 
+enum DisplayPowerState {
+    DISPLAY_POWER_ACTIVE,   // Full backlight, LVGL at full rate
+    DISPLAY_POWER_DIMMED,   // Low backlight, LVGL at a slow adaptive rate
+    DISPLAY_POWER_OFF       // Backlight off, panel in SLPIN, LVGL not run
+};
+
 class Display {
 public:
     Display();
@@ -16,21 +22,33 @@ public:
 
     // Activity tracking for screen timeout
     void resetActivityTimer();
-    bool isDisplayDimmed() const { return _isDimmed; }
+    bool isDisplayDimmed() const { return _powerState != DISPLAY_POWER_ACTIVE; }
+    bool isActive() const { return _powerState == DISPLAY_POWER_ACTIVE; }
+    DisplayPowerState getPowerState() const { return _powerState; }
 
     // Get display dimensions
     uint16_t getWidth() const;
     uint16_t getHeight() const;
 
+    // Draw buffer strategy (DISPLAY_BUFFER_PARTIAL / DISPLAY_BUFFER_FULL)
+    bool setBufferMode(uint8_t mode);
+    uint8_t getBufferMode() const { return _bufferMode; }
+
     // Debug: draw a colored marker at position
     void drawDebugMarker(int step);
 
+    // Compare redraw time and internal RAM use of each buffer mode
+    void runBenchmark();
+
 private:
     uint8_t _backlightLevel;
     unsigned long _lastActivityTime;
-    bool _isDimmed;
+    DisplayPowerState _powerState;
+    unsigned long _nextRefresh;
+    uint8_t _bufferMode;
 
     // LVGL display buffer
+    static lv_disp_t* _disp;
     static lv_disp_draw_buf_t _drawBuf;
     static lv_color_t* _buf1;
     static lv_color_t* _buf2;
@@ -41,6 +59,9 @@ private:
     static void displayFlush(lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t* color_p);
     static void touchpadRead(lv_indev_drv_t* drv, lv_indev_data_t* data);
 
+    bool allocateBuffers(uint8_t mode);
+    void freeBuffers();
+    void setPowerState(DisplayPowerState state);
     void checkScreenTimeout();
 };
 
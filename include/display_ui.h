@@ -3,9 +3,12 @@
 
 #include <Arduino.h>
 #include <lvgl.h>
+#include <atomic>
 #include "led_controller.h"
 #include "calibration.h"
 #include "wifi_manager.h"
+#include "led_preview.h"
+#include "preset_store.h"
 
 // Tab indices
 enum TabIndex {
@@ -16,7 +19,8 @@ enum TabIndex {
 
 class DisplayUI {
 public:
-    DisplayUI(LEDController& ledController, Calibration& calibration, WiFiManager& wifiManager);
+    DisplayUI(LEDController& ledController, Calibration& calibration, WiFiManager& wifiManager,
+              PresetStore& presets);
     void begin();
     void update();
     void syncState();
@@ -25,6 +29,7 @@ private:
     LEDController& _ledController;
     Calibration& _calibration;
     WiFiManager& _wifiManager;
+    PresetStore& _presets;
 
     // Main containers
     lv_obj_t* _screen;
@@ -35,6 +40,8 @@ private:
 
     // Control tab - bento grid
     lv_obj_t* _controlContainer;
+    lv_obj_t* _previewTile;
+    LEDPreview _preview;
     lv_obj_t* _powerTile;
     lv_obj_t* _powerIcon;
     lv_obj_t* _patternTile;
@@ -47,6 +54,8 @@ private:
     // Pattern selector overlay
     lv_obj_t* _patternOverlay;
     lv_obj_t* _patternList;
+    lv_obj_t* _presetItems[MAX_PRESETS];  // Saved presets, listed after the patterns
+    lv_obj_t* _presetLabels[MAX_PRESETS];
 
     // Brightness overlay
     lv_obj_t* _brightnessOverlay;
@@ -72,6 +81,18 @@ private:
     lv_obj_t* _settingsContainer;
     lv_obj_t* _wifiIcon;
     lv_obj_t* _ipValue;
+    lv_obj_t* _segmentRows[MAX_SEGMENTS];
+    lv_obj_t* _segmentLabels[MAX_SEGMENTS];
+    lv_obj_t* _segmentEmpty;
+
+    // State change events not yet applied (set from any task, drained in update())
+    std::atomic<uint32_t> _pendingEvents;
+
+    // Values currently shown on the control tiles, to skip no-op redraws
+    int8_t _shownPower;
+    int16_t _shownAnimation;
+    int16_t _shownBrightness;
+    int32_t _shownColor;
 
     // Build UI
     void createTabBar();
@@ -84,26 +105,38 @@ private:
     void switchTab(int tab);
     void showOverlay(lv_obj_t* overlay);
     void hideOverlay(lv_obj_t* overlay);
+    bool isOverlayVisible() const;
 
     // Event handlers
     static void onTabSelect(lv_event_t* e);
+    static void onPreviewTap(lv_event_t* e);
     static void onPowerTap(lv_event_t* e);
     static void onPatternTap(lv_event_t* e);
     static void onBrightnessTap(lv_event_t* e);
     static void onColorTap(lv_event_t* e);
     static void onOverlayClose(lv_event_t* e);
     static void onPatternSelect(lv_event_t* e);
+    static void onPresetSelect(lv_event_t* e);
     static void onBrightnessChange(lv_event_t* e);
     static void onColorSelect(lv_event_t* e);
     static void onCalibPrev(lv_event_t* e);
     static void onCalibNext(lv_event_t* e);
     static void onCalibPosChange(lv_event_t* e);
     static void onCalibSave(lv_event_t* e);
+    static void onSegmentTap(lv_event_t* e);
+    static void onStateEvent(StateEvent event, void* context);
 
     // Helpers
+    void applyStateEvents(uint32_t events);
     void updateControlTiles();
+    void updatePowerTile();
+    void updatePatternTile();
+    void updateBrightnessTile();
+    void updateColorTile();
     void updateCalibrationUI();
     void updateWifiStatus();
+    void updateSegmentList();
+    void updatePresetList();
 };
 
 extern DisplayUI* displayUI;
@@ -0,0 +1,92 @@
+#ifndef FIRE_GRID_H
+#define FIRE_GRID_H
+
+#include <FastLED.h>
+#include "config.h"
+#include "led_position.h"
+
+// Where an LED reads the heat grid: the cell below-left of it and how far
+// it sits towards the next column and row (0..255)
+struct FireSample {
+    uint8_t column;
+    uint8_t row;
+    uint8_t columnWeight;
+    uint8_t rowWeight;
+};
+
+// Heat for one running fire animation, simulated on a FIRE_GRID_COLUMNS x
+// FIRE_GRID_ROWS grid wrapped round the tree. Each step cools every cell,
+// carries heat up a row (spreading a little sideways) and drops sparks into
+// the bottom rows, so the work per frame depends on the grid, not the LEDs.
+struct FireGrid {
+    uint8_t heat[FIRE_GRID_ROWS][FIRE_GRID_COLUMNS];
+
+    void clear() { memset(heat, 0, sizeof(heat)); }
+    void step(uint8_t cooling, uint8_t sparking);
+
+    // Bilinear heat at an LED's sample point
+    uint8_t sample(const FireSample& s) const {
+        uint8_t nextColumn = s.column + 1 < FIRE_GRID_COLUMNS ? s.column + 1 : 0;
+        uint8_t nextRow = s.row + 1 < FIRE_GRID_ROWS ? s.row + 1 : s.row;
+        const uint8_t* lower = heat[s.row];
+        const uint8_t* upper = heat[nextRow];
+        uint8_t low = lerp8by8(lower[s.column], lower[nextColumn], s.columnWeight);
+        uint8_t high = lerp8by8(upper[s.column], upper[nextColumn], s.columnWeight);
+        return lerp8by8(low, high, s.rowWeight);
+    }
+};
+
+// Fixed set of fire grids, so fire state belongs to an animation instance
+// without touching the heap (same idea as FrameBufferPool)
+class FireGridPool {
+public:
+    FireGridPool() : _used(0) {}
+
+    // A cleared grid, or nullptr when every grid is taken
+    FireGrid* acquire() {
+        for (uint8_t i = 0; i < FIRE_GRIDS; i++) {
+            if (!(_used & (1U << i))) {
+                _used |= (1U << i);
+                _grids[i].clear();
+                return &_grids[i];
+            }
+        }
+        return nullptr;
+    }
+
+    void release(FireGrid* grid) {
+        for (uint8_t i = 0; i < FIRE_GRIDS; i++) {
+            if (&_grids[i] == grid) {
+                _used &= ~(1U << i);
+                return;
+            }
+        }
+    }
+
+private:
+    FireGrid _grids[FIRE_GRIDS];
+    uint16_t _used;
+};
+
+// Each LED's sample point in the grid, from its calibrated angle round the
+// vertical axis and its height. Worked out once per calibration change.
+class FireLayout {
+public:
+    FireLayout() : _spatial(false) {}
+
+    void prepare(const LEDPosition* positions);
+
+    // False when the calibration is too flat to have a bottom and top;
+    // fire then runs along the strip as a single column
+    bool isSpatial() const { return _spatial; }
+    const FireSample& get(uint16_t led) const { return _samples[led]; }
+
+    // Sample point k of count along one column (the strip fallback)
+    static FireSample alongStrip(uint16_t k, uint16_t count);
+
+private:
+    FireSample _samples[NUM_LEDS];
+    bool _spatial;
+};
+
+#endif // FIRE_GRID_H
@@ -0,0 +1,51 @@
+#ifndef FRAME_BUFFER_POOL_H
+#define FRAME_BUFFER_POOL_H
+
+#include <FastLED.h>
+#include "config.h"
+#include "pixel_kernels.h"
+
+// Fixed set of full-strip frame buffers, reserved at build time so that
+// transitions (and anything else rendering off-screen) never touch the heap.
+// Each buffer is 16-byte aligned for the SIMD pixel kernels.
+class FrameBufferPool {
+public:
+    FrameBufferPool() : _used(0) {}
+
+    // nullptr when every buffer is taken
+    CRGB* acquire() {
+        for (uint8_t i = 0; i < FRAME_POOL_BUFFERS; i++) {
+            if (!(_used & (1UL << i))) {
+                _used |= (1UL << i);
+                return _buffers[i].pixels;
+            }
+        }
+        return nullptr;
+    }
+
+    void release(CRGB* buffer) {
+        for (uint8_t i = 0; i < FRAME_POOL_BUFFERS; i++) {
+            if (_buffers[i].pixels == buffer) {
+                _used &= ~(1UL << i);
+                return;
+            }
+        }
+    }
+
+    uint8_t available() const {
+        uint8_t count = 0;
+        for (uint8_t i = 0; i < FRAME_POOL_BUFFERS; i++) {
+            if (!(_used & (1UL << i))) count++;
+        }
+        return count;
+    }
+
+private:
+    struct Buffer {
+        PIXEL_ALIGN CRGB pixels[NUM_LEDS];
+    };
+    Buffer _buffers[FRAME_POOL_BUFFERS];
+    uint32_t _used;
+};
+
+#endif // FRAME_BUFFER_POOL_H
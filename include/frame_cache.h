@@ -0,0 +1,63 @@
+#ifndef FRAME_CACHE_H
+#define FRAME_CACHE_H
+
+#include <FastLED.h>
+#include <atomic>
+#include "config.h"
+
+// One full cycle (ANIMATION_PHASE_STEPS frames) of a periodic animation,
+// kept in PSRAM. Frames are keyed on everything that decides their content:
+// mode, colour and calibration revision. Any change drops every frame.
+//
+// The cache only ever allocates from PSRAM and only while that leaves
+// FRAME_CACHE_PSRAM_RESERVE free; otherwise the caller keeps rendering live.
+class FrameCache {
+public:
+    FrameCache();
+    ~FrameCache();
+
+    // Safe from any task; memory is only freed by checkMemory()
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return _enabled; }
+
+    // Start over unless the key matches the cached frames. Returns false if
+    // the cache can't be used (disabled or no memory).
+    bool prepare(uint8_t mode, CRGB color, uint32_t revision);
+
+    // nullptr if the frame for step hasn't been rendered yet
+    const CRGB* get(uint8_t step) const;
+    // Storage for step's frame; call markValid() once it has been drawn
+    CRGB* slot(uint8_t step) { return _frames + (uint32_t)step * NUM_LEDS; }
+    void markValid(uint8_t step);
+    // First step from 'from' onwards that still needs rendering, -1 when full
+    int16_t nextMissing(uint8_t from) const;
+
+    // Give the memory back if disabled or PSRAM is running low (render task)
+    void checkMemory();
+
+    void countHit() { _hits++; }
+    void countMiss() { _misses++; }
+    uint32_t getHits() const { return _hits; }
+    uint32_t getMisses() const { return _misses; }
+    uint8_t getFilled() const { return _filled; }
+    size_t getBytes() const { return _frames ? bytes() : 0; }
+
+private:
+    CRGB* _frames;
+    std::atomic<bool> _enabled;
+    bool _keyValid;
+    uint8_t _mode;
+    CRGB _color;
+    uint32_t _revision;
+    uint8_t _valid[(ANIMATION_PHASE_STEPS + 7) / 8];
+    uint8_t _filled;
+    uint32_t _hits;
+    uint32_t _misses;
+
+    static size_t bytes() { return (size_t)ANIMATION_PHASE_STEPS * NUM_LEDS * sizeof(CRGB); }
+    bool allocate();
+    void release();
+    void clear();
+};
+
+#endif // FRAME_CACHE_H
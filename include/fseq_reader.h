@@ -0,0 +1,124 @@
+#ifndef FSEQ_READER_H
+#define FSEQ_READER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+// Reader for xLights FSEQ v2 sequence files.
+//
+// Frames are pulled through a small read-ahead buffer from an FseqSource,
+// so only the part of each frame that lands on the strip is kept: memory
+// use doesn't grow with the file or its channel count. zlib-compressed
+// blocks are inflated on the fly with miniz (in ROM on the ESP32), through
+// the 32 KB window deflate requires. zstd has no decoder here and is
+// rejected at open().
+//
+// Pure C++ so tools/fseq_tool can exercise it on the host, where
+// tools/host/miniz.h provides the inflater on top of zlib.
+
+#if defined(ARDUINO)
+#include "rom/miniz.h"
+#define FSEQ_HAVE_ZLIB 1
+#elif defined(__has_include)
+#if __has_include(<miniz.h>)
+#include <miniz.h>
+#define FSEQ_HAVE_ZLIB 1
+#endif
+#endif
+#ifndef FSEQ_HAVE_ZLIB
+#define FSEQ_HAVE_ZLIB 0
+#endif
+
+enum FseqCompression {
+    FSEQ_COMPRESSION_NONE = 0,
+    FSEQ_COMPRESSION_ZSTD = 1,
+    FSEQ_COMPRESSION_ZLIB = 2
+};
+
+// Random-access byte source (SD file, host FILE*, memory)
+class FseqSource {
+public:
+    virtual ~FseqSource() {}
+    // Returns the number of bytes read; short only at end of file
+    virtual size_t read(uint32_t offset, uint8_t* buffer, size_t length) = 0;
+};
+
+class FseqReader {
+public:
+    FseqReader();
+    ~FseqReader();
+
+    // Parse the header. Frames are then read as file channels
+    // [firstChannel, firstChannel + windowChannels).
+    bool open(FseqSource* source, uint32_t firstChannel, uint32_t windowChannels);
+    void close();
+    bool isOpen() const { return _source != nullptr; }
+
+    // Copy the window of one frame into out (windowChannels bytes; channels
+    // the file doesn't carry are zero). Sequential reads are cheapest;
+    // compressed files seek to the start of the block holding the frame.
+    bool readFrame(uint32_t frame, uint8_t* out);
+
+    const char* getError() const { return _error; }
+    uint32_t getFrameCount() const { return _frameCount; }
+    uint8_t getStepMs() const { return _stepMs; }
+    uint32_t getChannelCount() const { return _channelCount; }
+    FseqCompression getCompression() const { return _compression; }
+    uint16_t getBlockCount() const { return _blockCount; }
+
+private:
+    struct Block {
+        uint32_t firstFrame;
+        uint32_t offset;  // In the file
+        uint32_t length;
+    };
+    // Where a run of window channels sits inside a (possibly sparse) file frame
+    struct Span {
+        uint32_t frameOffset;
+        uint32_t outOffset;
+        uint32_t length;
+    };
+
+    FseqSource* _source;
+    const char* _error;
+    uint32_t _dataOffset;
+    uint32_t _channelCount;  // Bytes per stored frame
+    uint32_t _frameCount;
+    uint8_t _stepMs;
+    FseqCompression _compression;
+    uint32_t _windowChannels;
+
+    Span _spans[FSEQ_MAX_SPANS];
+    uint8_t _spanCount;
+    Block* _blocks;
+    uint16_t _blockCount;
+
+    uint8_t _readAhead[FSEQ_READ_AHEAD];
+    uint32_t _readAheadOffset;
+    uint32_t _readAheadLength;
+
+    bool fetch(uint32_t offset, uint8_t* out, uint32_t length);
+    bool readHeader(uint32_t firstChannel);
+    void copySpans(uint32_t framePos, const uint8_t* data, uint32_t length, uint8_t* out) const;
+
+#if FSEQ_HAVE_ZLIB
+    tinfl_decompressor* _inflater;
+    uint8_t* _window;        // TINFL_LZ_DICT_SIZE circular output buffer
+    uint32_t _windowPos;
+    uint32_t _pendingStart;  // Inflated bytes not yet consumed
+    uint32_t _pendingLength;
+    uint16_t _block;
+    uint32_t _nextFrame;     // Next frame the inflater will produce
+    uint32_t _inOffset;      // Compressed input still to read
+    uint32_t _inRemaining;
+    const uint8_t* _inPtr;   // Compressed input in _readAhead
+    size_t _inAvail;
+
+    bool startBlock(uint16_t block);
+    bool inflateMore();
+    bool readCompressed(uint32_t frame, uint8_t* out);
+#endif
+};
+
+#endif // FSEQ_READER_H
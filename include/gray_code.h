@@ -0,0 +1,62 @@
+#ifndef GRAY_CODE_H
+#define GRAY_CODE_H
+
+#include <stdint.h>
+
+// Structured-light frame sequence for camera calibration.
+//
+// Each LED shows its index as a Gray code, one bit per frame pair, so a
+// camera can identify every LED in 2 + 2*ceil(log2(N)) frames instead of N.
+// Shared by LEDController (which plays it) and the host-side decoder in
+// tools/graycode_decoder (which reads it back from photos).
+//
+//   frame 0        sync: every LED on (also the brightness reference)
+//   frame 1        every LED off (ambient reference)
+//   frame 2+2b     LEDs whose code has bit b set (most significant first)
+//   frame 3+2b     the inverse of frame 2+2b
+//
+// Comparing each pattern frame with its inverse makes the decision
+// independent of how bright a particular LED appears to the camera.
+
+static const uint16_t GRAY_CODE_FRAME_SYNC = 0;
+static const uint16_t GRAY_CODE_FRAME_DARK = 1;
+static const uint16_t GRAY_CODE_FIRST_BIT_FRAME = 2;
+
+inline uint16_t grayEncode(uint16_t value) {
+    return value ^ (value >> 1);
+}
+
+inline uint16_t grayDecode(uint16_t code) {
+    uint16_t value = code;
+    for (uint16_t shift = code >> 1; shift; shift >>= 1) {
+        value ^= shift;
+    }
+    return value;
+}
+
+// Bits needed to give each of count LEDs a distinct code
+inline uint8_t grayCodeBits(uint16_t count) {
+    uint8_t bits = 1;
+    while (bits < 16 && (1UL << bits) < count) {
+        bits++;
+    }
+    return bits;
+}
+
+inline uint16_t grayCodeFrameCount(uint16_t count) {
+    return GRAY_CODE_FIRST_BIT_FRAME + 2 * grayCodeBits(count);
+}
+
+// Whether LED index is lit in the given frame
+inline bool grayCodeLit(uint16_t frame, uint16_t index, uint16_t count) {
+    if (frame == GRAY_CODE_FRAME_SYNC) return true;
+    if (frame == GRAY_CODE_FRAME_DARK) return false;
+
+    uint8_t bits = grayCodeBits(count);
+    uint16_t pair = (frame - GRAY_CODE_FIRST_BIT_FRAME) / 2;
+    bool inverse = (frame - GRAY_CODE_FIRST_BIT_FRAME) & 1;
+    bool set = (grayEncode(index) >> (bits - 1 - pair)) & 1;
+    return set != inverse;
+}
+
+#endif // GRAY_CODE_H
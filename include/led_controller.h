@@ -4,24 +4,74 @@
 #include <FastLED.h>
 #include "config.h"
 #include "calibration.h"
+#include "state_events.h"
+#include "animation_mode.h"
+#include "gray_code.h"
+#include "output_stage.h"
+#include "pixel_kernels.h"
+#include "frame_buffer_pool.h"
+#include "frame_cache.h"
+#include "fire_grid.h"
+#include "audio_analyzer.h"
+#include "noise_field.h"
+#include "particle_system.h"
 
-enum AnimationMode {
-    ANIMATION_STATIC = 0,
-    ANIMATION_RAINBOW,
-    ANIMATION_CHASE,
-    ANIMATION_TWINKLE,
-    ANIMATION_FADE,
-    ANIMATION_SPARKLE,
-    ANIMATION_CANDY_CANE,
-    ANIMATION_SNOW,
-    ANIMATION_FIRE,
-    // Spatial animations (use calibration data)
-    ANIMATION_SPATIAL_WAVE,
-    ANIMATION_SPATIAL_RAINBOW,
-    ANIMATION_SPATIAL_PULSE,
-    ANIMATION_SPATIAL_ROTATE,
-    ANIMATION_SPATIAL_PLANES,
-    ANIMATION_CUSTOM
+// One running animation: its settings, its clock and the buffer it draws into.
+// Two of these are live while a transition blends the old one into the new.
+struct AnimationInstance {
+    AnimationMode mode;
+    CRGB color;
+    uint16_t speed;
+    float phase;
+    uint8_t phaseStep;  // phase = phaseStep * 2*PI / ANIMATION_PHASE_STEPS
+    unsigned long lastUpdate;
+    CRGB* buffer;  // From the frame buffer pool
+    FireGrid* fire;  // Heat state while running ANIMATION_FIRE (from the fire grid pool)
+    // Span of the strip this animation draws, in strip order. Pixel k of the
+    // span is buffer[start + k]; reversed spans are flipped when composited.
+    uint16_t start;
+    uint16_t count;
+    bool reverse;
+};
+
+// Strip index shown by pixel k of an animation's span
+inline uint16_t spanLedIndex(const AnimationInstance& anim, uint16_t k) {
+    return anim.start + (anim.reverse ? anim.count - 1 - k : k);
+}
+
+// How an overlay layer combines with what is beneath it
+enum BlendMode {
+    BLEND_NORMAL = 0,   // Replace
+    BLEND_ADD,          // Saturating add
+    BLEND_MULTIPLY,     // Darken / tint
+    BLEND_MAX,          // Brightest channel wins
+    BLEND_SCREEN,       // Lighten without clipping
+    BLEND_MODE_COUNT
+};
+
+// An animation drawn over the main one. Each layer renders at its own speed,
+// so a cheap overlay does not force the base animation to redraw.
+struct Layer {
+    AnimationInstance anim;
+    uint8_t opacity;
+    BlendMode blend;
+    bool enabled;
+};
+
+// A named range of the strip (trunk, star...) with its own animation. Enabled
+// segments never overlap; pixels outside every segment show the main animation.
+struct Segment {
+    char name[SEGMENT_NAME_LENGTH];
+    AnimationInstance anim;
+    bool enabled;
+};
+
+// Pre-rendered frames for ANIMATION_SEQUENCE (see SequencePlayer)
+class FrameSource {
+public:
+    virtual ~FrameSource() {}
+    // Write the frame due at now into leds; false if it hasn't changed
+    virtual bool renderFrame(CRGB* leds, uint16_t count, unsigned long now) = 0;
 };
 
 class LEDController {
@@ -43,43 +93,199 @@ public:
 
     // Animation controls
     void setAnimation(AnimationMode mode);
-    AnimationMode getAnimation() const { return _currentAnimation; }
+    void setAnimation(AnimationMode mode, CRGB color);  // Mode and colour as one change
+    AnimationMode getAnimation() const { return _current.mode; }
     void setAnimationSpeed(uint16_t speedMs);
     uint16_t getAnimationSpeed() const { return _animationSpeed; }
 
-    // Get LED data for custom patterns
+    // Transitions: animation changes blend over durationMs (0 = instant).
+    // TRANSITION_WIPE sweeps the new animation in along a calibration ordering.
+    void setTransition(uint16_t durationMs, uint8_t type, SortOrder axis);
+    uint16_t getTransitionDuration() const { return _transitionDuration; }
+    uint8_t getTransitionType() const { return _transitionType; }
+    SortOrder getTransitionAxis() const { return _transitionAxis; }
+    bool isTransitioning() const { return _transitionActive; }
+    uint8_t getTransitionProgress() const;  // 0..255
+    // Extra work per transition frame (outgoing render + blend), in microseconds
+    uint32_t getTransitionMicros() const { return _transitionMicros; }
+    uint32_t getTransitionPeakMicros() const { return _transitionPeakMicros; }
+
+    // Overlay layers, composited in index order over the main animation.
+    // Returns false if the mode is invalid or no frame buffer is free.
+    bool setLayer(uint8_t index, AnimationMode mode, CRGB color, uint16_t speed,
+                  uint8_t opacity, BlendMode blend);
+    void clearLayer(uint8_t index);
+    const Layer& getLayer(uint8_t index) const { return _layers[index < OVERLAY_LAYERS ? index : 0]; }
+    // Time spent compositing the overlays into the last frame, in microseconds
+    uint32_t getLayerMicros() const { return _layerMicros; }
+
+    // Time spent rendering the last noise frame, in microseconds
+    uint32_t getNoiseMicros() const { return _noiseMicros; }
+
+    // Particle emitters (see ParticleEmitterId), shared by every animation
+    // instance running the same particle effect
+    void setParticleEmitter(uint8_t index, const ParticleEmitter& emitter) { _particles.setEmitter(index, emitter); }
+    void resetParticleEmitter(uint8_t index) { _particles.resetEmitter(index); }
+    const ParticleSystem& getParticles() const { return _particles; }
+    // Time spent stepping and drawing the last particle frame, in microseconds
+    uint32_t getParticleMicros() const { return _particleMicros; }
+
+    // Segments. Returns false if the span is out of range, overlaps another
+    // segment, the mode is invalid or no frame buffer is free.
+    bool setSegment(uint8_t index, const char* name, uint16_t start, uint16_t length, bool reverse,
+                    AnimationMode mode, CRGB color, uint16_t speed);
+    void clearSegment(uint8_t index);
+    const Segment& getSegment(uint8_t index) const { return _segments[index < MAX_SEGMENTS ? index : 0]; }
+
+    // Get LED data for custom patterns (linear, before gamma / brightness)
     CRGB* getLeds() { return _leds; }
 
+    // Push the framebuffer through the output stage to the strip
+    void show();
+    void clear();
+
+    // Group several changes into one visible update: show() is held back
+    // until endBatch(), and everything is redrawn on the next update()
+    void beginBatch() { _batchDepth++; }
+    void endBatch();
+    OutputStage& getOutputStage() { return _output; }
+
     // Calibration mode
     void showCalibrationLED(int16_t index);
 
+    // Structured-light calibration: plays the Gray-code frame sequence
+    // (see gray_code.h) with each frame held for holdMs
+    void startGrayCode(uint16_t holdMs, bool repeat);
+    void stopGrayCode();
+    bool isGrayCodeActive() const { return _grayCodeActive; }
+    uint16_t getGrayCodeFrame() const { return _grayCodeFrame; }
+    uint16_t getGrayCodeHold() const { return _grayCodeHold; }
+
+    // Periodic animations (rainbow, candy cane, spatial wave/rainbow/pulse/
+    // rotate/planes) replay one precomputed cycle from PSRAM when enabled
+    void setFrameCache(bool enabled) { _frameCache.setEnabled(enabled); }
+    const FrameCache& getFrameCache() const { return _frameCache; }
+
+    // Band levels and beats for the audio-reactive animations (nullptr = silence)
+    void setAudioAnalyzer(const AudioAnalyzer* analyzer) { _audio = analyzer; }
+
+    // Where ANIMATION_SEQUENCE gets its frames (nullptr = black)
+    void setFrameSource(FrameSource* source) { _frameSource = source; }
+
+    // Change notifications (power, brightness, color, animation, speed)
+    void addListener(StateListener listener, void* context) { _events.addListener(listener, context); }
+
 private:
-    CRGB _leds[NUM_LEDS];
+    PIXEL_ALIGN CRGB _leds[NUM_LEDS];  // Aligned for the SIMD pixel kernels
     Calibration& _calibration;
     bool _isOn;
     uint8_t _brightness;
     CRGB _solidColor;
-    AnimationMode _currentAnimation;
     uint16_t _animationSpeed;
-    unsigned long _lastUpdate;
-    float _animationPhase;  // Changed to float for smoother spatial animations
+    StateNotifier _events;
+
+    // Animations render into pool buffers and are copied or blended into _leds
+    FrameBufferPool _pool;
+    AnimationInstance _current;
+    AnimationInstance _outgoing;  // Only valid while a transition is running
+
+    bool _transitionActive;
+    uint16_t _transitionDuration;
+    uint8_t _transitionType;
+    SortOrder _transitionAxis;
+    unsigned long _transitionStart;
+    uint32_t _transitionMicros;
+    uint32_t _transitionPeakMicros;
+
+    Layer _layers[OVERLAY_LAYERS];
+    uint32_t _layerMicros;
+
+    // All segments draw into disjoint spans of one shared buffer
+    Segment _segments[MAX_SEGMENTS];
+    CRGB* _segmentBuffer;
+
+    FrameSource* _frameSource;
+
+    // Fire state is per animation instance; sample points are per calibration revision
+    FireGridPool _firePool;
+    FireLayout _fireLayout;
+    uint32_t _fireRevision;
+    bool _fireReady;
+    FrameCache _frameCache;
+
+    const AudioAnalyzer* _audio;
+    AudioSnapshot _audioSnapshot;  // Last one read successfully
+    uint32_t _audioBeats;
+    unsigned long _audioBeatTime;
+
+    // Noise corners are precomputed per calibration revision
+    NoiseField _noise;
+    uint32_t _noiseRevision;
+    bool _noiseReady;
+    uint32_t _noiseMicros;
+
+    ParticleSystem _particles;
+    uint32_t _particleMicros;
+
+    // Gray-code sequencer state
+    bool _grayCodeActive;
+    bool _grayCodeRepeat;
+    uint16_t _grayCodeFrame;
+    uint16_t _grayCodeHold;
+    unsigned long _grayCodeFrameStart;
+
+    OutputStage _output;
+    unsigned long _lastShow;
+    uint8_t _batchDepth;
+
+    void updateGrayCode();
+    void showGrayCodeFrame();
+
+    void switchAnimation(AnimationMode mode, CRGB color);
+    void releaseFire(AnimationInstance& anim);
+    void endTransition();
+    bool stepAnimation(AnimationInstance& anim, unsigned long now);
+    void renderAnimation(AnimationInstance& anim);
+    static void advancePhase(AnimationInstance& anim);
+    static bool isPeriodic(AnimationMode mode);
+    void fillFrameCache();  // Render one missing cache frame while idle
+    void blendTransition(CRGB* dst, unsigned long now);
+    void refreshFrame();
+    void compositeSegments();
+    void compositeLayers();
 
     // Basic animation functions
-    void animateRainbow();
-    void animateChase();
-    void animateTwinkle();
-    void animateFade();
-    void animateSparkle();
-    void animateCandyCane();
-    void animateSnow();
-    void animateFire();
+    void animateRainbow(AnimationInstance& anim);
+    void animateChase(AnimationInstance& anim);
+    void animateTwinkle(AnimationInstance& anim);
+    void animateFade(AnimationInstance& anim);
+    void animateSparkle(AnimationInstance& anim);
+    void animateCandyCane(AnimationInstance& anim);
+    void animateSnow(AnimationInstance& anim);
+    void animateFire(AnimationInstance& anim);
 
     // Spatial animation functions (use 3D positions)
-    void animateSpatialWave();
-    void animateSpatialRainbow();
-    void animateSpatialPulse();
-    void animateSpatialRotate();
-    void animateSpatialPlanes();
+    void animateSpatialWave(AnimationInstance& anim);
+    void animateSpatialRainbow(AnimationInstance& anim);
+    void animateSpatialPulse(AnimationInstance& anim);
+    void animateSpatialRotate(AnimationInstance& anim);
+    void animateSpatialPlanes(AnimationInstance& anim);
+
+    // Sweep animation functions (use cached calibration orderings)
+    void animateSweepWipe(AnimationInstance& anim);
+    void animateSweepRipple(AnimationInstance& anim);
+    void animateSweepAngular(AnimationInstance& anim);
+
+    // Audio-reactive animations
+    void updateAudio();
+    void animateAudioSpectrum(AnimationInstance& anim);
+    void animateAudioBeat(AnimationInstance& anim);
+
+    // Noise animations
+    void animateNoise(AnimationInstance& anim, const CRGBPalette16& palette);
+
+    // Particle animations: trail is how much of the last frame fades (255 = none kept)
+    void animateParticles(AnimationInstance& anim, uint8_t emitter, uint8_t trail);
 };
 
 #endif // LED_CONTROLLER_H
@@ -0,0 +1,10 @@
+#ifndef LED_POSITION_H
+#define LED_POSITION_H
+
+struct LEDPosition {
+    float x;  // -1.0 to 1.0 normalized coordinates
+    float y;  // -1.0 to 1.0
+    float z;  // -1.0 to 1.0
+};
+
+#endif // LED_POSITION_H
@@ -0,0 +1,61 @@
+#ifndef LED_PREVIEW_H
+#define LED_PREVIEW_H
+
+#include <Arduino.h>
+#include <lvgl.h>
+#include "config.h"
+#include "led_controller.h"
+#include "calibration.h"
+
+// Size of the canvas inside the preview tile
+static const int PREVIEW_WIDTH = 230;
+static const int PREVIEW_HEIGHT = 36;
+
+// Cell geometry
+static const int PREVIEW_MIN_CELL_WIDTH = 3;   // Strip mode: narrower cells are downsampled
+static const int PREVIEW_SPATIAL_CELL = 4;     // Spatial mode: square cell size in pixels
+static const int PREVIEW_MAX_CELLS = (PREVIEW_WIDTH / PREVIEW_SPATIAL_CELL) * (PREVIEW_HEIGHT / PREVIEW_SPATIAL_CELL);
+static const int PREVIEW_MAX_INVALIDATIONS = 8;  // Above this, invalidate the bounding box instead
+
+// Mirrors the LED framebuffer onto an LVGL canvas.
+// Only cells whose color changed are redrawn and invalidated.
+class LEDPreview {
+public:
+    LEDPreview(LEDController& ledController, Calibration& calibration);
+    lv_obj_t* create(lv_obj_t* parent);
+    void update();
+
+    void setMode(uint8_t mode);
+    uint8_t getMode() const { return _mode; }
+
+    // Cost of the last refresh that did any work
+    uint32_t getLastUpdateMicros() const { return _lastUpdateMicros; }
+
+private:
+    LEDController& _ledController;
+    Calibration& _calibration;
+    lv_obj_t* _canvas;
+    lv_color_t* _buffer;
+    uint8_t _mode;
+    unsigned long _lastUpdate;
+    uint32_t _lastUpdateMicros;
+    uint32_t _mappedRevision;
+    bool _needsRebuild;
+
+    // Cell layout
+    uint16_t _cellCount;
+    uint16_t _cols;
+    uint16_t _cellW;
+    uint16_t _cellH;
+    uint16_t _originX;
+    uint16_t _originY;
+    uint16_t _ledCell[NUM_LEDS];
+    CRGB _cells[PREVIEW_MAX_CELLS];   // Last drawn color per cell
+    CRGB _accum[PREVIEW_MAX_CELLS];   // This refresh's color per cell
+
+    void rebuildLayout();
+    void drawCell(uint16_t cell, CRGB color);
+    void getCellArea(uint16_t cell, lv_area_t* area) const;
+};
+
+#endif // LED_PREVIEW_H
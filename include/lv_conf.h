@@ -19,9 +19,16 @@
 /*====================
    MEMORY SETTINGS
  *====================*/
-#define LV_MEM_CUSTOM 0
-#define LV_MEM_SIZE (48U * 1024U)
-#define LV_MEM_ADR 0
+#define LV_MEM_CUSTOM 1  // Heap lives in PSRAM via lv_mem_psram (see lv_mem_psram.h)
+#if LV_MEM_CUSTOM == 0
+    #define LV_MEM_SIZE (48U * 1024U)
+    #define LV_MEM_ADR 0
+#else
+    #define LV_MEM_CUSTOM_INCLUDE "lv_mem_psram.h"
+    #define LV_MEM_CUSTOM_ALLOC lv_mem_psram_alloc
+    #define LV_MEM_CUSTOM_FREE lv_mem_psram_free
+    #define LV_MEM_CUSTOM_REALLOC lv_mem_psram_realloc
+#endif
 #define LV_MEM_BUF_MAX_NUM 16
 #define LV_MEMCPY_MEMSET_STD 1
 
@@ -144,7 +151,7 @@
 #define LV_USE_BAR 1
 #define LV_USE_BTN 1
 #define LV_USE_BTNMATRIX 1
-#define LV_USE_CANVAS 0
+#define LV_USE_CANVAS 1
 #define LV_USE_CHECKBOX 1
 #define LV_USE_DROPDOWN 1
 #define LV_USE_IMG 1
@@ -0,0 +1,27 @@
+/**
+ * PSRAM-backed allocator for LVGL (LV_MEM_CUSTOM)
+ * Keeps the LVGL heap out of internal RAM so WiFi/lwIP and LED buffers get it
+ */
+
+#ifndef LV_MEM_PSRAM_H
+#define LV_MEM_PSRAM_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void* lv_mem_psram_alloc(size_t size);
+void* lv_mem_psram_realloc(void* ptr, size_t size);
+void lv_mem_psram_free(void* ptr);
+
+// Bytes currently held by LVGL in each heap (for diagnostics)
+size_t lv_mem_psram_used_external(void);
+size_t lv_mem_psram_used_internal(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LV_MEM_PSRAM_H
@@ -0,0 +1,66 @@
+#ifndef NOISE_FIELD_H
+#define NOISE_FIELD_H
+
+#include <stdint.h>
+#include "config.h"
+#include "led_position.h"
+
+// 3D simplex noise sampled at fixed points (the calibrated LED positions).
+//
+// The points never move, so everything that depends only on position is
+// worked out once in prepare(): each point's four simplex corners per
+// octave, their gradient slots and the falloff-weighted offsets to them.
+// The field changes over time by rotating the gradients instead of moving
+// through the noise ("flow noise"), so a frame is one setTime() that
+// rotates NOISE_GRADIENTS vectors, then per point a handful of Q14 dot
+// products: no floats, no floor(), no hashing. Pure C++ so
+// tools/noise_tool can benchmark it on the host.
+class NoiseField {
+public:
+    NoiseField();
+
+    // Precompute corners for count points (at most NUM_LEDS).
+    // scale is lattice cells per unit of position.
+    void prepare(const LEDPosition* positions, uint16_t count, float scale);
+    uint16_t getCount() const { return _count; }
+
+    // Rotate the gradients to time t (1/65536 turn of the slowest gradient)
+    void setTime(uint32_t t);
+
+    // Noise at prepared point i, 0..255 (128 = mean)
+    uint8_t sample(uint16_t i) const { return blend(_corners[i]); }
+
+    // Noise at an arbitrary point without the cache (same result as
+    // prepare() + sample(); for comparison and one-off lookups)
+    uint8_t sampleAt(const LEDPosition& position, float scale) const;
+
+private:
+    // One simplex corner: gradient slot and weight * offset in Q14
+    struct Corner {
+        int16_t dx, dy, dz;
+        uint8_t gradient;
+    };
+
+    uint8_t blend(const Corner* c) const {
+        int32_t sum = 0;
+        for (uint8_t n = 0; n < NOISE_OCTAVES * 4; n++) {
+            const int16_t* g = _gradients[c[n].gradient];
+            sum += g[0] * c[n].dx + g[1] * c[n].dy + g[2] * c[n].dz;
+        }
+        sum = (sum >> 21) + 128;
+        return sum < 0 ? 0 : (sum > 255 ? 255 : (uint8_t)sum);
+    }
+
+    Corner _corners[NUM_LEDS][NOISE_OCTAVES * 4];
+    uint16_t _count;
+
+    // Each gradient turns in its own plane at its own rate
+    float _base[NOISE_GRADIENTS][3];
+    float _perp[NOISE_GRADIENTS][3];
+    uint16_t _rate[NOISE_GRADIENTS];  // 8.8 multiple of the base rate
+    int16_t _gradients[NOISE_GRADIENTS][3];  // Q14, current time
+
+    static void setupCorners(float x, float y, float z, float scale, Corner* out);
+};
+
+#endif // NOISE_FIELD_H
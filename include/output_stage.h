@@ -0,0 +1,118 @@
+#ifndef OUTPUT_STAGE_H
+#define OUTPUT_STAGE_H
+
+#include <FastLED.h>
+#include "config.h"
+
+// Final pass between the animation framebuffer and the strip.
+//
+// Master brightness, per-channel colour correction and gamma are folded
+// into one 16-bit LUT per channel (8.8 fixed point), rebuilt only when one
+// of them changes. Each refresh is a
+// single pass: look up, add the fraction left over from the previous
+// refresh, emit the integer part and keep the new fraction. Averaged over
+// a few refreshes the strip shows the 16-bit value, so low-level fades no
+// longer step between adjacent 8-bit codes.
+//
+// The same pass sums the channel values for each output (a strip on its own
+// supply) to estimate current. When an output goes over its budget, its
+// limiter scale drops straight to the level that fits and then eases back
+// up once there is headroom. The estimate lags by one refresh.
+//
+// Dithering on/off and the strip mapping (normal, reversed, mirrored) are
+// template parameters of the range loop. The matching specialization is
+// picked when the configuration changes, so the frame is read once and the
+// output written once with no per-pixel branches on settings.
+//
+// FastLED is bound to this stage's output buffer with its own brightness
+// and dithering disabled.
+
+// How output pixels map onto the animation frame
+enum OutputMapping {
+    OUTPUT_MAP_NORMAL = 0,
+    OUTPUT_MAP_REVERSE,   // Strip wired from the other end
+    OUTPUT_MAP_MIRROR,    // First half of the frame, reflected onto the second half
+    OUTPUT_MAP_COUNT
+};
+
+class OutputStage {
+public:
+    OutputStage();
+
+    CRGB* getOutput() { return _output; }
+
+    void setBrightness(uint8_t brightness);
+    uint8_t getBrightness() const { return _brightness; }
+
+    void setGamma(float r, float g, float b);
+    float getGamma(uint8_t channel) const { return _gamma[channel]; }
+
+    // Scales each channel's output, like FastLED's setCorrection (255 = unchanged)
+    void setColorCorrection(CRGB correction);
+    CRGB getColorCorrection() const { return _correction; }
+
+    void setDithering(bool enabled);
+    bool isDithering() const { return _dither; }
+
+    void setMapping(OutputMapping mapping);
+    OutputMapping getMapping() const { return _mapping; }
+
+    // Power budget per output. Output 0 covers the whole strip by default;
+    // configuring more splits the strip into consecutive ranges.
+    bool setPowerOutput(uint8_t output, uint16_t start, uint16_t count, uint32_t budgetMa);
+    void setPowerOutputCount(uint8_t count);
+    uint8_t getPowerOutputCount() const { return _outputCount; }
+    uint16_t getPowerOutputStart(uint8_t output) const { return _outputs[output].start; }
+    uint16_t getPowerOutputLength(uint8_t output) const { return _outputs[output].count; }
+
+    // Convert a linear frame into the output buffer (call FastLED.show() after)
+    void render(const CRGB* frame);
+
+    // Power estimate from the last render
+    uint32_t getEstimatedMilliamps() const;
+    uint32_t getEstimatedMilliamps(uint8_t output) const { return _outputs[output].drawnMa; }
+    uint32_t getRequestedMilliamps(uint8_t output) const { return _outputs[output].requestedMa; }
+    uint32_t getPowerBudget(uint8_t output) const { return _outputs[output].budgetMa; }
+    uint16_t getLimiterScale(uint8_t output) const { return _outputs[output].scale; }  // 256 = unlimited
+    bool isLimiting() const;
+
+    uint32_t getLastRenderMicros() const { return _lastRenderMicros; }
+
+    // Time the fused pass against the same stages run one pass at a time
+    static void runBenchmark();
+
+private:
+    struct PowerOutput {
+        uint16_t start;
+        uint16_t count;
+        uint32_t budgetMa;
+        uint32_t requestedMa;  // Before limiting
+        uint32_t drawnMa;      // After limiting
+        uint16_t scale;        // 0..256
+    };
+
+    typedef void (OutputStage::*RangeRenderer)(const CRGB* frame, PowerOutput& output);
+
+    CRGB _output[NUM_LEDS];
+    uint8_t _residual[NUM_LEDS][3];  // Fraction carried to the next refresh
+    uint16_t _lut[3][256];           // Input code -> output in 8.8 fixed point
+    float _gamma[3];
+    CRGB _correction;
+    uint8_t _brightness;
+    bool _dither;
+    OutputMapping _mapping;
+    RangeRenderer _renderRange;
+    bool _lutDirty;
+    uint32_t _lastRenderMicros;
+    PowerOutput _outputs[POWER_MAX_OUTPUTS];
+    uint8_t _outputCount;
+
+    void rebuildLut();
+    void selectRenderer();
+
+    template <bool DITHER, uint8_t MAPPING>
+    void renderRange(const CRGB* frame, PowerOutput& output);
+    void updateLimiter(PowerOutput& output, uint32_t demand);
+};
+
+#endif // OUTPUT_STAGE_H
@@ -0,0 +1,117 @@
+#ifndef PARTICLE_SYSTEM_H
+#define PARTICLE_SYSTEM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+#include "led_position.h"
+#include "spatial_index.h"
+
+// Where an emitter spawns its particles
+enum ParticleShape {
+    PARTICLE_SHAPE_TOP = 0,     // Anywhere across the top, heading down
+    PARTICLE_SHAPE_BOTTOM,      // Anywhere across the bottom, heading up
+    PARTICLE_SHAPE_BURST,       // A random point inside the tree, in every direction
+    PARTICLE_SHAPE_COUNT
+};
+
+// The built-in effects, one emitter each
+enum ParticleEmitterId {
+    PARTICLE_EMITTER_SNOW = 0,
+    PARTICLE_EMITTER_FIREWORKS,
+    PARTICLE_EMITTER_EMBERS
+};
+
+// Everything that decides how an emitter's particles look and move.
+// Distances are position units (the tree spans -1..1), times are seconds
+// unless marked otherwise.
+struct ParticleEmitter {
+    uint8_t shape;       // ParticleShape
+    float rate;          // Particles per second; bursts per second for PARTICLE_SHAPE_BURST
+    uint16_t burst;      // Particles per burst
+    float speed;         // Launch speed...
+    float spread;        // ...plus or minus this much
+    float gravity;       // Vertical acceleration (negative falls)
+    float drag;          // Fraction of velocity lost per second
+    float jitter;        // Random acceleration (flutter), per axis
+    uint16_t lifeMs;
+    uint16_t fadeMs;     // Particles dim over the last fadeMs of their life
+    uint8_t r, g, b;
+    bool randomHue;      // Each particle (each burst, for bursts) picks a hue instead
+};
+
+// Fixed-capacity particle pool, structure-of-arrays so the integrator
+// streams through one array at a time.
+//
+// The pool is one allocation made in begin() (PSRAM on the ESP32); nothing
+// is allocated afterwards. Live particles are kept packed at the front:
+// a dead one is overwritten by the last, so a step touches only live
+// particles. Each particle remembers its emitter, so several effects can
+// share the pool and each one draws only its own.
+//
+// Drawing is splatting: every particle lights the LEDs within
+// PARTICLE_RADIUS of it (found through the calibration's SpatialIndex)
+// with a smooth falloff, summed into a per-LED light buffer.
+// Pure C++ so tools/particle_tool can run it on the host.
+class ParticleSystem {
+public:
+    ParticleSystem();
+    ~ParticleSystem();
+
+    // Allocate the pool; false (and capacity 0) if there isn't memory
+    bool begin(uint16_t capacity);
+    uint16_t getCapacity() const { return _capacity; }
+    uint16_t getCount() const { return _count; }
+
+    // Emitters start with their effect's defaults
+    void setEmitter(uint8_t index, const ParticleEmitter& emitter);
+    void resetEmitter(uint8_t index);
+    const ParticleEmitter& getEmitter(uint8_t index) const { return _emitters[index < PARTICLE_EMITTERS ? index : 0]; }
+
+    // Emit and integrate up to nowMs. Calling again with the same time does
+    // nothing, so every animation using the pool can call it each frame.
+    void update(uint32_t nowMs);
+
+    // Sum emitter's particles into the light buffer (read with getLight).
+    // Emitters only emit while something splats them.
+    void splat(uint8_t emitter, const SpatialIndex& index, const LEDPosition* positions);
+    // Light at strip index led as r, g, b (may exceed 255; saturate when drawing)
+    const uint16_t* getLight(uint16_t led) const { return _light[led]; }
+
+    void clear() { _count = 0; }
+
+private:
+    // Pool arrays, carved from one block
+    void* _block;
+    float* _x;
+    float* _y;
+    float* _z;
+    float* _vx;
+    float* _vy;
+    float* _vz;
+    uint16_t* _life;   // ms left
+    uint8_t* _r;
+    uint8_t* _g;
+    uint8_t* _b;
+    uint8_t* _emitter;
+    uint16_t _capacity;
+    uint16_t _count;
+
+    ParticleEmitter _emitters[PARTICLE_EMITTERS];
+    float _carry[PARTICLE_EMITTERS];        // Fractional particles / bursts owed
+    uint32_t _lastSplat[PARTICLE_EMITTERS];
+    bool _splatted[PARTICLE_EMITTERS];
+    uint32_t _now;
+    bool _started;
+    uint32_t _random;
+
+    uint16_t _light[NUM_LEDS][3];
+
+    float randomUnit();  // -1..1
+    void emit(uint8_t emitter, float dt);
+    bool spawn(uint8_t emitter, float x, float y, float z, float vx, float vy, float vz,
+               uint8_t r, uint8_t g, uint8_t b);
+    static void hueToRgb(uint8_t hue, uint8_t& r, uint8_t& g, uint8_t& b);
+};
+
+#endif // PARTICLE_SYSTEM_H
@@ -0,0 +1,51 @@
+#ifndef PIXEL_KERNELS_H
+#define PIXEL_KERNELS_H
+
+#include <FastLED.h>
+#include "config.h"
+
+// Bulk pixel operations over CRGB buffers.
+//
+// On the ESP32-S3 these run 16 bytes per instruction on the PIE vector unit
+// (EE.VMUL.U8 / EE.VADDS.U8). The portable scalar versions compute exactly
+// the same bytes and are used on other targets, for unaligned buffers and
+// if the startup self-check finds a mismatch. Buffers aligned to 16 bytes
+// (see PIXEL_ALIGN) take the vector path for everything but a short tail.
+//
+// Scaling follows FastLED's scale8: x * (scale + 1) / 256, with 255 leaving
+// the buffer untouched, so pixelScale/pixelFade match nscale8/fadeToBlackBy.
+//
+// Building with PIXEL_KERNELS_EMULATE_PIE swaps the vector blocks for C++
+// models of the instructions, so tools/pixel_tool can check the dispatch
+// against the scalar path on a computer.
+
+#define PIXEL_ALIGN alignas(16)
+
+// leds = leds * (scale + 1) / 256, like nscale8_video without the floor of 1
+void pixelScale(CRGB* leds, uint16_t count, uint8_t scale);
+
+// Same as pixelScale(255 - amount), like fadeToBlackBy
+void pixelFade(CRGB* leds, uint16_t count, uint8_t amount);
+
+// dst = min(dst + src, 255) per channel
+void pixelAddSaturate(CRGB* dst, const CRGB* src, uint16_t count);
+
+// dst = dst * (256 - amount) / 256 + src * amount / 256 (each term truncated).
+// amount 0 leaves dst unchanged.
+void pixelBlend(CRGB* dst, const CRGB* src, uint16_t count, uint8_t amount);
+
+// Set every pixel to color
+void pixelFill(CRGB* leds, uint16_t count, CRGB color);
+
+// Compare the vector and scalar paths; falls back to scalar on any mismatch.
+// Returns true when the vector path is in use.
+bool pixelKernelsBegin();
+bool pixelKernelsUsingSimd();
+// Force the scalar path (false) or the vector path where there is one, for
+// comparisons and benchmarks
+void pixelKernelsSetSimd(bool enabled);
+
+// Throughput of each kernel, vector vs scalar, printed to serial
+void pixelKernelsBenchmark();
+
+#endif // PIXEL_KERNELS_H
@@ -0,0 +1,75 @@
+#ifndef PRESET_STORE_H
+#define PRESET_STORE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+#include "led_controller.h"
+
+// Presets are fixed-size binary records: recalling one is a copy out of RAM
+// into the controller, with no parsing. Each record is stored as one NVS blob.
+static const uint8_t PRESET_RECORD_VERSION = 1;
+
+struct __attribute__((packed)) PresetSegment {
+    char name[SEGMENT_NAME_LENGTH];
+    uint16_t start;
+    uint16_t count;
+    uint8_t flags;      // PRESET_FLAG_*
+    uint8_t mode;
+    uint8_t color[3];
+    uint16_t speed;
+};
+
+struct __attribute__((packed)) PresetLayer {
+    uint8_t flags;
+    uint8_t mode;
+    uint8_t opacity;
+    uint8_t blend;
+    uint8_t color[3];
+    uint16_t speed;
+};
+
+struct __attribute__((packed)) PresetRecord {
+    uint8_t version;
+    char name[PRESET_NAME_LENGTH];
+    uint8_t flags;
+    uint8_t mode;
+    uint8_t color[3];
+    uint16_t speed;
+    uint8_t brightness;
+    PresetSegment segments[MAX_SEGMENTS];
+    PresetLayer layers[OVERLAY_LAYERS];
+};
+
+static const uint8_t PRESET_FLAG_USED = 0x01;     // Record slot holds a preset
+static const uint8_t PRESET_FLAG_ON = 0x02;       // Lights on
+static const uint8_t PRESET_FLAG_ENABLED = 0x01;  // Segment / layer present
+static const uint8_t PRESET_FLAG_REVERSE = 0x02;  // Segment runs backwards
+
+class PresetStore {
+public:
+    PresetStore(LEDController& ledController);
+    void begin();   // Load every stored record from NVS
+    void update();  // Call from loop() before the LED update: applies a pending recall
+
+    // Snapshot the controller's current state into slot index
+    bool save(uint8_t index, const char* name);
+    bool remove(uint8_t index);
+
+    // Queue a recall for the next frame. Safe from any task.
+    bool recall(uint8_t index);
+
+    bool isUsed(uint8_t index) const { return index < MAX_PRESETS && (_presets[index].flags & PRESET_FLAG_USED); }
+    const char* getName(uint8_t index) const { return index < MAX_PRESETS ? _presets[index].name : ""; }
+
+private:
+    LEDController& _ledController;
+    PresetRecord _presets[MAX_PRESETS];
+    std::atomic<int8_t> _pendingRecall;
+
+    void capture(PresetRecord& record);
+    void apply(const PresetRecord& record);
+    bool persist(uint8_t index);
+};
+
+#endif // PRESET_STORE_H
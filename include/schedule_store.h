@@ -0,0 +1,28 @@
+#ifndef SCHEDULE_STORE_H
+#define SCHEDULE_STORE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "show_scheduler.h"
+
+// JSON form of the show schedule, shared by the REST API and the copy kept
+// at SCHEDULE_FILE_PATH on the SD card:
+//
+//   { "enabled": true,
+//     "scenes": [{ "mode": 1, "color": "#ff0000", "speed": 50, "brightness": 128, "duration": 60000 }],
+//     "rules":  [{ "start": "17:00", "end": "23:30", "days": 127, "scene": 0 }] }
+//
+// A rule's scene of -1 turns the lights off. Parsing only fills in a
+// ScheduleConfig; it reaches the scheduler through ShowScheduler::submit().
+class ScheduleStore {
+public:
+    static void toJson(ShowScheduler& scheduler, JsonObject out);
+    // Fields that are missing keep their values in config. False if anything
+    // is invalid, in which case config is left as it was.
+    static bool fromJson(JsonObjectConst in, ScheduleConfig& config);
+
+    static bool save(ShowScheduler& scheduler, bool sdAvailable);
+    static bool load(ShowScheduler& scheduler, bool sdAvailable);
+};
+
+#endif // SCHEDULE_STORE_H
@@ -0,0 +1,33 @@
+#ifndef SEGMENT_STORE_H
+#define SEGMENT_STORE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+#include "led_controller.h"
+#include "calibration.h"
+
+// Persists the LED controller's segments to SEGMENTS_FILE_PATH on the SD card.
+// Changes are picked up through state events and written from update() once
+// they have settled for SEGMENTS_SAVE_DELAY, so dragging a range in the UI
+// doesn't rewrite the file on every step.
+class SegmentStore {
+public:
+    SegmentStore(LEDController& ledController, Calibration& calibration);
+    void begin();   // Load saved segments and start watching for changes
+    void update();  // Call from loop()
+
+    bool save();
+    bool load();
+
+private:
+    LEDController& _ledController;
+    Calibration& _calibration;  // Owns the SD card
+    std::atomic<bool> _dirty;
+    unsigned long _changedAt;
+    bool _loading;
+
+    static void onStateEvent(StateEvent event, void* context);
+};
+
+#endif // SEGMENT_STORE_H
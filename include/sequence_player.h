@@ -0,0 +1,83 @@
+#ifndef SEQUENCE_PLAYER_H
+#define SEQUENCE_PLAYER_H
+
+#include <Arduino.h>
+#include <SD.h>
+#include <atomic>
+#include "config.h"
+#include "led_controller.h"
+#include "calibration.h"
+#include "fseq_reader.h"
+
+// Plays FSEQ sequences from SEQUENCE_DIR as ANIMATION_SEQUENCE.
+//
+// The frame shown is chosen from the render clock (time since the first
+// frame / step time), so a slow card or a long decode drops frames rather
+// than stretching the show; each dropped frame counts as an underrun.
+class SequencePlayer : public FrameSource {
+public:
+    SequencePlayer(LEDController& ledController, Calibration& calibration);
+    void begin();
+    void update();  // Call from loop() before the LED update: applies play/stop
+
+    // Queue playback of SEQUENCE_DIR/name. Safe from any task.
+    bool play(const char* name, bool loop);
+    void stop();
+
+    bool isPlaying() const { return _playing; }
+    bool isLooping() const { return _loop; }
+    const char* getName() const { return _name; }
+    const char* getError() const { return _error; }
+
+    uint32_t getFrame() const { return _frame < 0 ? 0 : (uint32_t)_frame; }
+    uint32_t getFrameCount() const { return _reader.getFrameCount(); }
+    uint8_t getStepMs() const { return _reader.getStepMs(); }
+    uint32_t getChannelCount() const { return _reader.getChannelCount(); }
+    FseqCompression getCompression() const { return _reader.getCompression(); }
+
+    // Frames shown, frames skipped because decoding fell behind, decode time
+    uint32_t getFramesShown() const { return _framesShown; }
+    uint32_t getUnderruns() const { return _underruns; }
+    uint32_t getDecodeMicros() const { return _decodeMicros; }
+    uint32_t getPeakDecodeMicros() const { return _peakDecodeMicros; }
+
+    bool renderFrame(CRGB* leds, uint16_t count, unsigned long now) override;
+
+private:
+    class FileSource : public FseqSource {
+    public:
+        File file;
+        size_t read(uint32_t offset, uint8_t* buffer, size_t length) override;
+    };
+
+    enum Command : uint8_t { COMMAND_NONE, COMMAND_PLAY, COMMAND_STOP };
+
+    LEDController& _ledController;
+    Calibration& _calibration;
+    FileSource _source;
+    FseqReader _reader;
+
+    std::atomic<uint8_t> _command;
+    char _pendingName[SEQUENCE_NAME_LENGTH];
+    bool _pendingLoop;
+
+    char _name[SEQUENCE_NAME_LENGTH];
+    const char* _error;
+    bool _playing;
+    bool _loop;
+    bool _finished;
+    AnimationMode _previousMode;
+
+    bool _started;
+    unsigned long _startTime;
+    int32_t _frame;  // Last frame shown, -1 before the first
+    uint32_t _framesShown;
+    uint32_t _underruns;
+    uint32_t _decodeMicros;
+    uint32_t _peakDecodeMicros;
+
+    bool open(const char* name);
+    void close();
+};
+
+#endif // SEQUENCE_PLAYER_H
@@ -0,0 +1,40 @@
+#ifndef SHOW_CLOCK_H
+#define SHOW_CLOCK_H
+
+#include <stdint.h>
+
+// Time source for the show scheduler. The scheduler only sees this
+// interface, so tests can drive it with a fake clock.
+class ShowClock {
+public:
+    virtual ~ShowClock() {}
+
+    // Monotonic milliseconds, the same clock the LED frames run on
+    virtual uint32_t millis() = 0;
+
+    // Local wall-clock time. Returns false until the clock has been set.
+    // weekday: 0 = Sunday
+    virtual bool localTime(uint16_t& minuteOfDay, uint8_t& weekday) = 0;
+};
+
+#ifdef ARDUINO
+
+// ESP32 RTC, set over the API or by SNTP once WiFi is up
+class SystemClock : public ShowClock {
+public:
+    void begin();                     // Apply SCHEDULE_TIMEZONE
+    void startNtp();                  // No-op if SCHEDULE_NTP_SERVER is empty
+    void setEpoch(uint32_t epoch);    // Seconds since 1970 (UTC)
+    bool isSet() const;
+    uint32_t getEpoch() const;
+
+    uint32_t millis() override;
+    bool localTime(uint16_t& minuteOfDay, uint8_t& weekday) override;
+
+private:
+    bool _ntpStarted = false;
+};
+
+#endif
+
+#endif // SHOW_CLOCK_H
@@ -0,0 +1,96 @@
+#ifndef SHOW_SCHEDULER_H
+#define SHOW_SCHEDULER_H
+
+#include <stdint.h>
+#include <atomic>
+#include "config.h"
+#include "animation_mode.h"
+#include "show_clock.h"
+
+// What the lights should show: applied through the scheduler's handler
+struct Scene {
+    uint8_t mode;         // AnimationMode
+    uint32_t color;       // 0xRRGGBB
+    uint16_t speed;       // ms between frames
+    uint8_t brightness;
+    uint32_t durationMs;  // Time in the playlist before moving on
+};
+
+// While the local time is inside [start, end) on one of the given days, the
+// rule's scene replaces the playlist. Windows may wrap past midnight; the day
+// is the one the window started on.
+struct ScheduleRule {
+    uint16_t startMinute;  // Minutes after local midnight
+    uint16_t endMinute;
+    uint8_t days;          // Bit 0 = Sunday ... bit 6 = Saturday
+    int8_t scene;          // Index into the scene list, -1 = lights off
+    bool enabled;
+};
+
+// Everything the scheduler plays, replaced as a whole
+struct ScheduleConfig {
+    bool enabled;
+    Scene scenes[SCHEDULE_MAX_SCENES];
+    uint8_t sceneCount;
+    ScheduleRule rules[SCHEDULE_MAX_RULES];  // Unused slots have enabled = false
+};
+
+// scene is nullptr when the lights should be off
+typedef void (*SceneHandler)(const Scene* scene, void* context);
+
+// Plays a looping playlist of scenes, with time-of-day rules taking over
+// while they match. Scene changes are due relative to when the previous
+// scene started, not when update() noticed, so a late frame never shifts
+// the rest of the playlist. No Arduino dependencies beyond the clock.
+//
+// The schedule is changed by submitting a whole ScheduleConfig, from any
+// task: it is staged and swapped in by the next update(), so the playlist
+// never runs on a half-written schedule.
+class ShowScheduler {
+public:
+    ShowScheduler(ShowClock& clock, SceneHandler handler, void* context);
+
+    // Call once per frame, before rendering
+    void update();
+
+    // False if the config is invalid, or if update() is swapping in the
+    // previous one right now (try again). A config that hasn't been picked
+    // up yet is replaced.
+    bool submit(const ScheduleConfig& config);
+    // The last config submitted; update() may not have swapped it in yet
+    void getConfig(ScheduleConfig& config) const;
+    // Rules in range and pointing at real scenes, scenes with a mode that has content
+    static bool isValid(const ScheduleConfig& config);
+
+    // Status
+    int8_t getActiveScene() const { return _activeScene; }  // -1 = off or idle
+    int8_t getActiveRule() const { return _activeRule; }    // -1 = playlist
+    uint32_t getSceneRemaining();                            // ms, playlist only
+
+    // Whether a rule covers the given local time (exposed for tests)
+    static bool ruleMatches(const ScheduleRule& rule, uint16_t minuteOfDay, uint8_t weekday);
+
+private:
+    ShowClock& _clock;
+    SceneHandler _handler;
+    void* _context;
+
+    enum StageState : uint8_t { STAGE_EMPTY, STAGE_WRITING, STAGE_READY, STAGE_TAKING };
+
+    ScheduleConfig _config;  // Only touched by update()
+    ScheduleConfig _staged;  // Written by submit(), copied out by update()
+    std::atomic<uint8_t> _stage;
+
+    int8_t _activeRule;
+    int8_t _activeScene;
+    uint8_t _playlistIndex;
+    bool _playlistRunning;
+    uint32_t _sceneStart;
+    uint32_t _sceneDuration;  // Of the playing scene, for getSceneRemaining()
+
+    int8_t findRule();
+    void apply(int8_t scene);
+    void restart();
+};
+
+#endif // SHOW_SCHEDULER_H
@@ -0,0 +1,80 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include <stdint.h>
+#include "config.h"
+#include "led_position.h"
+
+// Uniform grid over calibrated LED positions.
+//
+// LED indices are stored grouped by cell, with cells ordered so that the
+// Z cells of one (X, Y) column are adjacent. A box query therefore visits
+// at most one contiguous span per column. Moving a single LED only shuffles
+// the cells between its old and new cell, so edits from the calibration
+// sliders never rebuild the whole index.
+class SpatialIndex {
+public:
+    static const uint16_t GRID = SPATIAL_GRID_SIZE;
+    static const uint16_t CELL_COUNT = GRID * GRID * GRID;
+
+    SpatialIndex();
+
+    // Rebuild from scratch (positions must stay valid for the index's lifetime)
+    void build(const LEDPosition* positions);
+
+    // Re-file one LED after its position changed
+    void update(uint16_t index);
+
+    // Indices of LEDs within radius of center; returns the number written
+    uint16_t querySphere(const LEDPosition& center, float radius, uint16_t* out, uint16_t maxOut) const;
+
+    // Indices of LEDs inside the axis-aligned box; returns the number written
+    uint16_t queryBox(const LEDPosition& min, const LEDPosition& max, uint16_t* out, uint16_t maxOut) const;
+
+    // Up to k nearest LEDs, closest first. outDistSq (optional) receives squared distances.
+    uint16_t queryNearest(const LEDPosition& point, uint16_t k, uint16_t* out, float* outDistSq = nullptr) const;
+
+    // Visit candidate spans for a box without per-LED filtering.
+    // fn(const uint16_t* indices, uint16_t count) is called once per non-empty span.
+    template <typename Fn>
+    void forEachSpan(const LEDPosition& min, const LEDPosition& max, Fn fn) const {
+        int x0 = cellCoord(min.x), x1 = cellCoord(max.x);
+        int y0 = cellCoord(min.y), y1 = cellCoord(max.y);
+        int z0 = cellCoord(min.z), z1 = cellCoord(max.z);
+        for (int cx = x0; cx <= x1; cx++) {
+            for (int cy = y0; cy <= y1; cy++) {
+                uint16_t base = cellIndex(cx, cy, 0);
+                uint16_t begin = _cellStart[base + z0];
+                uint16_t end = _cellStart[base + z1 + 1];
+                if (end > begin) {
+                    fn(&_items[begin], (uint16_t)(end - begin));
+                }
+            }
+        }
+    }
+
+    // LEDs in a single cell
+    uint16_t getCellOf(uint16_t index) const { return _ledCell[index]; }
+    const uint16_t* cellBegin(uint16_t cell) const { return &_items[_cellStart[cell]]; }
+    uint16_t cellSize(uint16_t cell) const { return _cellStart[cell + 1] - _cellStart[cell]; }
+
+    static int cellCoord(float v) {
+        int c = (int)((v + 1.0f) * 0.5f * GRID);
+        return c < 0 ? 0 : (c >= GRID ? GRID - 1 : c);
+    }
+    static uint16_t cellIndex(int cx, int cy, int cz) {
+        return (uint16_t)((cx * GRID + cy) * GRID + cz);
+    }
+
+private:
+    const LEDPosition* _positions;
+    uint16_t _cellStart[CELL_COUNT + 1];  // _items range of each cell
+    uint16_t _items[NUM_LEDS];            // LED indices grouped by cell
+    uint16_t _slot[NUM_LEDS];             // Where each LED sits in _items
+    uint16_t _ledCell[NUM_LEDS];
+
+    uint16_t cellFor(const LEDPosition& p) const;
+    void swapSlots(uint16_t a, uint16_t b);
+};
+
+#endif // SPATIAL_INDEX_H
@@ -0,0 +1,53 @@
+#ifndef STATE_EVENTS_H
+#define STATE_EVENTS_H
+
+#include <stdint.h>
+
+// Typed change notifications emitted by LEDController and Calibration
+enum StateEvent {
+    STATE_EVENT_POWER = 0,
+    STATE_EVENT_BRIGHTNESS,
+    STATE_EVENT_COLOR,
+    STATE_EVENT_ANIMATION,
+    STATE_EVENT_SPEED,
+    STATE_EVENT_CALIBRATION_LED,
+    STATE_EVENT_CALIBRATION_POSITIONS,
+    STATE_EVENT_SEGMENTS,
+    STATE_EVENT_COUNT
+};
+
+#define STATE_EVENT_BIT(event) (1UL << (event))
+
+// Listeners run synchronously in whichever task made the change (loop, LVGL
+// or the web server), so they should just record the event and return.
+typedef void (*StateListener)(StateEvent event, void* context);
+
+static const uint8_t MAX_STATE_LISTENERS = 4;
+
+class StateNotifier {
+public:
+    StateNotifier() : _count(0) {}
+
+    bool addListener(StateListener listener, void* context) {
+        if (_count >= MAX_STATE_LISTENERS) {
+            return false;
+        }
+        _listeners[_count] = listener;
+        _contexts[_count] = context;
+        _count++;
+        return true;
+    }
+
+    void emit(StateEvent event) const {
+        for (uint8_t i = 0; i < _count; i++) {
+            _listeners[i](event, _contexts[i]);
+        }
+    }
+
+private:
+    StateListener _listeners[MAX_STATE_LISTENERS];
+    void* _contexts[MAX_STATE_LISTENERS];
+    uint8_t _count;
+};
+
+#endif // STATE_EVENTS_H
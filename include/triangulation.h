@@ -0,0 +1,67 @@
+#ifndef TRIANGULATION_H
+#define TRIANGULATION_H
+
+#include <stdint.h>
+#include "config.h"
+#include "led_position.h"
+
+// One LED as seen in one photo. Image coordinates are in pixels with
+// u to the right and v downward; any resolution works as long as it is
+// consistent within a view.
+struct ImagePoint {
+    float u;
+    float v;
+    bool seen;
+};
+
+// Rebuilds 3D LED positions from two or more photos taken around the tree.
+//
+// Each view is treated as an orthographic camera looking at the tree from
+// `angle` degrees around the vertical (Y) axis, so an LED at (x, y, z)
+// appears at u = x*cos(a) - z*sin(a), v = -y, up to a per-view offset and
+// scale. Views are centred on their own mean and scaled by the spread of
+// v (height is the same in every view), then each LED's X/Z is a 2x2 least
+// squares fit over the views that saw it. LEDs seen too rarely are filled
+// in by interpolating along the strip.
+//
+// Pure C++ so it can run on the host as well as the device.
+class TriangulationSolver {
+public:
+    explicit TriangulationSolver(uint16_t ledCount);
+    ~TriangulationSolver();
+
+    // points must hold ledCount entries. Returns false when out of memory
+    // or TRIANGULATION_MAX_VIEWS views were already added.
+    bool addView(float angleDegrees, const ImagePoint* points);
+    uint8_t getViewCount() const { return _viewCount; }
+
+    // Fill out[ledCount] with positions normalized to -1..1 (uniform scale,
+    // centred on the bounding box). Returns false when fewer than two LEDs
+    // could be triangulated.
+    bool solve(LEDPosition* out);
+
+    // Results of the last solve()
+    uint16_t getTriangulatedCount() const { return _triangulated; }
+    uint16_t getInterpolatedCount() const { return _interpolated; }
+    float getRmsError() const { return _rmsError; }  // Reprojection error in normalized view units
+
+private:
+    struct View {
+        float angle;  // Radians
+        float cosA;
+        float sinA;
+        ImagePoint* points;
+    };
+
+    uint16_t _ledCount;
+    uint8_t _viewCount;
+    View _views[TRIANGULATION_MAX_VIEWS];
+    uint16_t _triangulated;
+    uint16_t _interpolated;
+    float _rmsError;
+
+    void normalizeView(View& view);
+    static void fillGaps(float* values, const bool* known, uint16_t count);
+};
+
+#endif // TRIANGULATION_H
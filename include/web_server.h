@@ -4,19 +4,36 @@
 #include <ESPAsyncWebServer.h>
 #include <AsyncJson.h>
 #include <ArduinoJson.h>
+#include <atomic>
 #include "led_controller.h"
 #include "calibration.h"
+#include "show_scheduler.h"
+#include "preset_store.h"
+#include "sequence_player.h"
+#include "audio_input.h"
 #include "config.h"
 
 class WebServer {
 public:
-    WebServer(LEDController& ledController, Calibration& calibration);
+    WebServer(LEDController& ledController, Calibration& calibration, ShowScheduler& scheduler, SystemClock& clock,
+              PresetStore& presets, SequencePlayer& sequence, AudioInput& audio);
     void begin();
+    void update();  // Push coalesced state changes to connected clients
 
 private:
     AsyncWebServer _server;
+    AsyncEventSource _events;
     LEDController& _ledController;
     Calibration& _calibration;
+    ShowScheduler& _scheduler;
+    SystemClock& _clock;
+    PresetStore& _presets;
+    SequencePlayer& _sequence;
+    AudioInput& _audio;
+    std::atomic<uint32_t> _pendingEvents;
+    unsigned long _lastPush;
+
+    static void onStateEvent(StateEvent event, void* context);
 
     void setupRoutes();
     void handleGetState(AsyncWebServerRequest* request);
@@ -25,6 +42,33 @@ private:
     void handleSetColor(AsyncWebServerRequest* request, JsonVariant& json);
     void handleSetAnimation(AsyncWebServerRequest* request, JsonVariant& json);
     void handleSetSpeed(AsyncWebServerRequest* request, JsonVariant& json);
+    void handleSetOutput(AsyncWebServerRequest* request, JsonVariant& json);
+    void handleSetTransition(AsyncWebServerRequest* request, JsonVariant& json);
+    void handleSetFrameCache(AsyncWebServerRequest* request, JsonVariant& json);
+    void handleSetParticles(AsyncWebServerRequest* request, JsonVariant& json);
+    String getParticlesJson();
+    void handleSetLayer(AsyncWebServerRequest* request, JsonVariant& json);
+    void handleSetSegment(AsyncWebServerRequest* request, JsonVariant& json);
+
+    // Scheduler endpoints
+    void handleSetSchedule(AsyncWebServerRequest* request, JsonVariant& json);
+    void handleSetClock(AsyncWebServerRequest* request, JsonVariant& json);
+    String getScheduleJson();
+    String getClockJson();
+
+    // Preset endpoints
+    void handleSavePreset(AsyncWebServerRequest* request, JsonVariant& json);
+    void handleDeletePreset(AsyncWebServerRequest* request, JsonVariant& json);
+    void handleRecallPreset(AsyncWebServerRequest* request);
+    String getPresetsJson();
+
+    // Audio input endpoints
+    void handleSetAudio(AsyncWebServerRequest* request, JsonVariant& json);
+    String getAudioJson();
+
+    // Sequence playback endpoints
+    void handleSetSequence(AsyncWebServerRequest* request, JsonVariant& json);
+    String getSequenceJson();
 
     // Calibration endpoints
     void handleGetCalibration(AsyncWebServerRequest* request);
@@ -32,9 +76,14 @@ private:
     void handleSetLEDPosition(AsyncWebServerRequest* request, JsonVariant& json);
     void handleSaveCalibration(AsyncWebServerRequest* request);
     void handleResetCalibration(AsyncWebServerRequest* request);
+    void handleSetLEDPositions(AsyncWebServerRequest* request, JsonVariant& json);
+    void handleSetLEDPositionsBinary(AsyncWebServerRequest* request);
+    void handleImportCalibration(AsyncWebServerRequest* request, JsonVariant& json);
+    void handleGrayCode(AsyncWebServerRequest* request, JsonVariant& json);
 
     String getStateJson();
     String getCalibrationJson();
+    String getOutputJson();
 };
 
 #endif // WEB_SERVER_H
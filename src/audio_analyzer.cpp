@@ -0,0 +1,191 @@
+#include "audio_analyzer.h"
+#include <math.h>
+#include <string.h>
+
+static_assert((AUDIO_FFT_SIZE & (AUDIO_FFT_SIZE - 1)) == 0, "AUDIO_FFT_SIZE must be a power of two");
+
+static const float TWO_PI_F = 6.28318531f;
+static const float PEAK_DECAY_DB = 0.05f;  // Per block, ~3 dB/s
+static const float FLUX_ALPHA = 0.05f;     // Running flux statistics, ~0.3 s
+static const uint8_t BASS_BANDS = 2;
+static const uint8_t SEQLOCK_RETRIES = 8;
+
+AudioAnalyzer::AudioAnalyzer() : _sequence(0) {
+    for (uint16_t n = 0; n < AUDIO_FFT_SIZE; n++) {
+        _window[n] = (int16_t)(32767.0f * (0.5f - 0.5f * cosf(TWO_PI_F * n / AUDIO_FFT_SIZE)));
+    }
+    for (uint16_t k = 0; k < AUDIO_FFT_SIZE / 2; k++) {
+        _cos[k] = (int16_t)(32767.0f * cosf(TWO_PI_F * k / AUDIO_FFT_SIZE));
+        _sin[k] = (int16_t)(32767.0f * sinf(TWO_PI_F * k / AUDIO_FFT_SIZE));
+    }
+
+    // Log-spaced band edges; every band gets at least one bin
+    const float nyquist = AUDIO_SAMPLE_RATE / 2.0f;
+    const float binHz = (float)AUDIO_SAMPLE_RATE / AUDIO_FFT_SIZE;
+    for (uint8_t b = 0; b <= AUDIO_BANDS; b++) {
+        float freq = AUDIO_MIN_FREQ * powf(nyquist / AUDIO_MIN_FREQ, (float)b / AUDIO_BANDS);
+        uint16_t bin = (uint16_t)(freq / binHz + 0.5f);
+        if (b > 0 && bin <= _bandStart[b - 1]) bin = _bandStart[b - 1] + 1;
+        if (bin < 1) bin = 1;  // Skip DC
+        if (bin > AUDIO_FFT_SIZE / 2) bin = AUDIO_FFT_SIZE / 2;
+        _bandStart[b] = bin;
+    }
+
+    reset();
+}
+
+void AudioAnalyzer::reset() {
+    memset(_ring, 0, sizeof(_ring));
+    _ringPos = 0;
+    _sinceHop = 0;
+    for (uint8_t b = 0; b < AUDIO_BANDS; b++) {
+        _bandPeak[b] = 0;
+    }
+    _levelPeak = 0;
+    _prevBass = 0;
+    _fluxMean = 0;
+    _fluxVar = 0;
+    _sinceBeat = 0;
+    _lastBeat = false;
+    memset(&_state, 0, sizeof(_state));
+    publish();
+}
+
+uint16_t AudioAnalyzer::feed(const int16_t* samples, size_t count) {
+    uint16_t blocks = 0;
+    for (size_t i = 0; i < count; i++) {
+        _ring[_ringPos] = samples[i];
+        _ringPos = (_ringPos + 1) & (AUDIO_FFT_SIZE - 1);
+        if (++_sinceHop >= AUDIO_HOP_SIZE) {
+            _sinceHop = 0;
+            analyse();
+            blocks++;
+        }
+    }
+    return blocks;
+}
+
+void AudioAnalyzer::fft() {
+    const uint16_t n = AUDIO_FFT_SIZE;
+
+    // Bit-reversal permutation
+    for (uint16_t i = 1, j = 0; i < n; i++) {
+        uint16_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j |= bit;
+        if (i < j) {
+            int16_t t = _re[i]; _re[i] = _re[j]; _re[j] = t;
+            t = _im[i]; _im[i] = _im[j]; _im[j] = t;
+        }
+    }
+
+    // Radix-2 butterflies, halving each stage: output is X[k] / n
+    for (uint16_t len = 2; len <= n; len <<= 1) {
+        uint16_t half = len >> 1;
+        uint16_t step = n / len;
+        for (uint16_t i = 0; i < n; i += len) {
+            for (uint16_t j = 0; j < half; j++) {
+                int32_t wr = _cos[j * step];
+                int32_t wi = -_sin[j * step];
+                uint16_t a = i + j;
+                uint16_t b = a + half;
+                int32_t tr = (wr * _re[b] - wi * _im[b]) >> 15;
+                int32_t ti = (wr * _im[b] + wi * _re[b]) >> 15;
+                int32_t ur = _re[a];
+                int32_t ui = _im[a];
+                _re[a] = (int16_t)((ur + tr) >> 1);
+                _im[a] = (int16_t)((ui + ti) >> 1);
+                _re[b] = (int16_t)((ur - tr) >> 1);
+                _im[b] = (int16_t)((ui - ti) >> 1);
+            }
+        }
+    }
+}
+
+uint8_t AudioAnalyzer::toLevel(float db, float& peak, uint8_t previous) {
+    // The peak never drops below the gate plus the range, so silence stays dark
+    const float floorPeak = AUDIO_NOISE_GATE_DB + AUDIO_DYNAMIC_RANGE_DB;
+    peak -= PEAK_DECAY_DB;
+    if (peak < db) peak = db;
+    if (peak < floorPeak) peak = floorPeak;
+
+    float t = (db - (peak - AUDIO_DYNAMIC_RANGE_DB)) / AUDIO_DYNAMIC_RANGE_DB;
+    uint8_t level = 0;
+    if (db > AUDIO_NOISE_GATE_DB && t > 0) {
+        level = t >= 1 ? 255 : (uint8_t)(t * 255);
+    }
+    // Instant attack, limited release
+    uint8_t released = previous > AUDIO_RELEASE ? previous - AUDIO_RELEASE : 0;
+    return level > released ? level : released;
+}
+
+void AudioAnalyzer::analyse() {
+    // Oldest sample first, windowed; magnitudes stay below 32768 so the
+    // scaled butterflies can't overflow
+    for (uint16_t k = 0; k < AUDIO_FFT_SIZE; k++) {
+        int32_t v = ((int32_t)_ring[(_ringPos + k) & (AUDIO_FFT_SIZE - 1)] * _window[k]) >> 15;
+        _re[k] = (int16_t)(v < -32767 ? -32767 : v);
+        _im[k] = 0;
+    }
+    fft();
+
+    float total = 0;
+    float bass = 0;
+    for (uint8_t b = 0; b < AUDIO_BANDS; b++) {
+        uint64_t power = 0;
+        for (uint16_t k = _bandStart[b]; k < _bandStart[b + 1]; k++) {
+            power += (uint32_t)((int32_t)_re[k] * _re[k]) + (uint32_t)((int32_t)_im[k] * _im[k]);
+        }
+        total += (float)power;
+        if (b < BASS_BANDS) bass += (float)power;
+        float db = 10.0f * log10f((float)power + 1.0f);
+        _state.bands[b] = toLevel(db, _bandPeak[b], _state.bands[b]);
+    }
+    _state.level = toLevel(10.0f * log10f(total + 1.0f), _levelPeak, _state.level);
+
+    // Onset: a rise in bass energy that stands out from recent rises
+    float bassDb = 10.0f * log10f(bass + 1.0f);
+    float flux = bassDb > _prevBass ? bassDb - _prevBass : 0;
+    _prevBass = bassDb;
+    float threshold = _fluxMean + AUDIO_BEAT_THRESHOLD * sqrtf(_fluxVar);
+    const uint16_t minBlocks = (uint32_t)AUDIO_BEAT_MIN_INTERVAL_MS * AUDIO_SAMPLE_RATE / AUDIO_HOP_SIZE / 1000;
+    _lastBeat = flux > threshold && flux >= AUDIO_BEAT_MIN_RISE_DB &&
+                bassDb > AUDIO_NOISE_GATE_DB && _sinceBeat >= minBlocks;
+    float delta = flux - _fluxMean;
+    _fluxMean += FLUX_ALPHA * delta;
+    _fluxVar = (1 - FLUX_ALPHA) * (_fluxVar + FLUX_ALPHA * delta * delta);
+
+    if (_lastBeat) {
+        _state.beats++;
+        _sinceBeat = 0;
+    } else if (_sinceBeat < 0xFFFF) {
+        _sinceBeat++;
+    }
+    _state.blocks++;
+    publish();
+}
+
+void AudioAnalyzer::publish() {
+    uint32_t seq = _sequence.load(std::memory_order_relaxed);
+    _sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _published = _state;
+    std::atomic_thread_fence(std::memory_order_release);
+    _sequence.store(seq + 2, std::memory_order_relaxed);
+}
+
+bool AudioAnalyzer::read(AudioSnapshot& out) const {
+    for (uint8_t attempt = 0; attempt < SEQLOCK_RETRIES; attempt++) {
+        uint32_t before = _sequence.load(std::memory_order_acquire);
+        if (before & 1) continue;
+        AudioSnapshot copy = _published;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_sequence.load(std::memory_order_relaxed) == before) {
+            out = copy;
+            return true;
+        }
+    }
+    return false;
+}
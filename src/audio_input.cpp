@@ -0,0 +1,152 @@
+#include "audio_input.h"
+#include <driver/i2s.h>
+
+static const i2s_port_t AUDIO_I2S_PORT = I2S_NUM_0;
+static const size_t AUDIO_UDP_MAX_SAMPLES = 1024;  // Largest packet accepted, in samples
+
+AudioInput::AudioInput(AudioAnalyzer& analyzer)
+    : _analyzer(analyzer)
+    , _requested(AUDIO_DEFAULT_SOURCE)
+    , _source(AUDIO_SOURCE_OFF)
+    , _lastSamples(0)
+    , _blockMicros(0)
+    , _peakBlockMicros(0)
+    , _statMicros(0)
+    , _statBlocks(0)
+    , _statStart(0) {
+}
+
+void AudioInput::begin() {
+    xTaskCreatePinnedToCore(taskEntry, "audio", AUDIO_TASK_STACK, this, AUDIO_TASK_PRIORITY, nullptr, 0);
+}
+
+void AudioInput::setSource(uint8_t source) {
+    if (source <= AUDIO_SOURCE_UDP) {
+        _requested.store(source);
+    }
+}
+
+bool AudioInput::isReceiving() const {
+    return _lastSamples != 0 && millis() - _lastSamples < 1000;
+}
+
+void AudioInput::taskEntry(void* param) {
+    static_cast<AudioInput*>(param)->run();
+}
+
+void AudioInput::run() {
+    static int16_t samples[AUDIO_UDP_MAX_SAMPLES];
+
+    for (;;) {
+        uint8_t wanted = _requested.load();
+        if (wanted != _source) {
+            closeSource();
+            openSource(wanted);
+        }
+
+        size_t count = 0;
+        if (_source == AUDIO_SOURCE_I2S) {
+            count = readI2S(samples, AUDIO_HOP_SIZE);
+        } else if (_source == AUDIO_SOURCE_UDP) {
+            count = readUdp(samples, AUDIO_UDP_MAX_SAMPLES);
+        }
+        if (count == 0) {
+            vTaskDelay(pdMS_TO_TICKS(_source == AUDIO_SOURCE_OFF ? 100 : 2));
+            continue;
+        }
+        _lastSamples = millis();
+
+        uint32_t start = micros();
+        uint16_t blocks = _analyzer.feed(samples, count);
+        if (blocks == 0) {
+            continue;
+        }
+        uint32_t perBlock = (micros() - start) / blocks;
+        _statMicros += perBlock * blocks;
+        _statBlocks += blocks;
+        if (perBlock > _peakBlockMicros) {
+            _peakBlockMicros = perBlock;
+        }
+        if (millis() - _statStart >= 1000) {
+            _blockMicros = _statMicros / _statBlocks;
+            _statMicros = 0;
+            _statBlocks = 0;
+            _statStart = millis();
+        }
+    }
+}
+
+void AudioInput::openSource(uint8_t source) {
+    _analyzer.reset();
+    _source = source;
+
+    if (source == AUDIO_SOURCE_I2S) {
+        i2s_config_t config = {};
+        config.mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX);
+        config.sample_rate = AUDIO_SAMPLE_RATE;
+        config.bits_per_sample = I2S_BITS_PER_SAMPLE_32BIT;
+        config.channel_format = I2S_CHANNEL_FMT_ONLY_LEFT;
+        config.communication_format = I2S_COMM_FORMAT_STAND_I2S;
+        config.intr_alloc_flags = ESP_INTR_FLAG_LEVEL1;
+        config.dma_buf_count = 4;
+        config.dma_buf_len = AUDIO_HOP_SIZE;
+
+        i2s_pin_config_t pins = {};
+        pins.mck_io_num = I2S_PIN_NO_CHANGE;
+        pins.bck_io_num = AUDIO_I2S_SCK;
+        pins.ws_io_num = AUDIO_I2S_WS;
+        pins.data_out_num = I2S_PIN_NO_CHANGE;
+        pins.data_in_num = AUDIO_I2S_SD;
+
+        if (i2s_driver_install(AUDIO_I2S_PORT, &config, 0, nullptr) != ESP_OK) {
+            Serial.println("Audio: I2S driver install failed");
+            _source = AUDIO_SOURCE_OFF;
+        } else if (i2s_set_pin(AUDIO_I2S_PORT, &pins) != ESP_OK) {
+            Serial.println("Audio: I2S pin setup failed");
+            i2s_driver_uninstall(AUDIO_I2S_PORT);
+            _source = AUDIO_SOURCE_OFF;
+        }
+    } else if (source == AUDIO_SOURCE_UDP) {
+        if (!_udp.begin(AUDIO_UDP_PORT)) {
+            Serial.println("Audio: UDP listen failed");
+            _source = AUDIO_SOURCE_OFF;
+        }
+    }
+
+    if (_source != source) {
+        _requested.store(AUDIO_SOURCE_OFF);  // Don't retry every pass
+    } else if (source != AUDIO_SOURCE_OFF) {
+        Serial.printf("Audio: listening on %s\n", source == AUDIO_SOURCE_I2S ? "I2S" : "UDP");
+    }
+}
+
+void AudioInput::closeSource() {
+    if (_source == AUDIO_SOURCE_I2S) {
+        i2s_driver_uninstall(AUDIO_I2S_PORT);
+    } else if (_source == AUDIO_SOURCE_UDP) {
+        _udp.stop();
+    }
+    _source = AUDIO_SOURCE_OFF;
+}
+
+size_t AudioInput::readI2S(int16_t* samples, size_t max) {
+    // MEMS mics deliver 24-bit samples left-justified in 32-bit slots
+    static int32_t raw[AUDIO_HOP_SIZE];
+    size_t bytes = 0;
+    if (max > AUDIO_HOP_SIZE) max = AUDIO_HOP_SIZE;
+    i2s_read(AUDIO_I2S_PORT, raw, max * sizeof(int32_t), &bytes, pdMS_TO_TICKS(100));
+    size_t count = bytes / sizeof(int32_t);
+    for (size_t i = 0; i < count; i++) {
+        int32_t v = raw[i] >> AUDIO_I2S_SHIFT;
+        samples[i] = (int16_t)(v > 32767 ? 32767 : (v < -32767 ? -32767 : v));
+    }
+    return count;
+}
+
+size_t AudioInput::readUdp(int16_t* samples, size_t max) {
+    if (_udp.parsePacket() <= 0) {
+        return 0;
+    }
+    int bytes = _udp.read((uint8_t*)samples, max * sizeof(int16_t));
+    return bytes > 0 ? bytes / sizeof(int16_t) : 0;
+}
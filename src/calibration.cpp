@@ -3,6 +3,9 @@
 
 Calibration::Calibration()
     : _calibrationLED(-1)
+    , _revision(0)
+    , _orderRevision(0)
+    , _ordersValid(false)
     , _sdAvailable(false)
     , _sdSPI(nullptr) {
     resetToLinear();
@@ -79,6 +82,57 @@ void Calibration::setPosition(uint16_t index, float x, float y, float z) {
         _positions[index].x = constrain(x, -1.0f, 1.0f);
         _positions[index].y = constrain(y, -1.0f, 1.0f);
         _positions[index].z = constrain(z, -1.0f, 1.0f);
+        _spatialIndex.update(index);
+        _revision++;
+        _events.emit(STATE_EVENT_CALIBRATION_POSITIONS);
+    }
+}
+
+void Calibration::setPositions(const LEDPosition* positions) {
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        _positions[i].x = constrain(positions[i].x, -1.0f, 1.0f);
+        _positions[i].y = constrain(positions[i].y, -1.0f, 1.0f);
+        _positions[i].z = constrain(positions[i].z, -1.0f, 1.0f);
+    }
+    _spatialIndex.build(_positions);
+    _revision++;
+    _events.emit(STATE_EVENT_CALIBRATION_POSITIONS);
+}
+
+bool Calibration::setPositions(const uint16_t* indices, const LEDPosition* positions, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++) {
+        if (indices[i] >= NUM_LEDS) {
+            return false;
+        }
+    }
+    if (count == 0) {
+        return true;
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        LEDPosition& pos = _positions[indices[i]];
+        pos.x = constrain(positions[i].x, -1.0f, 1.0f);
+        pos.y = constrain(positions[i].y, -1.0f, 1.0f);
+        pos.z = constrain(positions[i].z, -1.0f, 1.0f);
+    }
+
+    // Re-filing a few LEDs is cheaper than a rebuild; a large batch is not
+    if (count > NUM_LEDS / 4) {
+        _spatialIndex.build(_positions);
+    } else {
+        for (uint16_t i = 0; i < count; i++) {
+            _spatialIndex.update(indices[i]);
+        }
+    }
+    _revision++;
+    _events.emit(STATE_EVENT_CALIBRATION_POSITIONS);
+    return true;
+}
+
+void Calibration::setCalibrationLED(int16_t index) {
+    if (index != _calibrationLED) {
+        _calibrationLED = index;
+        _events.emit(STATE_EVENT_CALIBRATION_LED);
     }
 }
 
@@ -89,51 +143,67 @@ LEDPosition Calibration::getPosition(uint16_t index) const {
     return {0, 0, 0};
 }
 
-void Calibration::getSortedByAxis(uint8_t axis, uint16_t* outIndices) const {
-    // Initialize with sequential indices
-    for (uint16_t i = 0; i < NUM_LEDS; i++) {
-        outIndices[i] = i;
+void Calibration::updateOrders() const {
+    if (_ordersValid && _orderRevision == _revision) {
+        return;
     }
 
-    // Sort by the specified axis
-    std::sort(outIndices, outIndices + NUM_LEDS, [this, axis](uint16_t a, uint16_t b) {
-        float valA, valB;
-        switch (axis) {
-            case 0: valA = _positions[a].x; valB = _positions[b].x; break;
-            case 1: valA = _positions[a].y; valB = _positions[b].y; break;
-            case 2: valA = _positions[a].z; valB = _positions[b].z; break;
-            default: valA = valB = 0; break;
+    // Evaluate each sort key once per LED rather than inside the comparator
+    static float keys[NUM_LEDS];
+    for (uint8_t order = 0; order < SORT_ORDER_COUNT; order++) {
+        for (uint16_t i = 0; i < NUM_LEDS; i++) {
+            const LEDPosition& p = _positions[i];
+            switch (order) {
+                case SORT_BY_X:      keys[i] = p.x; break;
+                case SORT_BY_Y:      keys[i] = p.y; break;
+                case SORT_BY_Z:      keys[i] = p.z; break;
+                case SORT_BY_ANGLE:  keys[i] = atan2(p.z, p.x); break;
+                case SORT_BY_RADIUS: keys[i] = p.x * p.x + p.y * p.y + p.z * p.z; break;
+            }
+            _order[order][i] = i;
         }
-        return valA < valB;
-    });
-}
 
-void Calibration::getSortedByAngle(uint16_t* outIndices) const {
-    for (uint16_t i = 0; i < NUM_LEDS; i++) {
-        outIndices[i] = i;
+        // Stable so LEDs at equal positions keep strip order
+        std::stable_sort(_order[order], _order[order] + NUM_LEDS, [](uint16_t a, uint16_t b) {
+            return keys[a] < keys[b];
+        });
+
+        for (uint16_t r = 0; r < NUM_LEDS; r++) {
+            _rank[order][_order[order][r]] = r;
+        }
     }
 
-    std::sort(outIndices, outIndices + NUM_LEDS, [this](uint16_t a, uint16_t b) {
-        float angleA = atan2(_positions[a].z, _positions[a].x);
-        float angleB = atan2(_positions[b].z, _positions[b].x);
-        return angleA < angleB;
-    });
+    _orderRevision = _revision;
+    _ordersValid = true;
 }
 
-void Calibration::getSortedByRadius(uint16_t* outIndices) const {
-    for (uint16_t i = 0; i < NUM_LEDS; i++) {
-        outIndices[i] = i;
+const uint16_t* Calibration::getOrder(SortOrder order) const {
+    updateOrders();
+    return _order[order];
+}
+
+const uint16_t* Calibration::getRanks(SortOrder order) const {
+    updateOrders();
+    return _rank[order];
+}
+
+void Calibration::getSortedByAxis(uint8_t axis, uint16_t* outIndices) const {
+    if (axis > 2) {
+        // Unknown axis - leave in strip order
+        for (uint16_t i = 0; i < NUM_LEDS; i++) {
+            outIndices[i] = i;
+        }
+        return;
     }
+    memcpy(outIndices, getOrder((SortOrder)(SORT_BY_X + axis)), NUM_LEDS * sizeof(uint16_t));
+}
 
-    std::sort(outIndices, outIndices + NUM_LEDS, [this](uint16_t a, uint16_t b) {
-        float radA = _positions[a].x * _positions[a].x +
-                     _positions[a].y * _positions[a].y +
-                     _positions[a].z * _positions[a].z;
-        float radB = _positions[b].x * _positions[b].x +
-                     _positions[b].y * _positions[b].y +
-                     _positions[b].z * _positions[b].z;
-        return radA < radB;
-    });
+void Calibration::getSortedByAngle(uint16_t* outIndices) const {
+    memcpy(outIndices, getOrder(SORT_BY_ANGLE), NUM_LEDS * sizeof(uint16_t));
+}
+
+void Calibration::getSortedByRadius(uint16_t* outIndices) const {
+    memcpy(outIndices, getOrder(SORT_BY_RADIUS), NUM_LEDS * sizeof(uint16_t));
 }
 
 bool Calibration::save() {
@@ -207,6 +277,9 @@ bool Calibration::load() {
         _positions[i].z = pos["z"] | 0.0f;
         i++;
     }
+    _spatialIndex.build(_positions);
+    _revision++;
+    _events.emit(STATE_EVENT_CALIBRATION_POSITIONS);
 
     return true;
 }
@@ -218,4 +291,7 @@ void Calibration::resetToLinear() {
         _positions[i].y = 0.0f;
         _positions[i].z = 0.0f;
     }
+    _spatialIndex.build(_positions);
+    _revision++;
+    _events.emit(STATE_EVENT_CALIBRATION_POSITIONS);
 }
@@ -1,14 +1,28 @@
 #include "display.h"
 #include "config.h"
+#include "lv_mem_psram.h"
 
 #include <Arduino_GFX_Library.h>
 #include <Wire.h>
 
 // Touch controller state
+// With TOUCH_INT wired, a background task owns the I2C reads and LVGL only
+// copies the cached values. touchMux guards the cache between the two.
 static bool touchAvailable = false;
 static int16_t touchX = 0;
 static int16_t touchY = 0;
 static bool touchPressed = false;
+static bool swallowTouch = false;  // Touch that woke the screen - hidden from LVGL until released
+static portMUX_TYPE touchMux = portMUX_INITIALIZER_UNLOCKED;
+
+#if TOUCH_INT >= 0
+static TaskHandle_t touchTaskHandle = nullptr;
+#endif
+
+// ST7789 sleep commands. The panel keeps its frame memory while asleep.
+static const uint8_t ST7789_CMD_SLPIN = 0x10;
+static const uint8_t ST7789_CMD_SLPOUT = 0x11;
+static const unsigned long ST7789_SLPOUT_SETTLE_MS = 5;  // Before the next command after SLPOUT
 
 // Initialize CST816D touch controller
 static bool initTouch() {
@@ -37,14 +51,44 @@ static void readTouch() {
         uint8_t yh = Wire.read();           // 0x05: Y high + touch ID
         uint8_t yl = Wire.read();           // 0x06: Y low
 
-        touchPressed = (numPoints > 0);
-        if (touchPressed) {
+        bool pressed = (numPoints > 0);
+        portENTER_CRITICAL(&touchMux);
+        touchPressed = pressed;
+        if (pressed) {
             touchX = ((xh & 0x0F) << 8) | xl;
             touchY = ((yh & 0x0F) << 8) | yl;
         }
+        portEXIT_CRITICAL(&touchMux);
+    }
+}
+
+#if TOUCH_INT >= 0
+// CST816D pulls INT low whenever it has new touch data
+static void IRAM_ATTR onTouchInterrupt() {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(touchTaskHandle, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+// Sleeps until the controller signals new data, so an idle screen costs no I2C traffic
+static void touchTask(void* param) {
+    for (;;) {
+        TickType_t wait = touchPressed ? pdMS_TO_TICKS(TOUCH_HELD_POLL_MS) : portMAX_DELAY;
+        ulTaskNotifyTake(pdTRUE, wait);
+        readTouch();
     }
 }
 
+static void startTouchTask() {
+    xTaskCreatePinnedToCore(touchTask, "touch", 3072, nullptr, 2, &touchTaskHandle, 0);
+    pinMode(TOUCH_INT, INPUT_PULLUP);
+    attachInterrupt(TOUCH_INT, onTouchInterrupt, FALLING);
+    xTaskNotifyGive(touchTaskHandle);  // Pick up the initial state
+}
+#endif
+
 // ============================================
 // Arduino_GFX Configuration for ST7789
 // ============================================
@@ -71,6 +115,7 @@ Arduino_GFX *gfx = new Arduino_ST7789(
 );
 
 // LVGL buffer allocation
+lv_disp_t* Display::_disp = nullptr;
 lv_disp_draw_buf_t Display::_drawBuf;
 lv_color_t* Display::_buf1 = nullptr;
 lv_color_t* Display::_buf2 = nullptr;
@@ -83,7 +128,9 @@ Display display;
 Display::Display()
     : _backlightLevel(255)
     , _lastActivityTime(0)
-    , _isDimmed(false) {
+    , _powerState(DISPLAY_POWER_ACTIVE)
+    , _nextRefresh(0)
+    , _bufferMode(DISPLAY_BUFFER_PARTIAL) {
 }
 
 bool Display::begin() {
@@ -111,27 +158,8 @@ bool Display::begin() {
     lv_init();
 
     // Allocate display buffers (double buffering)
-    size_t bufSize = LCD_WIDTH * 40;  // 40 lines at a time
-    _buf1 = (lv_color_t*)heap_caps_malloc(bufSize * sizeof(lv_color_t), MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
-    _buf2 = (lv_color_t*)heap_caps_malloc(bufSize * sizeof(lv_color_t), MALLOC_CAP_DMA | MALLOC_CAP_8BIT);
-
-    if (!_buf1 || !_buf2) {
-        Serial.println("Failed to allocate LVGL buffers!");
-        // Try single buffer
-        if (_buf2) {
-            free(_buf2);
-            _buf2 = nullptr;
-        }
-        if (!_buf1) {
-            _buf1 = (lv_color_t*)heap_caps_malloc(bufSize * sizeof(lv_color_t), MALLOC_CAP_8BIT);
-            if (!_buf1) {
-                Serial.println("Critical: Cannot allocate display buffer!");
-                return false;
-            }
-        }
-        lv_disp_draw_buf_init(&_drawBuf, _buf1, nullptr, bufSize);
-    } else {
-        lv_disp_draw_buf_init(&_drawBuf, _buf1, _buf2, bufSize);
+    if (!allocateBuffers(DISPLAY_BUFFER_MODE)) {
+        return false;
     }
 
     // Initialize display driver
@@ -140,7 +168,8 @@ bool Display::begin() {
     _dispDrv.ver_res = LCD_HEIGHT;
     _dispDrv.flush_cb = displayFlush;
     _dispDrv.draw_buf = &_drawBuf;
-    lv_disp_drv_register(&_dispDrv);
+    _dispDrv.direct_mode = (_bufferMode == DISPLAY_BUFFER_FULL);
+    _disp = lv_disp_drv_register(&_dispDrv);
 
     // Initialize touch controller
     touchAvailable = initTouch();
@@ -149,7 +178,12 @@ bool Display::begin() {
         _indevDrv.type = LV_INDEV_TYPE_POINTER;
         _indevDrv.read_cb = touchpadRead;
         lv_indev_drv_register(&_indevDrv);
+#if TOUCH_INT >= 0
+        startTouchTask();
+        Serial.println("Touch input registered with LVGL (interrupt driven)");
+#else
         Serial.println("Touch input registered with LVGL");
+#endif
     }
 
     _lastActivityTime = millis();
@@ -159,8 +193,168 @@ bool Display::begin() {
     return true;
 }
 
+bool Display::allocateBuffers(uint8_t mode) {
+    freeBuffers();
+
+    size_t bufSize;
+    uint32_t caps;
+    if (mode == DISPLAY_BUFFER_FULL) {
+        // Full frame in PSRAM - frees internal RAM, LVGL renders in place (direct mode)
+        bufSize = LCD_WIDTH * LCD_HEIGHT;
+        caps = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+    } else {
+        bufSize = LCD_WIDTH * DISPLAY_BUFFER_LINES;  // Partial bands
+        caps = MALLOC_CAP_DMA | MALLOC_CAP_8BIT;
+    }
+
+    _buf1 = (lv_color_t*)heap_caps_malloc(bufSize * sizeof(lv_color_t), caps);
+    _buf2 = (lv_color_t*)heap_caps_malloc(bufSize * sizeof(lv_color_t), caps);
+
+    if (!_buf1 || !_buf2) {
+        Serial.println("Failed to allocate LVGL buffers!");
+        // Try single buffer
+        if (_buf2) {
+            heap_caps_free(_buf2);
+            _buf2 = nullptr;
+        }
+        if (!_buf1 && mode == DISPLAY_BUFFER_FULL) {
+            Serial.println("No PSRAM for full-frame buffer, using partial bands");
+            return allocateBuffers(DISPLAY_BUFFER_PARTIAL);
+        }
+        if (!_buf1) {
+            _buf1 = (lv_color_t*)heap_caps_malloc(bufSize * sizeof(lv_color_t), MALLOC_CAP_8BIT);
+            if (!_buf1) {
+                Serial.println("Critical: Cannot allocate display buffer!");
+                return false;
+            }
+        }
+    }
+
+    lv_disp_draw_buf_init(&_drawBuf, _buf1, _buf2, bufSize);
+    _bufferMode = mode;
+    return true;
+}
+
+void Display::freeBuffers() {
+    if (_buf1) {
+        heap_caps_free(_buf1);
+        _buf1 = nullptr;
+    }
+    if (_buf2) {
+        heap_caps_free(_buf2);
+        _buf2 = nullptr;
+    }
+}
+
+bool Display::setBufferMode(uint8_t mode) {
+    if (!_disp) {
+        return false;
+    }
+
+    // Make sure nothing is mid-flush before the buffers go away
+    lv_refr_now(_disp);
+
+    bool ok = allocateBuffers(mode);
+    _dispDrv.direct_mode = (_bufferMode == DISPLAY_BUFFER_FULL);
+    lv_disp_drv_update(_disp, &_dispDrv);
+    lv_obj_invalidate(lv_scr_act());
+    return ok && _bufferMode == mode;
+}
+
+void Display::runBenchmark() {
+    if (!_disp) {
+        return;
+    }
+
+    Serial.println("Display benchmark (full-screen redraw):");
+    Serial.printf("  LVGL heap: %u bytes PSRAM, %u bytes internal\n",
+                  (unsigned)lv_mem_psram_used_external(), (unsigned)lv_mem_psram_used_internal());
+
+    uint8_t originalMode = _bufferMode;
+
+    // Baseline: internal RAM with no draw buffers at all
+    lv_refr_now(_disp);
+    freeBuffers();
+    size_t baselineFree = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+
+    const uint8_t modes[] = { DISPLAY_BUFFER_PARTIAL, DISPLAY_BUFFER_FULL };
+    const char* names[] = { "partial", "full" };
+
+    for (int m = 0; m < 2; m++) {
+        // Buffers were freed above or by the previous iteration's switch
+        if (!allocateBuffers(modes[m]) || _bufferMode != modes[m]) {
+            Serial.printf("  %-8s unavailable\n", names[m]);
+            continue;
+        }
+        _dispDrv.direct_mode = (_bufferMode == DISPLAY_BUFFER_FULL);
+        lv_disp_drv_update(_disp, &_dispDrv);
+
+        size_t internalUsed = baselineFree - heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+
+        uint32_t total = 0;
+        uint32_t worst = 0;
+        for (int i = 0; i < DISPLAY_BENCHMARK_FRAMES; i++) {
+            lv_obj_invalidate(lv_scr_act());
+            uint32_t start = micros();
+            lv_refr_now(_disp);
+            uint32_t elapsed = micros() - start;
+            total += elapsed;
+            if (elapsed > worst) worst = elapsed;
+        }
+
+        Serial.printf("  %-8s avg %6lu us  max %6lu us  internal RAM for buffers %6u bytes\n",
+                      names[m], (unsigned long)(total / DISPLAY_BENCHMARK_FRAMES),
+                      (unsigned long)worst, (unsigned)internalUsed);
+        lv_refr_now(_disp);
+        freeBuffers();
+    }
+
+    allocateBuffers(originalMode);
+    _dispDrv.direct_mode = (_bufferMode == DISPLAY_BUFFER_FULL);
+    lv_disp_drv_update(_disp, &_dispDrv);
+    lv_obj_invalidate(lv_scr_act());
+}
+
 void Display::update() {
-    lv_timer_handler();
+    unsigned long now = millis();
+
+    switch (_powerState) {
+        case DISPLAY_POWER_ACTIVE:
+            if ((long)(now - _nextRefresh) >= 0) {
+                lv_timer_handler();
+            }
+            break;
+
+        case DISPLAY_POWER_DIMMED:
+        case DISPLAY_POWER_OFF: {
+#if TOUCH_INT < 0
+            // No interrupt line - poll the controller at the slow rate
+            if (touchAvailable && (long)(now - _nextRefresh) >= 0) {
+                readTouch();
+            }
+#endif
+            portENTER_CRITICAL(&touchMux);
+            bool pressed = touchPressed;
+            portEXIT_CRITICAL(&touchMux);
+
+            if (pressed) {
+                // Wake on touch; the waking touch itself doesn't reach the UI
+                swallowTouch = true;
+                resetActivityTimer();
+            } else if (_powerState == DISPLAY_POWER_DIMMED && (long)(now - _nextRefresh) >= 0) {
+                // Run LVGL only as often as its own timers need, but no faster than the dimmed rate
+                uint32_t idle = lv_timer_handler();
+                _nextRefresh = now + constrain(idle, (uint32_t)DISPLAY_DIMMED_REFRESH, (uint32_t)1000);
+            }
+#if TOUCH_INT < 0
+            else if (_powerState == DISPLAY_POWER_OFF && (long)(now - _nextRefresh) >= 0) {
+                _nextRefresh = now + DISPLAY_DIMMED_REFRESH;
+            }
+#endif
+            break;
+        }
+    }
+
     checkScreenTimeout();
 }
 
@@ -168,26 +362,65 @@ void Display::setBacklight(uint8_t brightness) {
     _backlightLevel = brightness;
     // Use analogWrite for PWM brightness control
     analogWrite(LCD_BL, brightness);
-    if (brightness > 0) {
-        _isDimmed = false;
+    if (brightness > 0 && _powerState != DISPLAY_POWER_ACTIVE) {
+        setPowerState(DISPLAY_POWER_ACTIVE);
     }
 }
 
 void Display::resetActivityTimer() {
     _lastActivityTime = millis();
-    if (_isDimmed) {
-        setBacklight(_backlightLevel > 0 ? _backlightLevel : 255);
-        _isDimmed = false;
+    if (_powerState != DISPLAY_POWER_ACTIVE) {
+        setPowerState(DISPLAY_POWER_ACTIVE);
+    }
+}
+
+void Display::setPowerState(DisplayPowerState state) {
+    if (state == _powerState) {
+        return;
+    }
+
+    if (_powerState == DISPLAY_POWER_OFF) {
+        // Leave sleep; the panel needs a few ms before it accepts pixel data
+        bus->sendCommand(ST7789_CMD_SLPOUT);
+        _nextRefresh = millis() + ST7789_SLPOUT_SETTLE_MS;
+        if (_disp) {
+            lv_timer_resume(_disp->refr_timer);
+        }
+    }
+
+    switch (state) {
+        case DISPLAY_POWER_ACTIVE:
+            analogWrite(LCD_BL, _backlightLevel > 0 ? _backlightLevel : 255);
+            break;
+        case DISPLAY_POWER_DIMMED:
+            analogWrite(LCD_BL, DISPLAY_DIM_LEVEL);
+            break;
+        case DISPLAY_POWER_OFF:
+            analogWrite(LCD_BL, 0);
+            if (_disp) {
+                // Flush anything pending, then stop refreshing entirely
+                lv_refr_now(_disp);
+                lv_timer_pause(_disp->refr_timer);
+            }
+            bus->sendCommand(ST7789_CMD_SLPIN);
+            break;
     }
+
+    _powerState = state;
 }
 
 void Display::checkScreenTimeout() {
 #if DISPLAY_TIMEOUT > 0
-    if (!_isDimmed && (millis() - _lastActivityTime > DISPLAY_TIMEOUT)) {
-        analogWrite(LCD_BL, 30);  // Dim to 30
-        _isDimmed = true;
+    unsigned long idle = millis() - _lastActivityTime;
+    if (_powerState == DISPLAY_POWER_ACTIVE && idle > DISPLAY_TIMEOUT) {
+        setPowerState(DISPLAY_POWER_DIMMED);
+    }
+#if DISPLAY_OFF_TIMEOUT > 0
+    else if (_powerState == DISPLAY_POWER_DIMMED && idle > (unsigned long)DISPLAY_TIMEOUT + DISPLAY_OFF_TIMEOUT) {
+        setPowerState(DISPLAY_POWER_OFF);
     }
 #endif
+#endif
 }
 
 uint16_t Display::getWidth() const {
@@ -211,7 +444,20 @@ void Display::displayFlush(lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t
     uint32_t w = (area->x2 - area->x1 + 1);
     uint32_t h = (area->y2 - area->y1 + 1);
 
-    gfx->draw16bitBeRGBBitmap(area->x1, area->y1, (uint16_t*)color_p, w, h);
+    if (drv->direct_mode) {
+        // color_p is the whole frame - push only the dirty area
+        lv_color_t* src = color_p + area->y1 * LCD_WIDTH + area->x1;
+        if (w == LCD_WIDTH) {
+            gfx->draw16bitBeRGBBitmap(area->x1, area->y1, (uint16_t*)src, w, h);
+        } else {
+            for (uint32_t row = 0; row < h; row++) {
+                gfx->draw16bitBeRGBBitmap(area->x1, area->y1 + row, (uint16_t*)src, w, 1);
+                src += LCD_WIDTH;
+            }
+        }
+    } else {
+        gfx->draw16bitBeRGBBitmap(area->x1, area->y1, (uint16_t*)color_p, w, h);
+    }
 
     lv_disp_flush_ready(drv);
 }
@@ -219,13 +465,26 @@ void Display::displayFlush(lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t
 // LVGL touch read callback
 void Display::touchpadRead(lv_indev_drv_t* drv, lv_indev_data_t* data) {
     if (touchAvailable) {
+#if TOUCH_INT < 0
         readTouch();
+#endif
+        portENTER_CRITICAL(&touchMux);
         data->point.x = touchX;
         data->point.y = touchY;
-        data->state = touchPressed ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
+        bool pressed = touchPressed;
+        portEXIT_CRITICAL(&touchMux);
+
+        // Hold back the touch that woke the screen until the finger lifts
+        if (swallowTouch) {
+            if (!pressed) {
+                swallowTouch = false;
+            }
+            pressed = false;
+        }
+        data->state = pressed ? LV_INDEV_STATE_PR : LV_INDEV_STATE_REL;
 
         // Reset activity timer on touch
-        if (touchPressed) {
+        if (pressed) {
             display.resetActivityTimer();
         }
     } else {
@@ -36,13 +36,22 @@ static const int TAB_BAR_HEIGHT = 50;
 static const int CONTENT_HEIGHT = LCD_HEIGHT - TAB_BAR_HEIGHT;
 static const int TILE_GAP = 3;
 static const int TILE_BORDER = 2;
+static const int PREVIEW_TILE_HEIGHT = PREVIEW_HEIGHT + TILE_BORDER * 2;
 
-DisplayUI::DisplayUI(LEDController& ledController, Calibration& calibration, WiFiManager& wifiManager)
+DisplayUI::DisplayUI(LEDController& ledController, Calibration& calibration, WiFiManager& wifiManager,
+                     PresetStore& presets)
     : _ledController(ledController)
     , _calibration(calibration)
     , _wifiManager(wifiManager)
+    , _presets(presets)
+    , _preview(ledController, calibration)
     , _activeTab(TAB_CONTROL)
-    , _currentCalibLed(0) {
+    , _currentCalibLed(0)
+    , _pendingEvents(0)
+    , _shownPower(-1)
+    , _shownAnimation(-1)
+    , _shownBrightness(-1)
+    , _shownColor(-1) {
 }
 
 void DisplayUI::begin() {
@@ -71,6 +80,10 @@ void DisplayUI::begin() {
 
     switchTab(TAB_CONTROL);
     syncState();
+
+    // Follow changes made from anywhere (LCD, web, scheduler)
+    _ledController.addListener(onStateEvent, this);
+    _calibration.addListener(onStateEvent, this);
     Serial.println("UI created");
 }
 
@@ -122,12 +135,31 @@ void DisplayUI::createControlTab() {
     lv_obj_clear_flag(_controlContainer, LV_OBJ_FLAG_SCROLLABLE);
 
     int tileW = (LCD_WIDTH - TILE_GAP * 3) / 2;
-    int tileH = (CONTENT_HEIGHT - TILE_GAP * 3) / 2;
+    int tileH = (CONTENT_HEIGHT - PREVIEW_TILE_HEIGHT - TILE_GAP * 4) / 2;
+    int tileY = PREVIEW_TILE_HEIGHT + TILE_GAP;
+
+    // Preview tile - full width strip across the top, tap to switch strip/spatial view
+    _previewTile = lv_obj_create(_controlContainer);
+    lv_obj_set_size(_previewTile, LCD_WIDTH - TILE_GAP * 2, PREVIEW_TILE_HEIGHT);
+    lv_obj_set_pos(_previewTile, 0, 0);
+    lv_obj_set_style_bg_color(_previewTile, lv_color_black(), 0);
+    lv_obj_set_style_border_color(_previewTile, lv_color_white(), 0);
+    lv_obj_set_style_border_width(_previewTile, TILE_BORDER, 0);
+    lv_obj_set_style_pad_all(_previewTile, 0, 0);
+    lv_obj_set_style_radius(_previewTile, 0, 0);
+    lv_obj_add_flag(_previewTile, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(_previewTile, onPreviewTap, LV_EVENT_CLICKED, this);
+    lv_obj_clear_flag(_previewTile, LV_OBJ_FLAG_SCROLLABLE);
+
+    lv_obj_t* canvas = _preview.create(_previewTile);
+    if (canvas) {
+        lv_obj_center(canvas);
+    }
 
     // Power tile - top left
     _powerTile = lv_obj_create(_controlContainer);
     lv_obj_set_size(_powerTile, tileW, tileH);
-    lv_obj_set_pos(_powerTile, 0, 0);
+    lv_obj_set_pos(_powerTile, 0, tileY);
     lv_obj_set_style_bg_color(_powerTile, lv_color_black(), 0);
     lv_obj_set_style_border_color(_powerTile, lv_color_white(), 0);
     lv_obj_set_style_border_width(_powerTile, TILE_BORDER, 0);
@@ -145,7 +177,7 @@ void DisplayUI::createControlTab() {
     // Pattern tile - top right
     _patternTile = lv_obj_create(_controlContainer);
     lv_obj_set_size(_patternTile, tileW, tileH);
-    lv_obj_set_pos(_patternTile, tileW + TILE_GAP, 0);
+    lv_obj_set_pos(_patternTile, tileW + TILE_GAP, tileY);
     lv_obj_set_style_bg_color(_patternTile, lv_color_black(), 0);
     lv_obj_set_style_border_color(_patternTile, lv_color_white(), 0);
     lv_obj_set_style_border_width(_patternTile, TILE_BORDER, 0);
@@ -163,7 +195,7 @@ void DisplayUI::createControlTab() {
     // Brightness tile - bottom left
     _brightnessTile = lv_obj_create(_controlContainer);
     lv_obj_set_size(_brightnessTile, tileW, tileH);
-    lv_obj_set_pos(_brightnessTile, 0, tileH + TILE_GAP);
+    lv_obj_set_pos(_brightnessTile, 0, tileY + tileH + TILE_GAP);
     lv_obj_set_style_bg_color(_brightnessTile, lv_color_black(), 0);
     lv_obj_set_style_border_color(_brightnessTile, lv_color_white(), 0);
     lv_obj_set_style_border_width(_brightnessTile, TILE_BORDER, 0);
@@ -181,7 +213,7 @@ void DisplayUI::createControlTab() {
     // Color tile - bottom right
     _colorTile = lv_obj_create(_controlContainer);
     lv_obj_set_size(_colorTile, tileW, tileH);
-    lv_obj_set_pos(_colorTile, tileW + TILE_GAP, tileH + TILE_GAP);
+    lv_obj_set_pos(_colorTile, tileW + TILE_GAP, tileY + tileH + TILE_GAP);
     lv_obj_set_style_bg_color(_colorTile, lv_color_black(), 0);
     lv_obj_set_style_border_color(_colorTile, lv_color_white(), 0);
     lv_obj_set_style_border_width(_colorTile, TILE_BORDER, 0);
@@ -357,7 +389,7 @@ void DisplayUI::createSettingsTab() {
 
     // Device info tile
     lv_obj_t* deviceTile = lv_obj_create(_settingsContainer);
-    lv_obj_set_size(deviceTile, LCD_WIDTH - TILE_GAP * 2, 80);
+    lv_obj_set_size(deviceTile, LCD_WIDTH - TILE_GAP * 2, 40);
     lv_obj_set_pos(deviceTile, 0, 100 + TILE_GAP);
     lv_obj_set_style_bg_color(deviceTile, lv_color_black(), 0);
     lv_obj_set_style_border_color(deviceTile, lv_color_white(), 0);
@@ -366,13 +398,53 @@ void DisplayUI::createSettingsTab() {
     lv_obj_clear_flag(deviceTile, LV_OBJ_FLAG_SCROLLABLE);
 
     lv_obj_t* deviceInfo = lv_label_create(deviceTile);
-    lv_label_set_text(deviceInfo, "50 LEDs\nESP32-S3");
+    lv_label_set_text(deviceInfo, "50 LEDs - ESP32-S3");
     lv_obj_set_style_text_color(deviceInfo, lv_color_white(), 0);
     lv_obj_set_style_text_font(deviceInfo, &lv_font_montserrat_16, 0);
     lv_obj_set_style_text_align(deviceInfo, LV_TEXT_ALIGN_CENTER, 0);
     lv_obj_center(deviceInfo);
 
+    // Segments tile - tap a segment to step through its animations
+    int segmentsY = 100 + TILE_GAP + 40 + TILE_GAP;
+    lv_obj_t* segmentTile = lv_obj_create(_settingsContainer);
+    lv_obj_set_size(segmentTile, LCD_WIDTH - TILE_GAP * 2, CONTENT_HEIGHT - TILE_GAP * 2 - segmentsY);
+    lv_obj_set_pos(segmentTile, 0, segmentsY);
+    lv_obj_set_style_bg_color(segmentTile, lv_color_black(), 0);
+    lv_obj_set_style_border_color(segmentTile, lv_color_white(), 0);
+    lv_obj_set_style_border_width(segmentTile, TILE_BORDER, 0);
+    lv_obj_set_style_radius(segmentTile, 0, 0);
+    lv_obj_set_style_pad_all(segmentTile, 0, 0);
+    lv_obj_set_flex_flow(segmentTile, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_scroll_dir(segmentTile, LV_DIR_VER);
+
+    _segmentEmpty = lv_label_create(segmentTile);
+    lv_label_set_text(_segmentEmpty, "No segments");
+    lv_obj_set_style_text_color(_segmentEmpty, lv_color_hex(0x888888), 0);
+    lv_obj_set_style_text_font(_segmentEmpty, &lv_font_montserrat_14, 0);
+
+    for (int i = 0; i < MAX_SEGMENTS; i++) {
+        lv_obj_t* row = lv_obj_create(segmentTile);
+        lv_obj_set_size(row, LCD_WIDTH - TILE_GAP * 2 - TILE_BORDER * 2, 28);
+        lv_obj_set_style_bg_color(row, lv_color_black(), 0);
+        lv_obj_set_style_border_color(row, lv_color_hex(0x333333), 0);
+        lv_obj_set_style_border_width(row, 1, 0);
+        lv_obj_set_style_border_side(row, LV_BORDER_SIDE_BOTTOM, 0);
+        lv_obj_set_style_radius(row, 0, 0);
+        lv_obj_set_style_pad_all(row, 0, 0);
+        lv_obj_add_flag(row, LV_OBJ_FLAG_CLICKABLE);
+        lv_obj_set_user_data(row, (void*)(intptr_t)i);
+        lv_obj_add_event_cb(row, onSegmentTap, LV_EVENT_CLICKED, this);
+        lv_obj_clear_flag(row, LV_OBJ_FLAG_SCROLLABLE);
+        _segmentRows[i] = row;
+
+        _segmentLabels[i] = lv_label_create(row);
+        lv_obj_set_style_text_color(_segmentLabels[i], lv_color_white(), 0);
+        lv_obj_set_style_text_font(_segmentLabels[i], &lv_font_montserrat_14, 0);
+        lv_obj_center(_segmentLabels[i]);
+    }
+
     updateWifiStatus();
+    updateSegmentList();
 }
 
 void DisplayUI::createPatternOverlay() {
@@ -420,6 +492,28 @@ void DisplayUI::createPatternOverlay() {
         lv_obj_set_style_text_font(label, &lv_font_montserrat_16, 0);
         lv_obj_center(label);
     }
+
+    // Preset buttons below the patterns (scroll down); filled in when the overlay opens
+    for (int i = 0; i < MAX_PRESETS; i++) {
+        lv_obj_t* item = lv_obj_create(_patternList);
+        lv_obj_set_size(item, LCD_WIDTH - TILE_GAP * 2 - TILE_BORDER * 2, itemH);
+        lv_obj_set_style_bg_color(item, lv_color_hex(0x111111), 0);
+        lv_obj_set_style_border_color(item, lv_color_hex(0x333333), 0);
+        lv_obj_set_style_border_width(item, 1, 0);
+        lv_obj_set_style_border_side(item, LV_BORDER_SIDE_BOTTOM, 0);
+        lv_obj_set_style_radius(item, 0, 0);
+        lv_obj_add_flag(item, LV_OBJ_FLAG_CLICKABLE);
+        lv_obj_add_flag(item, LV_OBJ_FLAG_HIDDEN);
+        lv_obj_set_user_data(item, (void*)(intptr_t)i);
+        lv_obj_add_event_cb(item, onPresetSelect, LV_EVENT_CLICKED, this);
+        lv_obj_clear_flag(item, LV_OBJ_FLAG_SCROLLABLE);
+        _presetItems[i] = item;
+
+        _presetLabels[i] = lv_label_create(item);
+        lv_obj_set_style_text_color(_presetLabels[i], lv_color_white(), 0);
+        lv_obj_set_style_text_font(_presetLabels[i], &lv_font_montserrat_16, 0);
+        lv_obj_center(_presetLabels[i]);
+    }
 }
 
 void DisplayUI::createBrightnessOverlay() {
@@ -541,7 +635,23 @@ void DisplayUI::hideOverlay(lv_obj_t* overlay) {
     lv_obj_add_flag(overlay, LV_OBJ_FLAG_HIDDEN);
 }
 
+bool DisplayUI::isOverlayVisible() const {
+    return !lv_obj_has_flag(_patternOverlay, LV_OBJ_FLAG_HIDDEN) ||
+           !lv_obj_has_flag(_brightnessOverlay, LV_OBJ_FLAG_HIDDEN) ||
+           !lv_obj_has_flag(_colorOverlay, LV_OBJ_FLAG_HIDDEN);
+}
+
 void DisplayUI::update() {
+    uint32_t events = _pendingEvents.exchange(0);
+    if (events) {
+        applyStateEvents(events);
+    }
+
+    // Preview is throttled internally and skipped while it can't be seen
+    if (_activeTab == TAB_CONTROL && !isOverlayVisible()) {
+        _preview.update();
+    }
+
     static unsigned long lastUpdate = 0;
     if (millis() - lastUpdate > 2000) {
         if (_activeTab == TAB_SETTINGS) {
@@ -555,29 +665,101 @@ void DisplayUI::syncState() {
     updateControlTiles();
 }
 
+void DisplayUI::onStateEvent(StateEvent event, void* context) {
+    // May run outside the LVGL context - just record it for update()
+    DisplayUI* ui = (DisplayUI*)context;
+    ui->_pendingEvents.fetch_or(STATE_EVENT_BIT(event));
+}
+
+void DisplayUI::applyStateEvents(uint32_t events) {
+    if (events & STATE_EVENT_BIT(STATE_EVENT_POWER)) {
+        updatePowerTile();
+    }
+    if (events & STATE_EVENT_BIT(STATE_EVENT_ANIMATION)) {
+        updatePatternTile();
+    }
+    if (events & STATE_EVENT_BIT(STATE_EVENT_BRIGHTNESS)) {
+        updateBrightnessTile();
+    }
+    if (events & STATE_EVENT_BIT(STATE_EVENT_COLOR)) {
+        updateColorTile();
+    }
+    if (events & STATE_EVENT_BIT(STATE_EVENT_CALIBRATION_LED)) {
+        int16_t led = _calibration.getCalibrationLED();
+        if (led >= 0 && led != _currentCalibLed) {
+            _currentCalibLed = led;
+            if (_activeTab == TAB_CALIBRATE) {
+                updateCalibrationUI();
+            }
+        }
+    }
+    if ((events & STATE_EVENT_BIT(STATE_EVENT_CALIBRATION_POSITIONS)) && _activeTab == TAB_CALIBRATE) {
+        updateCalibrationUI();
+    }
+    if (events & STATE_EVENT_BIT(STATE_EVENT_SEGMENTS)) {
+        updateSegmentList();
+    }
+}
+
 void DisplayUI::updateControlTiles() {
-    // Power
-    if (_ledController.isOn()) {
+    updatePowerTile();
+    updatePatternTile();
+    updateBrightnessTile();
+    updateColorTile();
+}
+
+void DisplayUI::updatePowerTile() {
+    int8_t on = _ledController.isOn() ? 1 : 0;
+    if (on == _shownPower) {
+        return;
+    }
+    _shownPower = on;
+
+    if (on) {
         lv_obj_set_style_text_color(_powerIcon, lv_color_white(), 0);
-        lv_obj_set_style_bg_color(_powerTile, lv_color_black(), 0);
     } else {
         lv_obj_set_style_text_color(_powerIcon, lv_color_hex(0x444444), 0);
-        lv_obj_set_style_bg_color(_powerTile, lv_color_black(), 0);
     }
+}
 
-    // Pattern
+void DisplayUI::updatePatternTile() {
     int anim = (int)_ledController.getAnimation();
+    if (anim == _shownAnimation) {
+        return;
+    }
+    _shownAnimation = anim;
+
     if (anim >= 0 && anim < NUM_PATTERNS) {
         lv_label_set_text(_patternValue, PATTERN_NAMES[anim]);
     }
+}
+
+void DisplayUI::updateBrightnessTile() {
+    int percent = _ledController.getBrightness() * 100 / 255;
+    if (percent == _shownBrightness) {
+        return;
+    }
+    _shownBrightness = percent;
 
-    // Brightness
     char buf[8];
-    snprintf(buf, sizeof(buf), "%d%%", _ledController.getBrightness() * 100 / 255);
+    snprintf(buf, sizeof(buf), "%d%%", percent);
     lv_label_set_text(_brightnessValue, buf);
 
-    // Color
+    // Keep the overlay in step when the change came from elsewhere
+    if (!lv_obj_has_flag(_brightnessOverlay, LV_OBJ_FLAG_HIDDEN)) {
+        lv_slider_set_value(_brightnessSlider, _ledController.getBrightness(), LV_ANIM_OFF);
+        lv_label_set_text(_brightnessDisplay, buf);
+    }
+}
+
+void DisplayUI::updateColorTile() {
     CRGB color = _ledController.getSolidColor();
+    int32_t packed = ((int32_t)color.r << 16) | ((int32_t)color.g << 8) | color.b;
+    if (packed == _shownColor) {
+        return;
+    }
+    _shownColor = packed;
+
     lv_obj_set_style_bg_color(_colorSwatch, lv_color_make(color.r, color.g, color.b), 0);
 }
 
@@ -608,6 +790,41 @@ void DisplayUI::updateWifiStatus() {
 // Event Handlers
 // ============================================
 
+void DisplayUI::updateSegmentList() {
+    bool any = false;
+    for (int i = 0; i < MAX_SEGMENTS; i++) {
+        const Segment& segment = _ledController.getSegment(i);
+        if (!segment.enabled) {
+            lv_obj_add_flag(_segmentRows[i], LV_OBJ_FLAG_HIDDEN);
+            continue;
+        }
+        any = true;
+        lv_obj_clear_flag(_segmentRows[i], LV_OBJ_FLAG_HIDDEN);
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%s  %d-%d  %s", segment.name, segment.anim.start,
+                 segment.anim.start + segment.anim.count - 1, ANIMATION_NAMES[segment.anim.mode]);
+        lv_label_set_text(_segmentLabels[i], buf);
+    }
+    if (any) {
+        lv_obj_add_flag(_segmentEmpty, LV_OBJ_FLAG_HIDDEN);
+    } else {
+        lv_obj_clear_flag(_segmentEmpty, LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
+void DisplayUI::updatePresetList() {
+    for (int i = 0; i < MAX_PRESETS; i++) {
+        if (!_presets.isUsed(i)) {
+            lv_obj_add_flag(_presetItems[i], LV_OBJ_FLAG_HIDDEN);
+            continue;
+        }
+        char buf[PRESET_NAME_LENGTH + 8];
+        snprintf(buf, sizeof(buf), LV_SYMBOL_SAVE " %s", _presets.getName(i));
+        lv_label_set_text(_presetLabels[i], buf);
+        lv_obj_clear_flag(_presetItems[i], LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
 void DisplayUI::onTabSelect(lv_event_t* e) {
     DisplayUI* ui = (DisplayUI*)lv_event_get_user_data(e);
     lv_obj_t* btn = lv_event_get_target(e);
@@ -615,14 +832,19 @@ void DisplayUI::onTabSelect(lv_event_t* e) {
     ui->switchTab(tab);
 }
 
+void DisplayUI::onPreviewTap(lv_event_t* e) {
+    DisplayUI* ui = (DisplayUI*)lv_event_get_user_data(e);
+    ui->_preview.setMode(ui->_preview.getMode() == PREVIEW_STRIP ? PREVIEW_SPATIAL : PREVIEW_STRIP);
+}
+
 void DisplayUI::onPowerTap(lv_event_t* e) {
     DisplayUI* ui = (DisplayUI*)lv_event_get_user_data(e);
     ui->_ledController.setOn(!ui->_ledController.isOn());
-    ui->updateControlTiles();
 }
 
 void DisplayUI::onPatternTap(lv_event_t* e) {
     DisplayUI* ui = (DisplayUI*)lv_event_get_user_data(e);
+    ui->updatePresetList();
     ui->showOverlay(ui->_patternOverlay);
 }
 
@@ -647,7 +869,6 @@ void DisplayUI::onOverlayClose(lv_event_t* e) {
     // Only close if clicking the overlay background, not children
     if (overlay == ui->_patternOverlay || overlay == ui->_brightnessOverlay || overlay == ui->_colorOverlay) {
         ui->hideOverlay(overlay);
-        ui->updateControlTiles();
     }
 }
 
@@ -658,7 +879,15 @@ void DisplayUI::onPatternSelect(lv_event_t* e) {
 
     ui->_ledController.setAnimation(static_cast<AnimationMode>(index));
     ui->hideOverlay(ui->_patternOverlay);
-    ui->updateControlTiles();
+}
+
+void DisplayUI::onPresetSelect(lv_event_t* e) {
+    DisplayUI* ui = (DisplayUI*)lv_event_get_user_data(e);
+    lv_obj_t* item = lv_event_get_target(e);
+    int index = (int)(intptr_t)lv_obj_get_user_data(item);
+
+    ui->_presets.recall(index);
+    ui->hideOverlay(ui->_patternOverlay);
 }
 
 void DisplayUI::onBrightnessChange(lv_event_t* e) {
@@ -685,7 +914,6 @@ void DisplayUI::onColorSelect(lv_event_t* e) {
     }
 
     ui->hideOverlay(ui->_colorOverlay);
-    ui->updateControlTiles();
 }
 
 void DisplayUI::onCalibPrev(lv_event_t* e) {
@@ -728,3 +956,21 @@ void DisplayUI::onCalibSave(lv_event_t* e) {
         lv_obj_center(msgbox);
     }
 }
+
+void DisplayUI::onSegmentTap(lv_event_t* e) {
+    DisplayUI* ui = (DisplayUI*)lv_event_get_user_data(e);
+    lv_obj_t* row = lv_event_get_target(e);
+    int index = (int)(intptr_t)lv_obj_get_user_data(row);
+
+    // Step to the next animation; custom patterns only run on the whole strip
+    const Segment& segment = ui->_ledController.getSegment(index);
+    const AnimationInstance& anim = segment.anim;
+    uint8_t next = anim.mode;
+    do {
+        next = (next + 1) % MAX_ANIMATIONS;
+    } while (!animationHasContent(next));
+    char name[SEGMENT_NAME_LENGTH];
+    strlcpy(name, segment.name, sizeof(name));
+    ui->_ledController.setSegment(index, name, anim.start, anim.count, anim.reverse,
+                                  static_cast<AnimationMode>(next), anim.color, anim.speed);
+}
@@ -0,0 +1,73 @@
+#include "fire_grid.h"
+
+static_assert(FIRE_GRIDS <= 16, "FireGridPool tracks grids in a 16-bit mask");
+
+void FireGrid::step(uint8_t cooling, uint8_t sparking) {
+    // Cool every cell a little
+    const uint8_t maxCooling = (uint8_t)(((uint16_t)cooling * 10) / FIRE_GRID_ROWS + 2);
+    for (uint8_t r = 0; r < FIRE_GRID_ROWS; r++) {
+        for (uint8_t c = 0; c < FIRE_GRID_COLUMNS; c++) {
+            heat[r][c] = qsub8(heat[r][c], random8(0, maxCooling));
+        }
+    }
+
+    // Heat rises: each cell takes from the two rows below, mostly straight
+    // down with some from the neighbouring columns (which wrap round)
+    for (uint8_t r = FIRE_GRID_ROWS - 1; r >= 2; r--) {
+        const uint8_t* below = heat[r - 1];
+        const uint8_t* twoBelow = heat[r - 2];
+        for (uint8_t c = 0; c < FIRE_GRID_COLUMNS; c++) {
+            uint8_t left = c > 0 ? c - 1 : FIRE_GRID_COLUMNS - 1;
+            uint8_t right = c + 1 < FIRE_GRID_COLUMNS ? c + 1 : 0;
+            heat[r][c] = (below[left] + 2 * below[c] + below[right] + 2 * twoBelow[c]) / 6;
+        }
+    }
+
+    // New sparks near the bottom
+    const uint8_t sparkRows = FIRE_GRID_ROWS < 3 ? FIRE_GRID_ROWS : 3;
+    for (uint8_t c = 0; c < FIRE_GRID_COLUMNS; c++) {
+        if (random8() < sparking) {
+            uint8_t r = random8(sparkRows);
+            heat[r][c] = qadd8(heat[r][c], random8(160, 255));
+        }
+    }
+}
+
+void FireLayout::prepare(const LEDPosition* positions) {
+    float minY = positions[0].y;
+    float maxY = positions[0].y;
+    for (uint16_t i = 1; i < NUM_LEDS; i++) {
+        minY = min(minY, positions[i].y);
+        maxY = max(maxY, positions[i].y);
+    }
+    _spatial = maxY - minY >= FIRE_MIN_HEIGHT;
+    if (!_spatial) {
+        return;
+    }
+
+    const float rowScale = (FIRE_GRID_ROWS - 1) / (maxY - minY);
+    const float columnScale = FIRE_GRID_COLUMNS / (2 * PI);
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        const LEDPosition& p = positions[i];
+        float row = (p.y - minY) * rowScale;
+        float column = (atan2f(p.z, p.x) + PI) * columnScale;
+        if (column >= FIRE_GRID_COLUMNS) column -= FIRE_GRID_COLUMNS;
+
+        FireSample& s = _samples[i];
+        s.row = min((uint8_t)row, (uint8_t)(FIRE_GRID_ROWS - 1));
+        s.rowWeight = (uint8_t)((row - s.row) * 255);
+        s.column = min((uint8_t)column, (uint8_t)(FIRE_GRID_COLUMNS - 1));
+        s.columnWeight = (uint8_t)((column - s.column) * 255);
+    }
+}
+
+FireSample FireLayout::alongStrip(uint16_t k, uint16_t count) {
+    uint32_t last = count > 1 ? count - 1 : 1;
+    uint32_t pos = (uint32_t)k * (FIRE_GRID_ROWS - 1) * 256 / last;  // Row in 8.8
+    FireSample s;
+    s.column = 0;
+    s.columnWeight = 0;
+    s.row = pos >> 8;
+    s.rowWeight = pos & 0xFF;
+    return s;
+}
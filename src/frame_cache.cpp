@@ -0,0 +1,110 @@
+#include "frame_cache.h"
+#include <esp_heap_caps.h>
+
+FrameCache::FrameCache()
+    : _frames(nullptr)
+    , _enabled(false)
+    , _keyValid(false)
+    , _mode(0)
+    , _revision(0)
+    , _filled(0)
+    , _hits(0)
+    , _misses(0) {
+    memset(_valid, 0, sizeof(_valid));
+}
+
+FrameCache::~FrameCache() {
+    release();
+}
+
+void FrameCache::setEnabled(bool enabled) {
+    _enabled = enabled;
+    _hits = 0;
+    _misses = 0;
+}
+
+bool FrameCache::allocate() {
+    if (_frames) {
+        return true;
+    }
+    if (heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM) < bytes() + FRAME_CACHE_PSRAM_RESERVE) {
+        return false;
+    }
+    _frames = (CRGB*)heap_caps_malloc(bytes(), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (_frames) {
+        Serial.printf("Frame cache: %u bytes PSRAM\n", (unsigned)bytes());
+    }
+    return _frames != nullptr;
+}
+
+void FrameCache::release() {
+    if (_frames) {
+        heap_caps_free(_frames);
+        _frames = nullptr;
+    }
+    clear();
+}
+
+void FrameCache::clear() {
+    _keyValid = false;
+    _filled = 0;
+    memset(_valid, 0, sizeof(_valid));
+}
+
+void FrameCache::checkMemory() {
+    if (!_frames) {
+        return;
+    }
+    if (!_enabled) {
+        release();
+    } else if (heap_caps_get_free_size(MALLOC_CAP_SPIRAM) < FRAME_CACHE_PSRAM_RESERVE) {
+        Serial.println("Frame cache: PSRAM low, releasing");
+        release();
+    }
+}
+
+bool FrameCache::prepare(uint8_t mode, CRGB color, uint32_t revision) {
+    if (!_enabled) {
+        return false;
+    }
+    if (_keyValid && _frames && mode == _mode && color == _color && revision == _revision) {
+        return true;
+    }
+    clear();
+    if (!allocate()) {
+        return false;
+    }
+    _mode = mode;
+    _color = color;
+    _revision = revision;
+    _keyValid = true;
+    return true;
+}
+
+const CRGB* FrameCache::get(uint8_t step) const {
+    if (!_keyValid || !(_valid[step >> 3] & (1 << (step & 7)))) {
+        return nullptr;
+    }
+    return _frames + (uint32_t)step * NUM_LEDS;
+}
+
+void FrameCache::markValid(uint8_t step) {
+    uint8_t bit = 1 << (step & 7);
+    if (!(_valid[step >> 3] & bit)) {
+        _valid[step >> 3] |= bit;
+        _filled++;
+    }
+}
+
+int16_t FrameCache::nextMissing(uint8_t from) const {
+    if (_filled >= ANIMATION_PHASE_STEPS) {
+        return -1;
+    }
+    for (uint8_t k = 0; k < ANIMATION_PHASE_STEPS; k++) {
+        uint8_t step = (from + k) % ANIMATION_PHASE_STEPS;
+        if (!(_valid[step >> 3] & (1 << (step & 7)))) {
+            return step;
+        }
+    }
+    return -1;
+}
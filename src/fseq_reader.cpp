@@ -0,0 +1,355 @@
+#include "fseq_reader.h"
+#include <string.h>
+#include <new>
+
+// FSEQ v2 fixed header (little endian)
+//   0  'PSEQ'
+//   4  uint16 offset of the channel data
+//   6  minor version, 7 major version (2)
+//   8  uint16 length of the fixed header + block index + sparse ranges
+//  10  uint32 channels per frame
+//  14  uint32 frame count
+//  18  step time in ms
+//  20  compression type (low nibble), block count bits 8..11 (high nibble)
+//  21  block count bits 0..7
+//  22  sparse range count
+//  32  block index: { uint32 first frame, uint32 compressed length } per block
+//      sparse ranges: { uint24 first channel, uint24 channel count } per range
+static const uint32_t FSEQ_FIXED_HEADER = 32;
+
+static uint32_t readLE(const uint8_t* p, uint8_t bytes) {
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < bytes; i++) {
+        value |= (uint32_t)p[i] << (8 * i);
+    }
+    return value;
+}
+
+FseqReader::FseqReader()
+    : _source(nullptr)
+    , _error("")
+    , _dataOffset(0)
+    , _channelCount(0)
+    , _frameCount(0)
+    , _stepMs(0)
+    , _compression(FSEQ_COMPRESSION_NONE)
+    , _windowChannels(0)
+    , _spanCount(0)
+    , _blocks(nullptr)
+    , _blockCount(0)
+    , _readAheadOffset(0)
+    , _readAheadLength(0)
+#if FSEQ_HAVE_ZLIB
+    , _inflater(nullptr)
+    , _window(nullptr)
+    , _windowPos(0)
+    , _pendingStart(0)
+    , _pendingLength(0)
+    , _block(0)
+    , _nextFrame(0)
+    , _inOffset(0)
+    , _inRemaining(0)
+    , _inPtr(nullptr)
+    , _inAvail(0)
+#endif
+{
+}
+
+FseqReader::~FseqReader() {
+    close();
+}
+
+void FseqReader::close() {
+    delete[] _blocks;
+    _blocks = nullptr;
+    _blockCount = 0;
+#if FSEQ_HAVE_ZLIB
+    delete _inflater;
+    delete[] _window;
+    _inflater = nullptr;
+    _window = nullptr;
+#endif
+    _source = nullptr;
+    _readAheadLength = 0;
+}
+
+bool FseqReader::open(FseqSource* source, uint32_t firstChannel, uint32_t windowChannels) {
+    close();
+    _error = "";
+    _source = source;
+    _windowChannels = windowChannels;
+    if (!readHeader(firstChannel)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool FseqReader::readHeader(uint32_t firstChannel) {
+    uint8_t header[FSEQ_FIXED_HEADER];
+    if (_source->read(0, header, sizeof(header)) != sizeof(header)) {
+        _error = "file too short";
+        return false;
+    }
+    if (memcmp(header, "PSEQ", 4) != 0) {
+        _error = "not an FSEQ file";
+        return false;
+    }
+    if (header[7] != 2) {
+        _error = "only FSEQ v2 is supported";
+        return false;
+    }
+
+    _dataOffset = readLE(header + 4, 2);
+    _channelCount = readLE(header + 10, 4);
+    _frameCount = readLE(header + 14, 4);
+    _stepMs = header[18];
+    uint8_t compression = header[20] & 0x0F;
+    uint16_t blocks = (uint16_t)(((header[20] & 0xF0) << 4) | header[21]);
+    uint8_t ranges = header[22];
+
+    if (_channelCount == 0 || _frameCount == 0 || _stepMs == 0) {
+        _error = "empty sequence";
+        return false;
+    }
+    if (compression == FSEQ_COMPRESSION_ZSTD) {
+        _error = "zstd is not supported, export with zlib or no compression";
+        return false;
+    }
+    if (compression > FSEQ_COMPRESSION_ZLIB) {
+        _error = "unknown compression";
+        return false;
+    }
+    _compression = (FseqCompression)compression;
+#if !FSEQ_HAVE_ZLIB
+    if (_compression == FSEQ_COMPRESSION_ZLIB) {
+        _error = "zlib is not available in this build";
+        return false;
+    }
+#endif
+
+    uint32_t rangeOffset = FSEQ_FIXED_HEADER + (uint32_t)blocks * 8;
+    if (rangeOffset + (uint32_t)ranges * 6 > _dataOffset) {
+        _error = "bad header";
+        return false;
+    }
+
+    // Map the window onto the stored frame. Without sparse ranges the frame
+    // holds every channel from 0; with them, the ranges back to back.
+    _spanCount = 0;
+    uint32_t windowEnd = firstChannel + _windowChannels;
+    uint32_t frameOffset = 0;
+    for (uint16_t r = 0; r < (ranges ? ranges : 1); r++) {
+        uint32_t start = 0;
+        uint32_t length = _channelCount;
+        if (ranges) {
+            uint8_t entry[6];
+            if (!fetch(rangeOffset + r * 6, entry, sizeof(entry))) return false;
+            start = readLE(entry, 3);
+            length = readLE(entry + 3, 3);
+        }
+        uint32_t lo = start > firstChannel ? start : firstChannel;
+        uint32_t hi = start + length < windowEnd ? start + length : windowEnd;
+        if (lo < hi && _spanCount < FSEQ_MAX_SPANS) {
+            Span& span = _spans[_spanCount++];
+            span.frameOffset = frameOffset + (lo - start);
+            span.outOffset = lo - firstChannel;
+            span.length = hi - lo;
+        }
+        frameOffset += length;
+    }
+    if (frameOffset > _channelCount) {
+        _error = "bad sparse ranges";
+        return false;
+    }
+
+    if (_compression == FSEQ_COMPRESSION_NONE) {
+        return true;
+    }
+
+#if FSEQ_HAVE_ZLIB
+    // xLights pads the index with empty entries; keep only real blocks
+    _blocks = new (std::nothrow) Block[blocks ? blocks : 1];
+    _inflater = new (std::nothrow) tinfl_decompressor;
+    _window = new (std::nothrow) uint8_t[TINFL_LZ_DICT_SIZE];
+    if (!_blocks || !_inflater || !_window) {
+        _error = "out of memory";
+        return false;
+    }
+    uint32_t offset = _dataOffset;
+    for (uint16_t b = 0; b < blocks; b++) {
+        uint8_t entry[8];
+        if (!fetch(FSEQ_FIXED_HEADER + b * 8, entry, sizeof(entry))) return false;
+        uint32_t length = readLE(entry + 4, 4);
+        if (length == 0) continue;
+        Block& block = _blocks[_blockCount++];
+        block.firstFrame = readLE(entry, 4);
+        block.offset = offset;
+        block.length = length;
+        offset += length;
+    }
+    if (_blockCount == 0 || _blocks[0].firstFrame != 0) {
+        _error = "bad block index";
+        return false;
+    }
+    _block = 0;
+    _nextFrame = _frameCount;  // Forces startBlock() on the first read
+#endif
+    return true;
+}
+
+bool FseqReader::fetch(uint32_t offset, uint8_t* out, uint32_t length) {
+    if (offset >= _readAheadOffset && offset + length <= _readAheadOffset + _readAheadLength) {
+        memcpy(out, _readAhead + (offset - _readAheadOffset), length);
+        return true;
+    }
+    if (length > FSEQ_READ_AHEAD) {
+        if (_source->read(offset, out, length) != length) {
+            _error = "read failed";
+            return false;
+        }
+        return true;
+    }
+    _readAheadOffset = offset;
+    _readAheadLength = (uint32_t)_source->read(offset, _readAhead, FSEQ_READ_AHEAD);
+    if (_readAheadLength < length) {
+        _readAheadLength = 0;
+        _error = "read failed";
+        return false;
+    }
+    memcpy(out, _readAhead, length);
+    return true;
+}
+
+void FseqReader::copySpans(uint32_t framePos, const uint8_t* data, uint32_t length, uint8_t* out) const {
+    uint32_t end = framePos + length;
+    for (uint8_t s = 0; s < _spanCount; s++) {
+        const Span& span = _spans[s];
+        uint32_t lo = span.frameOffset > framePos ? span.frameOffset : framePos;
+        uint32_t hi = span.frameOffset + span.length < end ? span.frameOffset + span.length : end;
+        if (lo < hi) {
+            memcpy(out + span.outOffset + (lo - span.frameOffset), data + (lo - framePos), hi - lo);
+        }
+    }
+}
+
+bool FseqReader::readFrame(uint32_t frame, uint8_t* out) {
+    if (!_source || frame >= _frameCount) {
+        return false;
+    }
+    memset(out, 0, _windowChannels);
+
+#if FSEQ_HAVE_ZLIB
+    if (_compression == FSEQ_COMPRESSION_ZLIB) {
+        return readCompressed(frame, out);
+    }
+#endif
+
+    uint32_t base = _dataOffset + frame * _channelCount;
+    for (uint8_t s = 0; s < _spanCount; s++) {
+        const Span& span = _spans[s];
+        if (!fetch(base + span.frameOffset, out + span.outOffset, span.length)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#if FSEQ_HAVE_ZLIB
+
+bool FseqReader::startBlock(uint16_t block) {
+    tinfl_init(_inflater);
+    _block = block;
+    _nextFrame = _blocks[block].firstFrame;
+    _inOffset = _blocks[block].offset;
+    _inRemaining = _blocks[block].length;
+    _inAvail = 0;
+    _windowPos = 0;
+    _pendingLength = 0;
+    // The read-ahead buffer now holds compressed input
+    _readAheadLength = 0;
+    return true;
+}
+
+bool FseqReader::inflateMore() {
+    for (;;) {
+        if (_inAvail == 0 && _inRemaining > 0) {
+            uint32_t chunk = _inRemaining < FSEQ_READ_AHEAD ? _inRemaining : FSEQ_READ_AHEAD;
+            if (_source->read(_inOffset, _readAhead, chunk) != chunk) {
+                _error = "read failed";
+                return false;
+            }
+            _inPtr = _readAhead;
+            _inAvail = chunk;
+            _inOffset += chunk;
+            _inRemaining -= chunk;
+        }
+
+        size_t inSize = _inAvail;
+        size_t outSize = TINFL_LZ_DICT_SIZE - _windowPos;
+        mz_uint32 flags = TINFL_FLAG_PARSE_ZLIB_HEADER;
+        if (_inRemaining > 0) flags |= TINFL_FLAG_HAS_MORE_INPUT;
+        tinfl_status status = tinfl_decompress(_inflater, _inPtr, &inSize,
+                                               _window, _window + _windowPos, &outSize, flags);
+        _inPtr += inSize;
+        _inAvail -= inSize;
+
+        if (outSize > 0) {
+            // Output never wraps within one call, so pending bytes are contiguous
+            _pendingStart = _windowPos;
+            _pendingLength = (uint32_t)outSize;
+            _windowPos = (_windowPos + (uint32_t)outSize) & (TINFL_LZ_DICT_SIZE - 1);
+            return true;
+        }
+        if (status < TINFL_STATUS_DONE) {
+            _error = "corrupt block";
+            return false;
+        }
+        if (status == TINFL_STATUS_DONE || (_inAvail == 0 && _inRemaining == 0)) {
+            _error = "block ended early";
+            return false;
+        }
+    }
+}
+
+bool FseqReader::readCompressed(uint32_t frame, uint8_t* out) {
+    // Last block starting at or before the frame
+    uint16_t block = 0;
+    uint16_t lo = 0, hi = _blockCount;
+    while (lo < hi) {
+        uint16_t mid = (lo + hi) / 2;
+        if (_blocks[mid].firstFrame <= frame) {
+            block = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (block != _block || frame < _nextFrame) {
+        startBlock(block);
+    }
+
+    // Inflate forward, keeping only the requested frame
+    while (_nextFrame <= frame) {
+        bool wanted = (_nextFrame == frame);
+        uint32_t framePos = 0;
+        while (framePos < _channelCount) {
+            if (_pendingLength == 0 && !inflateMore()) {
+                _nextFrame = _frameCount;
+                return false;
+            }
+            uint32_t n = _channelCount - framePos;
+            if (n > _pendingLength) n = _pendingLength;
+            if (wanted) {
+                copySpans(framePos, _window + _pendingStart, n, out);
+            }
+            _pendingStart += n;
+            _pendingLength -= n;
+            framePos += n;
+        }
+        _nextFrame++;
+    }
+    return true;
+}
+
+#endif
@@ -3,25 +3,123 @@
 // ESP32-S3 uses the RMT driver for FastLED
 // Make sure FASTLED_RMT_BUILTIN_DRIVER is enabled for ESP32-S3
 
+// Dark sky with green curtains fringed in teal and violet
+static const TProgmemRGBPalette16 AuroraColors_p = {
+    0x000000, 0x000000, 0x000402, 0x001A08,
+    0x004A18, 0x00A040, 0x20E060, 0x00C070,
+    0x008070, 0x104080, 0x301860, 0x100820,
+    0x000000, 0x000000, 0x000402, 0x002010
+};
+
 LEDController::LEDController(Calibration& calibration)
     : _calibration(calibration)
     , _isOn(true)
     , _brightness(DEFAULT_BRIGHTNESS)
     , _solidColor(CRGB::White)
-    , _currentAnimation(ANIMATION_STATIC)
     , _animationSpeed(DEFAULT_ANIMATION_SPEED)
-    , _lastUpdate(0)
-    , _animationPhase(0) {
+    , _transitionActive(false)
+    , _transitionDuration(TRANSITION_DEFAULT_MS)
+    , _transitionType(TRANSITION_DEFAULT_TYPE)
+    , _transitionAxis((SortOrder)TRANSITION_DEFAULT_AXIS)
+    , _transitionStart(0)
+    , _transitionMicros(0)
+    , _transitionPeakMicros(0)
+    , _layerMicros(0)
+    , _segmentBuffer(nullptr)
+    , _frameSource(nullptr)
+    , _fireRevision(0)
+    , _fireReady(false)
+    , _audio(nullptr)
+    , _audioBeats(0)
+    , _audioBeatTime(0)
+    , _noiseRevision(0)
+    , _noiseReady(false)
+    , _noiseMicros(0)
+    , _particleMicros(0)
+    , _grayCodeActive(false)
+    , _grayCodeRepeat(false)
+    , _grayCodeFrame(0)
+    , _grayCodeHold(GRAYCODE_DEFAULT_HOLD)
+    , _grayCodeFrameStart(0)
+    , _lastShow(0)
+    , _batchDepth(0) {
+    memset(&_audioSnapshot, 0, sizeof(_audioSnapshot));
+    _current.mode = ANIMATION_STATIC;
+    _current.color = _solidColor;
+    _current.speed = _animationSpeed;
+    _current.phase = 0;
+    _current.phaseStep = 0;
+    _current.lastUpdate = 0;
+    _current.buffer = _pool.acquire();
+    _current.fire = nullptr;
+    _current.start = 0;
+    _current.count = NUM_LEDS;
+    _current.reverse = false;
+    _outgoing = _current;
+    _outgoing.buffer = nullptr;
+
+    for (uint8_t l = 0; l < OVERLAY_LAYERS; l++) {
+        _layers[l].anim = _outgoing;
+        _layers[l].opacity = 255;
+        _layers[l].blend = BLEND_NORMAL;
+        _layers[l].enabled = false;
+    }
+    for (uint8_t i = 0; i < MAX_SEGMENTS; i++) {
+        _segments[i].name[0] = '\0';
+        _segments[i].anim = _outgoing;
+        _segments[i].enabled = false;
+    }
 }
 
 void LEDController::begin() {
-    FastLED.addLeds<LED_TYPE, LED_DATA_PIN, COLOR_ORDER>(_leds, NUM_LEDS);
-    FastLED.setBrightness(_brightness);
-    FastLED.clear();
+    pixelKernelsBegin();
+    if (!_particles.begin(PARTICLE_CAPACITY)) {
+        Serial.println("Particles: no PSRAM for the pool, particle animations stay dark");
+    }
+
+    // FastLED drives the output stage's buffer; brightness and dithering happen there
+    FastLED.addLeds<LED_TYPE, LED_DATA_PIN, COLOR_ORDER>(_output.getOutput(), NUM_LEDS);
+    FastLED.setBrightness(255);
+    FastLED.setDither(DISABLE_DITHER);
+    _output.setBrightness(_brightness);
+    _frameCache.setEnabled(FRAME_CACHE_DEFAULT);
+    clear();
+    show();
+}
+
+void LEDController::show() {
+    if (_batchDepth > 0) {
+        return;
+    }
+    _output.render(_leds);
     FastLED.show();
+    _lastShow = millis();
+}
+
+void LEDController::endBatch() {
+    if (_batchDepth == 0 || --_batchDepth > 0) {
+        return;
+    }
+    _current.lastUpdate = 0;
+    for (uint8_t i = 0; i < MAX_SEGMENTS; i++) {
+        _segments[i].anim.lastUpdate = 0;
+    }
+    for (uint8_t l = 0; l < OVERLAY_LAYERS; l++) {
+        _layers[l].anim.lastUpdate = 0;
+    }
+}
+
+void LEDController::clear() {
+    pixelFill(_leds, NUM_LEDS, CRGB::Black);
 }
 
 void LEDController::update() {
+    // Structured-light capture overrides everything else
+    if (_grayCodeActive) {
+        updateGrayCode();
+        return;
+    }
+
     // Handle calibration mode
     if (_calibration.isCalibrating()) {
         showCalibrationLED(_calibration.getCalibrationLED());
@@ -29,113 +127,576 @@ void LEDController::update() {
     }
 
     if (!_isOn) {
-        FastLED.clear();
-        FastLED.show();
+        clear();
+        show();
         return;
     }
 
     unsigned long now = millis();
-    if (now - _lastUpdate < _animationSpeed) {
+
+    // During a transition both animations keep running
+    uint32_t start = micros();
+    bool drawn = _transitionActive && stepAnimation(_outgoing, now);
+    uint32_t outgoingMicros = micros() - start;
+    drawn |= stepAnimation(_current, now);
+    for (uint8_t i = 0; i < MAX_SEGMENTS; i++) {
+        if (_segments[i].enabled) {
+            drawn |= stepAnimation(_segments[i].anim, now);
+        }
+    }
+    for (uint8_t l = 0; l < OVERLAY_LAYERS; l++) {
+        if (_layers[l].enabled) {
+            drawn |= stepAnimation(_layers[l].anim, now);
+        }
+    }
+
+    // The blend is redrawn at a steady rate so short transitions stay smooth
+    // even with slow animations
+    bool transitionDue = _transitionActive && now - _lastShow >= TRANSITION_FRAME_INTERVAL;
+    if (!drawn && !transitionDue) {
+        fillFrameCache();
+        // Dithering only averages out if the strip refreshes faster than the animation
+        if (_output.isDithering() && now - _lastShow >= OUTPUT_REFRESH_INTERVAL) {
+            show();
+        }
+        return;
+    }
+
+    if (_transitionActive && now - _transitionStart >= _transitionDuration) {
+        endTransition();
+    }
+    if (_transitionActive) {
+        start = micros();
+        blendTransition(_leds, now);
+        _transitionMicros = outgoingMicros + (micros() - start);
+        if (_transitionMicros > _transitionPeakMicros) {
+            _transitionPeakMicros = _transitionMicros;
+        }
+    } else {
+        memcpy(_leds, _current.buffer, sizeof(_leds));
+    }
+    compositeSegments();
+    compositeLayers();
+    show();
+}
+
+void LEDController::refreshFrame() {
+    memcpy(_leds, _current.buffer, sizeof(_leds));
+    compositeSegments();
+    compositeLayers();
+    show();
+}
+
+bool LEDController::stepAnimation(AnimationInstance& anim, unsigned long now) {
+    // Sequences run at the file's frame rate, not the animation speed
+    if (anim.mode == ANIMATION_SEQUENCE) {
+        bool drawn = _frameSource && _frameSource->renderFrame(anim.buffer, NUM_LEDS, now);
+        if (!drawn && anim.lastUpdate == 0) {
+            pixelFill(anim.buffer, NUM_LEDS, CRGB::Black);  // Nothing loaded
+            drawn = true;
+        }
+        if (drawn) {
+            anim.lastUpdate = now;
+        }
+        return drawn;
+    }
+    // A static frame never changes once drawn
+    if (now - anim.lastUpdate < anim.speed || (anim.mode == ANIMATION_STATIC && anim.lastUpdate != 0)) {
+        return false;
+    }
+    anim.lastUpdate = now;
+    if (&anim == &_current && isPeriodic(anim.mode) &&
+        _frameCache.prepare(anim.mode, anim.color, _calibration.getRevision())) {
+        uint8_t step = anim.phaseStep;
+        const CRGB* frame = _frameCache.get(step);
+        if (frame) {
+            memcpy(anim.buffer, frame, NUM_LEDS * sizeof(CRGB));
+            advancePhase(anim);
+            _frameCache.countHit();
+        } else {
+            renderAnimation(anim);
+            memcpy(_frameCache.slot(step), anim.buffer, NUM_LEDS * sizeof(CRGB));
+            _frameCache.markValid(step);
+            _frameCache.countMiss();
+        }
+        return true;
+    }
+    renderAnimation(anim);
+    return true;
+}
+
+bool LEDController::isPeriodic(AnimationMode mode) {
+    switch (mode) {
+        case ANIMATION_RAINBOW:
+        case ANIMATION_CANDY_CANE:
+        case ANIMATION_SPATIAL_WAVE:
+        case ANIMATION_SPATIAL_RAINBOW:
+        case ANIMATION_SPATIAL_PULSE:
+        case ANIMATION_SPATIAL_ROTATE:
+        case ANIMATION_SPATIAL_PLANES:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void LEDController::fillFrameCache() {
+    _frameCache.checkMemory();
+    if (!isPeriodic(_current.mode) ||
+        !_frameCache.prepare(_current.mode, _current.color, _calibration.getRevision())) {
+        return;
+    }
+    // Render ahead of playback so the frames are ready when it gets there
+    int16_t step = _frameCache.nextMissing(_current.phaseStep);
+    if (step < 0) {
         return;
     }
-    _lastUpdate = now;
+    AnimationInstance scratch = _current;
+    scratch.buffer = _frameCache.slot(step);
+    scratch.phaseStep = step;
+    scratch.phase = step * (2 * PI / ANIMATION_PHASE_STEPS);
+    renderAnimation(scratch);
+    _frameCache.markValid(step);
+}
 
-    switch (_currentAnimation) {
+void LEDController::renderAnimation(AnimationInstance& anim) {
+    switch (anim.mode) {
         case ANIMATION_STATIC:
-            // Static color - no animation needed
+            pixelFill(anim.buffer + anim.start, anim.count, anim.color);
             break;
         case ANIMATION_RAINBOW:
-            animateRainbow();
+            animateRainbow(anim);
             break;
         case ANIMATION_CHASE:
-            animateChase();
+            animateChase(anim);
             break;
         case ANIMATION_TWINKLE:
-            animateTwinkle();
+            animateTwinkle(anim);
             break;
         case ANIMATION_FADE:
-            animateFade();
+            animateFade(anim);
             break;
         case ANIMATION_SPARKLE:
-            animateSparkle();
+            animateSparkle(anim);
             break;
         case ANIMATION_CANDY_CANE:
-            animateCandyCane();
+            animateCandyCane(anim);
             break;
         case ANIMATION_SNOW:
-            animateSnow();
+            animateSnow(anim);
             break;
         case ANIMATION_FIRE:
-            animateFire();
+            animateFire(anim);
             break;
         case ANIMATION_SPATIAL_WAVE:
-            animateSpatialWave();
+            animateSpatialWave(anim);
             break;
         case ANIMATION_SPATIAL_RAINBOW:
-            animateSpatialRainbow();
+            animateSpatialRainbow(anim);
             break;
         case ANIMATION_SPATIAL_PULSE:
-            animateSpatialPulse();
+            animateSpatialPulse(anim);
             break;
         case ANIMATION_SPATIAL_ROTATE:
-            animateSpatialRotate();
+            animateSpatialRotate(anim);
             break;
         case ANIMATION_SPATIAL_PLANES:
-            animateSpatialPlanes();
+            animateSpatialPlanes(anim);
+            break;
+        case ANIMATION_SWEEP_WIPE:
+            animateSweepWipe(anim);
+            break;
+        case ANIMATION_SWEEP_RIPPLE:
+            animateSweepRipple(anim);
+            break;
+        case ANIMATION_SWEEP_ANGULAR:
+            animateSweepAngular(anim);
+            break;
+        case ANIMATION_AUDIO_SPECTRUM:
+            animateAudioSpectrum(anim);
+            break;
+        case ANIMATION_AUDIO_BEAT:
+            animateAudioBeat(anim);
+            break;
+        case ANIMATION_NOISE_CLOUDS:
+            animateNoise(anim, CloudColors_p);
+            break;
+        case ANIMATION_NOISE_LAVA:
+            animateNoise(anim, LavaColors_p);
+            break;
+        case ANIMATION_NOISE_AURORA:
+            animateNoise(anim, AuroraColors_p);
+            break;
+        case ANIMATION_PARTICLE_SNOW:
+            animateParticles(anim, PARTICLE_EMITTER_SNOW, 255);
+            break;
+        case ANIMATION_PARTICLE_FIREWORKS:
+            animateParticles(anim, PARTICLE_EMITTER_FIREWORKS, 96);
+            break;
+        case ANIMATION_PARTICLE_EMBERS:
+            animateParticles(anim, PARTICLE_EMITTER_EMBERS, 160);
             break;
         default:
             break;
     }
 
-    FastLED.show();
-    _animationPhase += 0.05f;  // Increment phase for smooth animations
-    if (_animationPhase > 2 * PI) {
-        _animationPhase -= 2 * PI;
+    advancePhase(anim);
+}
+
+void LEDController::advancePhase(AnimationInstance& anim) {
+    // Whole steps per cycle, so periodic animations repeat exactly
+    anim.phaseStep = (anim.phaseStep + 1) % ANIMATION_PHASE_STEPS;
+    anim.phase = anim.phaseStep * (2 * PI / ANIMATION_PHASE_STEPS);
+}
+
+void LEDController::blendTransition(CRGB* dst, unsigned long now) {
+    // dst may be the outgoing buffer itself
+    uint32_t elapsed = min(now - _transitionStart, (unsigned long)_transitionDuration);
+
+    if (_transitionType == TRANSITION_WIPE) {
+        // The new animation grows along the chosen ordering behind a soft edge
+        const uint16_t* ranks = _calibration.getRanks(_transitionAxis);
+        const uint32_t soft = max(NUM_LEDS / 8, 1) * 256;  // Edge width in 8.8 ranks
+        uint32_t edge = (uint32_t)(((uint64_t)elapsed * ((uint32_t)NUM_LEDS * 256 + soft)) / _transitionDuration);
+        for (uint16_t i = 0; i < NUM_LEDS; i++) {
+            uint32_t pos = (uint32_t)ranks[i] * 256;
+            uint8_t level;
+            if (pos + soft <= edge) {
+                level = 255;
+            } else if (pos >= edge) {
+                level = 0;
+            } else {
+                level = (edge - pos) * 255 / soft;
+            }
+            dst[i] = blend(_outgoing.buffer[i], _current.buffer[i], level);
+        }
+    } else {
+        if (dst != _outgoing.buffer) {
+            memcpy(dst, _outgoing.buffer, NUM_LEDS * sizeof(CRGB));
+        }
+        pixelBlend(dst, _current.buffer, NUM_LEDS, (uint8_t)min(elapsed * 256 / _transitionDuration, (uint32_t)255));
+    }
+}
+
+void LEDController::compositeSegments() {
+    for (uint8_t i = 0; i < MAX_SEGMENTS; i++) {
+        const Segment& segment = _segments[i];
+        if (!segment.enabled) continue;
+        const AnimationInstance& anim = segment.anim;
+        if (anim.reverse) {
+            for (uint16_t k = 0; k < anim.count; k++) {
+                _leds[spanLedIndex(anim, k)] = _segmentBuffer[anim.start + k];
+            }
+        } else {
+            memcpy(&_leds[anim.start], &_segmentBuffer[anim.start], anim.count * sizeof(CRGB));
+        }
+    }
+}
+
+bool LEDController::setSegment(uint8_t index, const char* name, uint16_t start, uint16_t length, bool reverse,
+                               AnimationMode mode, CRGB color, uint16_t speed) {
+    if (index >= MAX_SEGMENTS || length == 0 || start >= NUM_LEDS || length > NUM_LEDS - start ||
+        !animationHasContent(mode)) {
+        return false;
+    }
+    for (uint8_t i = 0; i < MAX_SEGMENTS; i++) {
+        const AnimationInstance& other = _segments[i].anim;
+        if (i != index && _segments[i].enabled &&
+            start < other.start + other.count && other.start < start + length) {
+            return false;
+        }
+    }
+
+    if (!_segmentBuffer) {
+        _segmentBuffer = _pool.acquire();
+        if (!_segmentBuffer) {
+            return false;
+        }
+    }
+
+    Segment& segment = _segments[index];
+    AnimationInstance& anim = segment.anim;
+    bool restart = !segment.enabled || anim.mode != mode || anim.start != start || anim.count != length;
+    strlcpy(segment.name, name ? name : "", sizeof(segment.name));
+    anim.mode = mode;
+    anim.color = color;
+    anim.speed = speed;
+    anim.lastUpdate = 0;  // Draw on the next update
+    anim.buffer = _segmentBuffer;
+    anim.start = start;
+    anim.count = length;
+    anim.reverse = reverse;
+    if (restart) {
+        anim.phase = 0;
+        anim.phaseStep = 0;
+        releaseFire(anim);
+        pixelFill(_segmentBuffer + start, length, CRGB::Black);
+    }
+    segment.enabled = true;
+    _events.emit(STATE_EVENT_SEGMENTS);
+    return true;
+}
+
+void LEDController::clearSegment(uint8_t index) {
+    if (index >= MAX_SEGMENTS || !_segments[index].enabled) {
+        return;
+    }
+    _segments[index].enabled = false;
+    releaseFire(_segments[index].anim);
+
+    bool anyEnabled = false;
+    for (uint8_t i = 0; i < MAX_SEGMENTS; i++) {
+        anyEnabled |= _segments[i].enabled;
+    }
+    if (!anyEnabled) {
+        _pool.release(_segmentBuffer);
+        _segmentBuffer = nullptr;
+    }
+    _current.lastUpdate = 0;  // Give the span back to the main animation
+    _events.emit(STATE_EVENT_SEGMENTS);
+}
+
+// One channel of src combined with dst, before opacity
+static inline uint8_t blendChannel(uint8_t dst, uint8_t src, BlendMode mode) {
+    switch (mode) {
+        case BLEND_ADD:      return qadd8(dst, src);
+        case BLEND_MULTIPLY: return scale8(dst, src);
+        case BLEND_MAX:      return dst > src ? dst : src;
+        case BLEND_SCREEN:   return 255 - scale8(255 - dst, 255 - src);
+        default:             return src;
     }
 }
 
+void LEDController::compositeLayers() {
+    const Layer* active[OVERLAY_LAYERS];
+    uint8_t count = 0;
+    for (uint8_t l = 0; l < OVERLAY_LAYERS; l++) {
+        if (_layers[l].enabled && _layers[l].opacity > 0) {
+            active[count++] = &_layers[l];
+        }
+    }
+    if (count == 0) {
+        _layerMicros = 0;
+        return;
+    }
+
+    // All layers in one pass over the frame
+    uint32_t start = micros();
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        CRGB pixel = _leds[i];
+        for (uint8_t k = 0; k < count; k++) {
+            const Layer& layer = *active[k];
+            const CRGB& src = layer.anim.buffer[i];
+            CRGB mixed(blendChannel(pixel.r, src.r, layer.blend),
+                       blendChannel(pixel.g, src.g, layer.blend),
+                       blendChannel(pixel.b, src.b, layer.blend));
+            pixel = layer.opacity == 255 ? mixed : blend(pixel, mixed, layer.opacity);
+        }
+        _leds[i] = pixel;
+    }
+    _layerMicros = micros() - start;
+}
+
+bool LEDController::setLayer(uint8_t index, AnimationMode mode, CRGB color, uint16_t speed,
+                             uint8_t opacity, BlendMode blend) {
+    // Custom patterns only exist as the main animation
+    if (index >= OVERLAY_LAYERS || !animationHasContent(mode) || blend >= BLEND_MODE_COUNT) {
+        return false;
+    }
+
+    Layer& layer = _layers[index];
+    if (!layer.enabled) {
+        layer.anim.buffer = _pool.acquire();
+        if (!layer.anim.buffer) {
+            return false;
+        }
+        pixelFill(layer.anim.buffer, NUM_LEDS, CRGB::Black);
+    }
+    if (!layer.enabled || layer.anim.mode != mode) {
+        layer.anim.phase = 0;
+        layer.anim.phaseStep = 0;
+        releaseFire(layer.anim);
+    }
+    layer.anim.mode = mode;
+    layer.anim.color = color;
+    layer.anim.speed = speed;
+    layer.anim.lastUpdate = 0;  // Draw on the next update
+    layer.opacity = opacity;
+    layer.blend = blend;
+    layer.enabled = true;
+    _events.emit(STATE_EVENT_ANIMATION);
+    return true;
+}
+
+void LEDController::clearLayer(uint8_t index) {
+    if (index >= OVERLAY_LAYERS || !_layers[index].enabled) {
+        return;
+    }
+    _layers[index].enabled = false;
+    releaseFire(_layers[index].anim);
+    _pool.release(_layers[index].anim.buffer);
+    _layers[index].anim.buffer = nullptr;
+    _current.lastUpdate = 0;  // Recomposite without it
+    _events.emit(STATE_EVENT_ANIMATION);
+}
+
+void LEDController::switchAnimation(AnimationMode mode, CRGB color) {
+    bool animate = _isOn && _transitionDuration > 0 &&
+                   !_grayCodeActive && !_calibration.isCalibrating();
+
+    if (animate && _transitionActive) {
+        // Interrupted: freeze the blend as it stands and fade from that
+        blendTransition(_outgoing.buffer, millis());
+        _outgoing.mode = ANIMATION_CUSTOM;
+        releaseFire(_outgoing);
+    } else if (animate) {
+        CRGB* buffer = _pool.acquire();
+        if (buffer) {
+            _outgoing = _current;  // The outgoing animation keeps its fire state
+            _current.buffer = buffer;
+            _current.fire = nullptr;
+        } else {
+            animate = false;
+        }
+    } else {
+        endTransition();
+    }
+
+    _current.mode = mode;
+    _current.color = color;
+    _current.speed = _animationSpeed;
+    _current.phase = 0;
+    _current.phaseStep = 0;
+    _current.lastUpdate = 0;  // Draw on the next update
+    releaseFire(_current);
+
+    if (animate) {
+        pixelFill(_current.buffer, NUM_LEDS, CRGB::Black);
+        _transitionActive = true;
+        _transitionStart = millis();
+        _transitionPeakMicros = 0;
+    } else if (mode == ANIMATION_STATIC) {
+        pixelFill(_current.buffer, NUM_LEDS, color);
+        refreshFrame();
+    }
+}
+
+void LEDController::endTransition() {
+    if (!_transitionActive) {
+        return;
+    }
+    _transitionActive = false;
+    releaseFire(_outgoing);
+    _pool.release(_outgoing.buffer);
+    _outgoing.buffer = nullptr;
+}
+
+void LEDController::releaseFire(AnimationInstance& anim) {
+    if (anim.fire) {
+        _firePool.release(anim.fire);
+        anim.fire = nullptr;
+    }
+}
+
+void LEDController::setTransition(uint16_t durationMs, uint8_t type, SortOrder axis) {
+    _transitionDuration = durationMs;
+    _transitionType = type == TRANSITION_WIPE ? TRANSITION_WIPE : TRANSITION_LINEAR;
+    _transitionAxis = axis < SORT_ORDER_COUNT ? axis : SORT_BY_Y;
+}
+
+uint8_t LEDController::getTransitionProgress() const {
+    if (!_transitionActive || _transitionDuration == 0) {
+        return 255;
+    }
+    uint32_t elapsed = millis() - _transitionStart;
+    return elapsed >= _transitionDuration ? 255 : elapsed * 255 / _transitionDuration;
+}
+
 void LEDController::setOn(bool on) {
+    bool changed = (on != _isOn);
     _isOn = on;
     if (!on) {
-        FastLED.clear();
-        FastLED.show();
+        endTransition();
+        clear();
+        show();
+    }
+    if (changed) {
+        _events.emit(STATE_EVENT_POWER);
     }
 }
 
 void LEDController::setBrightness(uint8_t brightness) {
+    bool changed = (brightness != _brightness);
     _brightness = brightness;
-    FastLED.setBrightness(brightness);
-    FastLED.show();
+    _output.setBrightness(brightness);
+    show();
+    if (changed) {
+        _events.emit(STATE_EVENT_BRIGHTNESS);
+    }
 }
 
 void LEDController::setSolidColor(CRGB color) {
+    bool colorChanged = (color != _solidColor);
+    bool animationChanged = (_current.mode != ANIMATION_STATIC);
     _solidColor = color;
-    _currentAnimation = ANIMATION_STATIC;
-    fill_solid(_leds, NUM_LEDS, color);
-    FastLED.show();
+    if (animationChanged || _transitionActive) {
+        switchAnimation(ANIMATION_STATIC, color);
+    } else {
+        // Colour picks on a static tree apply immediately
+        _current.color = color;
+        pixelFill(_current.buffer, NUM_LEDS, color);
+        refreshFrame();
+    }
+    if (colorChanged) {
+        _events.emit(STATE_EVENT_COLOR);
+    }
+    if (animationChanged) {
+        _events.emit(STATE_EVENT_ANIMATION);
+    }
 }
 
 void LEDController::setPixelColor(uint16_t index, CRGB color) {
     if (index < NUM_LEDS) {
         _leds[index] = color;
+        // Custom mode keeps its pattern in its own buffer like any other animation
+        if (_current.mode == ANIMATION_CUSTOM) {
+            _current.buffer[index] = color;
+        }
     }
 }
 
 void LEDController::setAnimation(AnimationMode mode) {
-    _currentAnimation = mode;
-    _animationPhase = 0;
-    if (mode == ANIMATION_STATIC) {
-        fill_solid(_leds, NUM_LEDS, _solidColor);
-        FastLED.show();
+    bool changed = (mode != _current.mode);
+    switchAnimation(mode, _solidColor);
+    if (changed) {
+        _events.emit(STATE_EVENT_ANIMATION);
+    }
+}
+
+void LEDController::setAnimation(AnimationMode mode, CRGB color) {
+    bool modeChanged = (mode != _current.mode);
+    bool colorChanged = (color != _solidColor);
+    _solidColor = color;
+    switchAnimation(mode, color);
+    if (colorChanged) {
+        _events.emit(STATE_EVENT_COLOR);
+    }
+    if (modeChanged) {
+        _events.emit(STATE_EVENT_ANIMATION);
     }
 }
 
 void LEDController::setAnimationSpeed(uint16_t speedMs) {
+    bool changed = (speedMs != _animationSpeed);
     _animationSpeed = speedMs;
+    _current.speed = speedMs;
+    if (changed) {
+        _events.emit(STATE_EVENT_SPEED);
+    }
 }
 
 void LEDController::showCalibrationLED(int16_t index) {
-    FastLED.clear();
+    clear();
     if (index >= 0 && index < NUM_LEDS) {
         // Show the calibration LED in bright white
         _leds[index] = CRGB::White;
@@ -147,80 +708,153 @@ void LEDController::showCalibrationLED(int16_t index) {
             _leds[index + 1] = CRGB(0, 30, 0);  // Next: dim green
         }
     }
-    FastLED.show();
+    show();
+}
+
+void LEDController::startGrayCode(uint16_t holdMs, bool repeat) {
+    _grayCodeHold = max(holdMs, (uint16_t)GRAYCODE_MIN_HOLD);
+    _grayCodeRepeat = repeat;
+    _grayCodeFrame = GRAY_CODE_FRAME_SYNC;
+    endTransition();
+    _grayCodeActive = true;
+    Serial.printf("Gray code: %u frames, %u ms hold\n", grayCodeFrameCount(NUM_LEDS), _grayCodeHold);
+    showGrayCodeFrame();
+}
+
+void LEDController::stopGrayCode() {
+    if (!_grayCodeActive) {
+        return;
+    }
+    _grayCodeActive = false;
+
+    // Put the normal output back (static mode has no per-frame redraw)
+    _current.lastUpdate = 0;
+    if (_current.mode == ANIMATION_STATIC && _isOn) {
+        pixelFill(_leds, NUM_LEDS, _solidColor);
+    } else {
+        clear();
+    }
+    show();
+}
+
+void LEDController::updateGrayCode() {
+    // The sync frame is held twice as long so it stands out in a video capture
+    unsigned long hold = _grayCodeHold;
+    if (_grayCodeFrame == GRAY_CODE_FRAME_SYNC) {
+        hold *= 2;
+    }
+    if (millis() - _grayCodeFrameStart < hold) {
+        return;
+    }
+
+    _grayCodeFrame++;
+    if (_grayCodeFrame >= grayCodeFrameCount(NUM_LEDS)) {
+        if (!_grayCodeRepeat) {
+            stopGrayCode();
+            return;
+        }
+        _grayCodeFrame = GRAY_CODE_FRAME_SYNC;
+    }
+    showGrayCodeFrame();
+}
+
+void LEDController::showGrayCodeFrame() {
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        _leds[i] = grayCodeLit(_grayCodeFrame, i, NUM_LEDS) ? CRGB::White : CRGB::Black;
+    }
+    show();
+    _grayCodeFrameStart = millis();
 }
 
 // ============================================
 // Basic Animation Implementations
 // ============================================
 
-void LEDController::animateRainbow() {
-    uint8_t hueStep = (uint8_t)(_animationPhase * 40.0f) % 256;
-    fill_rainbow(_leds, NUM_LEDS, hueStep, 255 / NUM_LEDS);
+void LEDController::animateRainbow(AnimationInstance& anim) {
+    CRGB* leds = anim.buffer + anim.start;
+    uint8_t hueStep = (uint8_t)(anim.phase * 40.0f) % 256;
+    fill_rainbow(leds, anim.count, hueStep, 255 / anim.count);
 }
 
-void LEDController::animateChase() {
-    fadeToBlackBy(_leds, NUM_LEDS, 50);
-    int pos = (int)(_animationPhase * 3.0f) % NUM_LEDS;
-    _leds[pos] = _solidColor;
+void LEDController::animateChase(AnimationInstance& anim) {
+    CRGB* leds = anim.buffer + anim.start;
+    pixelFade(leds, anim.count, 50);
+    int pos = (int)(anim.phase * 3.0f) % anim.count;
+    leds[pos] = anim.color;
 }
 
-void LEDController::animateTwinkle() {
-    fadeToBlackBy(_leds, NUM_LEDS, 20);
+void LEDController::animateTwinkle(AnimationInstance& anim) {
+    CRGB* leds = anim.buffer + anim.start;
+    pixelFade(leds, anim.count, 20);
     if (random8() < 80) {
-        _leds[random16(NUM_LEDS)] = _solidColor;
+        leds[random16(anim.count)] = anim.color;
     }
 }
 
-void LEDController::animateFade() {
-    uint8_t brightness = beatsin8(30, 50, 255);
-    fill_solid(_leds, NUM_LEDS, _solidColor);
-    FastLED.setBrightness(scale8(brightness, _brightness));
+void LEDController::animateFade(AnimationInstance& anim) {
+    CRGB* leds = anim.buffer + anim.start;
+    // Scale the frame itself so the global brightness stays untouched
+    CRGB color = anim.color;
+    color.nscale8(beatsin8(30, 50, 255));
+    pixelFill(leds, anim.count, color);
 }
 
-void LEDController::animateSparkle() {
-    fill_solid(_leds, NUM_LEDS, _solidColor);
-    int pos = random16(NUM_LEDS);
-    _leds[pos] = CRGB::White;
+void LEDController::animateSparkle(AnimationInstance& anim) {
+    CRGB* leds = anim.buffer + anim.start;
+    pixelFill(leds, anim.count, anim.color);
+    int pos = random16(anim.count);
+    leds[pos] = CRGB::White;
 }
 
-void LEDController::animateCandyCane() {
-    int offset = (int)(_animationPhase * 2.0f);
-    for (int i = 0; i < NUM_LEDS; i++) {
+void LEDController::animateCandyCane(AnimationInstance& anim) {
+    CRGB* leds = anim.buffer + anim.start;
+    int offset = (int)(anim.phase * 2.0f);
+    for (uint16_t i = 0; i < anim.count; i++) {
         if (((i + offset) % 6) < 3) {
-            _leds[i] = CRGB::Red;
+            leds[i] = CRGB::Red;
         } else {
-            _leds[i] = CRGB::White;
+            leds[i] = CRGB::White;
         }
     }
 }
 
-void LEDController::animateSnow() {
-    fadeToBlackBy(_leds, NUM_LEDS, 10);
+void LEDController::animateSnow(AnimationInstance& anim) {
+    CRGB* leds = anim.buffer + anim.start;
+    pixelFade(leds, anim.count, 10);
     if (random8() < 30) {
-        int pos = random16(NUM_LEDS);
-        _leds[pos] = CRGB::White;
+        int pos = random16(anim.count);
+        leds[pos] = CRGB::White;
     }
 }
 
-void LEDController::animateFire() {
-    static byte heat[NUM_LEDS];
-
-    for (int i = 0; i < NUM_LEDS; i++) {
-        heat[i] = qsub8(heat[i], random8(0, 35));
+void LEDController::animateFire(AnimationInstance& anim) {
+    // Heat rises up the tree on a grid in calibrated space; each LED reads
+    // its precomputed cell. Uncalibrated, the flames run along the strip.
+    CRGB* leds = anim.buffer + anim.start;
+    if (!anim.fire) {
+        anim.fire = _firePool.acquire();
+        if (!anim.fire) {
+            pixelFill(leds, anim.count, CRGB::Black);  // More fires than grids
+            return;
+        }
     }
-
-    for (int k = NUM_LEDS - 1; k >= 2; k--) {
-        heat[k] = (heat[k - 1] + heat[k - 2] + heat[k - 2]) / 3;
+    uint32_t revision = _calibration.getRevision();
+    if (!_fireReady || _fireRevision != revision) {
+        _fireLayout.prepare(_calibration.getAllPositions());
+        _fireRevision = revision;
+        _fireReady = true;
     }
 
-    if (random8() < 120) {
-        int y = random8(7);
-        heat[y] = qadd8(heat[y], random8(160, 255));
-    }
+    anim.fire->step(FIRE_COOLING, FIRE_SPARKING);
 
-    for (int j = 0; j < NUM_LEDS; j++) {
-        _leds[j] = HeatColor(heat[j]);
+    if (_fireLayout.isSpatial()) {
+        for (uint16_t i = 0; i < anim.count; i++) {
+            leds[i] = HeatColor(anim.fire->sample(_fireLayout.get(spanLedIndex(anim, i))));
+        }
+    } else {
+        for (uint16_t i = 0; i < anim.count; i++) {
+            leds[i] = HeatColor(anim.fire->sample(FireLayout::alongStrip(i, anim.count)));
+        }
     }
 }
 
@@ -229,73 +863,272 @@ void LEDController::animateFire() {
 // These use the 3D calibration positions
 // ============================================
 
-void LEDController::animateSpatialWave() {
+void LEDController::animateSpatialWave(AnimationInstance& anim) {
+    CRGB* leds = anim.buffer + anim.start;
     // Wave traveling along X axis, using actual LED positions
-    for (int i = 0; i < NUM_LEDS; i++) {
-        LEDPosition pos = _calibration.getPosition(i);
+    for (uint16_t i = 0; i < anim.count; i++) {
+        LEDPosition pos = _calibration.getPosition(spanLedIndex(anim, i));
         // Calculate wave based on X position
-        float wave = sin(_animationPhase * 4.0f + pos.x * PI);
+        float wave = sin(anim.phase * 4.0f + pos.x * PI);
         uint8_t brightness = (uint8_t)((wave + 1.0f) * 127.5f);
-        _leds[i] = _solidColor;
-        _leds[i].nscale8(brightness);
+        leds[i] = anim.color;
+        leds[i].nscale8(brightness);
     }
 }
 
-void LEDController::animateSpatialRainbow() {
+void LEDController::animateSpatialRainbow(AnimationInstance& anim) {
+    CRGB* leds = anim.buffer + anim.start;
     // Rainbow mapped to 3D position
-    for (int i = 0; i < NUM_LEDS; i++) {
-        LEDPosition pos = _calibration.getPosition(i);
+    for (uint16_t i = 0; i < anim.count; i++) {
+        LEDPosition pos = _calibration.getPosition(spanLedIndex(anim, i));
         // Use combination of X and Y for hue
-        float hueFloat = (pos.x + 1.0f) * 64.0f + (pos.y + 1.0f) * 64.0f + _animationPhase * 40.0f;
+        float hueFloat = (pos.x + 1.0f) * 64.0f + (pos.y + 1.0f) * 64.0f + anim.phase * 40.0f;
         uint8_t hue = (uint8_t)((int)hueFloat % 256);
-        _leds[i] = CHSV(hue, 255, 255);
+        leds[i] = CHSV(hue, 255, 255);
     }
 }
 
-void LEDController::animateSpatialPulse() {
+void LEDController::animateSpatialPulse(AnimationInstance& anim) {
+    CRGB* leds = anim.buffer + anim.start;
     // Pulse emanating from center outward
-    for (int i = 0; i < NUM_LEDS; i++) {
-        LEDPosition pos = _calibration.getPosition(i);
+    for (uint16_t i = 0; i < anim.count; i++) {
+        LEDPosition pos = _calibration.getPosition(spanLedIndex(anim, i));
         // Calculate distance from center
         float dist = sqrt(pos.x * pos.x + pos.y * pos.y + pos.z * pos.z);
         // Create expanding ring
-        float ring = sin(_animationPhase * 3.0f - dist * PI * 2.0f);
+        float ring = sin(anim.phase * 3.0f - dist * PI * 2.0f);
         uint8_t brightness = (uint8_t)max(0.0f, ring * 255.0f);
-        _leds[i] = _solidColor;
-        _leds[i].nscale8(brightness);
+        leds[i] = anim.color;
+        leds[i].nscale8(brightness);
     }
 }
 
-void LEDController::animateSpatialRotate() {
+void LEDController::animateSpatialRotate(AnimationInstance& anim) {
+    CRGB* leds = anim.buffer + anim.start;
     // Rotating beam around Y axis
-    for (int i = 0; i < NUM_LEDS; i++) {
-        LEDPosition pos = _calibration.getPosition(i);
+    for (uint16_t i = 0; i < anim.count; i++) {
+        LEDPosition pos = _calibration.getPosition(spanLedIndex(anim, i));
         // Calculate angle in XZ plane
         float angle = atan2(pos.z, pos.x);
         // Rotating beam
-        float beam = cos(angle - _animationPhase * 2.0f);
+        float beam = cos(angle - anim.phase * 2.0f);
         // Make beam narrower
         beam = pow(max(0.0f, beam), 4.0f);
         uint8_t brightness = (uint8_t)(beam * 255.0f);
-        _leds[i] = _solidColor;
-        _leds[i].nscale8(brightness);
+        leds[i] = anim.color;
+        leds[i].nscale8(brightness);
     }
 }
 
-void LEDController::animateSpatialPlanes() {
+void LEDController::animateSpatialPlanes(AnimationInstance& anim) {
+    CRGB* leds = anim.buffer + anim.start;
     // Alternating horizontal planes (based on Y position)
-    for (int i = 0; i < NUM_LEDS; i++) {
-        LEDPosition pos = _calibration.getPosition(i);
+    for (uint16_t i = 0; i < anim.count; i++) {
+        LEDPosition pos = _calibration.getPosition(spanLedIndex(anim, i));
         // Create horizontal bands that move up/down
-        float band = sin(pos.y * PI * 3.0f + _animationPhase * 4.0f);
+        float band = sin(pos.y * PI * 3.0f + anim.phase * 4.0f);
 
         // Determine color based on band position
         if (band > 0) {
-            _leds[i] = CRGB::Red;
-            _leds[i].nscale8((uint8_t)(band * 255.0f));
+            leds[i] = CRGB::Red;
+            leds[i].nscale8((uint8_t)(band * 255.0f));
+        } else {
+            leds[i] = CRGB::Green;
+            leds[i].nscale8((uint8_t)(-band * 255.0f));
+        }
+    }
+}
+
+// ============================================
+// Sweep Animation Implementations
+// These walk the cached calibration orderings, so each
+// frame is O(N) integer work with no per-pixel trig
+// ============================================
+
+// Position of strip index led within anim's span, or -1 if outside it
+static inline int32_t spanPixel(const AnimationInstance& anim, uint16_t led) {
+    if (led < anim.start || led >= anim.start + anim.count) {
+        return -1;
+    }
+    uint16_t k = led - anim.start;
+    return anim.reverse ? anim.count - 1 - k : k;
+}
+
+void LEDController::animateSweepWipe(AnimationInstance& anim) {
+    // Fill bottom to top, then clear bottom to top
+    CRGB* leds = anim.buffer + anim.start;
+    const uint16_t* order = _calibration.getOrder(SORT_BY_Y);
+    const uint32_t span = (uint32_t)anim.count * 256;  // Ranks in 8.8 fixed point
+    uint32_t progress = (uint32_t)(anim.phase / (2 * PI) * 2 * span);
+    bool filling = progress < span;
+    uint32_t edge = filling ? progress : progress - span;
+
+    // Ranks count only the LEDs inside the span
+    uint16_t r = 0;
+    for (uint16_t o = 0; o < NUM_LEDS; o++) {
+        int32_t k = spanPixel(anim, order[o]);
+        if (k < 0) continue;
+        uint32_t pos = (uint32_t)r++ * 256;
+        uint8_t level;
+        if (pos + 256 <= edge) {
+            level = 255;
+        } else if (pos >= edge) {
+            level = 0;
         } else {
-            _leds[i] = CRGB::Green;
-            _leds[i].nscale8((uint8_t)(-band * 255.0f));
+            level = edge - pos;  // Soft leading edge
+        }
+        if (!filling) {
+            level = 255 - level;
         }
+        leds[k] = anim.color;
+        leds[k].nscale8(level);
+    }
+}
+
+void LEDController::animateSweepRipple(AnimationInstance& anim) {
+    // Rings travel outward from the center: a triangle wave over radius rank
+    CRGB* leds = anim.buffer + anim.start;
+    const uint16_t* order = _calibration.getOrder(SORT_BY_RADIUS);
+    const uint8_t waves = 2;  // Rings visible at once
+    uint8_t offset = (uint8_t)(anim.phase / (2 * PI) * 256 * waves);
+
+    uint16_t r = 0;
+    for (uint16_t o = 0; o < NUM_LEDS; o++) {
+        int32_t k = spanPixel(anim, order[o]);
+        if (k < 0) continue;
+        uint8_t wave = (uint8_t)((uint32_t)r++ * 256 * waves / anim.count) - offset;
+        uint8_t level = ease8InOutQuad(triwave8(wave));
+        leds[k] = anim.color;
+        leds[k].nscale8(level);
+    }
+}
+
+void LEDController::animateSweepAngular(AnimationInstance& anim) {
+    // A comet sweeps around the Y axis with a fading tail
+    CRGB* leds = anim.buffer + anim.start;
+    const uint16_t* order = _calibration.getOrder(SORT_BY_ANGLE);
+    const int32_t span = (int32_t)anim.count * 256;
+    const int32_t tail = max(anim.count / 4, 1) * 256;
+    int32_t head = (int32_t)(anim.phase / (2 * PI) * span);
+
+    uint16_t r = 0;
+    for (uint16_t o = 0; o < NUM_LEDS; o++) {
+        int32_t k = spanPixel(anim, order[o]);
+        if (k < 0) continue;
+        int32_t behind = head - (int32_t)r++ * 256;
+        if (behind < 0) {
+            behind += span;
+        }
+        uint8_t level = behind < tail ? 255 - (behind * 255 / tail) : 0;
+        leds[k] = anim.color;
+        leds[k].nscale8(level);
+    }
+}
+
+// ============================================
+// Audio-Reactive Animation Implementations
+// Read the analyzer's latest snapshot; like the sweeps
+// they place LEDs by calibration rank
+// ============================================
+
+void LEDController::updateAudio() {
+    if (_audio) {
+        _audio->read(_audioSnapshot);  // Keeps the previous snapshot if the writer was busy
+    }
+    if (_audioSnapshot.beats != _audioBeats) {
+        _audioBeats = _audioSnapshot.beats;
+        _audioBeatTime = millis();
+    }
+}
+
+void LEDController::animateAudioSpectrum(AnimationInstance& anim) {
+    // Bass at the bottom of the tree, treble at the top
+    updateAudio();
+    CRGB* leds = anim.buffer + anim.start;
+    const uint16_t* order = _calibration.getOrder(SORT_BY_Y);
+    const uint32_t last = anim.count > 1 ? anim.count - 1 : 1;
+
+    uint16_t r = 0;
+    for (uint16_t o = 0; o < NUM_LEDS; o++) {
+        int32_t k = spanPixel(anim, order[o]);
+        if (k < 0) continue;
+        uint32_t pos = (uint32_t)r++ * (AUDIO_BANDS - 1) * 256 / last;  // Band in 8.8
+        uint8_t band = pos >> 8;
+        uint8_t next = band + 1 < AUDIO_BANDS ? band + 1 : band;
+        uint8_t level = lerp8by8(_audioSnapshot.bands[band], _audioSnapshot.bands[next], pos & 0xFF);
+        leds[k] = CHSV((uint8_t)(pos / AUDIO_BANDS), 255, level);
+    }
+}
+
+void LEDController::animateAudioBeat(AnimationInstance& anim) {
+    // Each beat sends a ring out from the centre; loudness keeps a dim glow
+    updateAudio();
+    CRGB* leds = anim.buffer + anim.start;
+    const uint16_t* order = _calibration.getOrder(SORT_BY_RADIUS);
+    const uint32_t last = anim.count > 1 ? anim.count - 1 : 1;
+    uint32_t age = millis() - _audioBeatTime;
+    bool pulsing = _audioBeats > 0 && age < AUDIO_PULSE_MS;
+    int16_t ring = pulsing ? age * 256 / AUDIO_PULSE_MS : 0;  // Radius rank, 0..255
+    uint8_t fade = 255 - ring;
+    uint8_t glow = _audioSnapshot.level / 4;
+
+    uint16_t r = 0;
+    for (uint16_t o = 0; o < NUM_LEDS; o++) {
+        int32_t k = spanPixel(anim, order[o]);
+        if (k < 0) continue;
+        int16_t radius = (uint32_t)r++ * 255 / last;
+        int16_t dist = abs(radius - ring);
+        uint8_t level = glow;
+        if (pulsing && dist < 64) {
+            level = max(level, scale8((uint8_t)((64 - dist) * 4 - 1), fade));
+        }
+        leds[k] = anim.color;
+        leds[k].nscale8(level);
+    }
+}
+
+// ============================================
+// Noise Animation Implementations
+// Simplex noise sampled at each LED's position; the
+// per-LED lattice work is redone only when calibration changes
+// ============================================
+
+void LEDController::animateNoise(AnimationInstance& anim, const CRGBPalette16& palette) {
+    uint32_t start = micros();
+    uint32_t revision = _calibration.getRevision();
+    if (!_noiseReady || _noiseRevision != revision) {
+        _noise.prepare(_calibration.getAllPositions(), NUM_LEDS, NOISE_SCALE);
+        _noiseRevision = revision;
+        _noiseReady = true;
+    }
+    // Free-running clock: the field never repeats, so these aren't frame-cached
+    uint32_t frame = anim.lastUpdate / max(anim.speed, (uint16_t)1);
+    _noise.setTime(frame * NOISE_FLOW_STEP);
+
+    CRGB* leds = anim.buffer + anim.start;
+    for (uint16_t i = 0; i < anim.count; i++) {
+        leds[i] = ColorFromPalette(palette, _noise.sample(spanLedIndex(anim, i)), 255, LINEARBLEND);
+    }
+    _noiseMicros = micros() - start;
+}
+
+// ============================================
+// Particle Animation Implementations
+// One shared pool; each animation draws the particles
+// of its own emitter onto the LEDs near them
+// ============================================
+
+void LEDController::animateParticles(AnimationInstance& anim, uint8_t emitter, uint8_t trail) {
+    uint32_t start = micros();
+    // Steps once per frame however many instances draw the pool
+    _particles.update(anim.lastUpdate);
+    _particles.splat(emitter, _calibration.getSpatialIndex(), _calibration.getAllPositions());
+
+    CRGB* leds = anim.buffer + anim.start;
+    pixelFade(leds, anim.count, trail);
+    for (uint16_t i = 0; i < anim.count; i++) {
+        const uint16_t* light = _particles.getLight(spanLedIndex(anim, i));
+        leds[i] += CRGB(min(light[0], (uint16_t)255), min(light[1], (uint16_t)255), min(light[2], (uint16_t)255));
     }
+    _particleMicros = micros() - start;
 }
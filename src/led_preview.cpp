@@ -0,0 +1,200 @@
+#include "led_preview.h"
+
+LEDPreview::LEDPreview(LEDController& ledController, Calibration& calibration)
+    : _ledController(ledController)
+    , _calibration(calibration)
+    , _canvas(nullptr)
+    , _buffer(nullptr)
+    , _mode(UI_PREVIEW_MODE)
+    , _lastUpdate(0)
+    , _lastUpdateMicros(0)
+    , _mappedRevision(0)
+    , _needsRebuild(true)
+    , _cellCount(0)
+    , _cols(0)
+    , _cellW(0)
+    , _cellH(0)
+    , _originX(0)
+    , _originY(0) {
+}
+
+lv_obj_t* LEDPreview::create(lv_obj_t* parent) {
+    // Canvas buffer in PSRAM - it is only read when the preview area is flushed
+    size_t bytes = PREVIEW_WIDTH * PREVIEW_HEIGHT * sizeof(lv_color_t);
+    _buffer = (lv_color_t*)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!_buffer) {
+        _buffer = (lv_color_t*)heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+    }
+    if (!_buffer) {
+        Serial.println("Failed to allocate LED preview buffer");
+        return nullptr;
+    }
+
+    _canvas = lv_canvas_create(parent);
+    lv_canvas_set_buffer(_canvas, _buffer, PREVIEW_WIDTH, PREVIEW_HEIGHT, LV_IMG_CF_TRUE_COLOR);
+    lv_canvas_fill_bg(_canvas, lv_color_black(), LV_OPA_COVER);
+    lv_obj_clear_flag(_canvas, LV_OBJ_FLAG_CLICKABLE);
+    _needsRebuild = true;
+    return _canvas;
+}
+
+void LEDPreview::setMode(uint8_t mode) {
+    if (mode != _mode) {
+        _mode = mode;
+        _needsRebuild = true;
+    }
+}
+
+void LEDPreview::update() {
+    if (!_canvas) {
+        return;
+    }
+
+    unsigned long now = millis();
+    if (now - _lastUpdate < UI_PREVIEW_INTERVAL) {
+        return;
+    }
+    _lastUpdate = now;
+
+    uint32_t start = micros();
+
+    bool fullRedraw = false;
+    if (_needsRebuild || _mappedRevision != _calibration.getRevision()) {
+        rebuildLayout();
+        fullRedraw = true;
+    }
+
+    // Collapse LEDs into cells (per-channel max so single sparkles stay visible)
+    memset(_accum, 0, _cellCount * sizeof(CRGB));
+    const CRGB* leds = _ledController.getLeds();
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        CRGB& cell = _accum[_ledCell[i]];
+        const CRGB& led = leds[i];
+        if (led.r > cell.r) cell.r = led.r;
+        if (led.g > cell.g) cell.g = led.g;
+        if (led.b > cell.b) cell.b = led.b;
+    }
+
+    if (fullRedraw) {
+        lv_canvas_fill_bg(_canvas, lv_color_black(), LV_OPA_COVER);
+        for (uint16_t c = 0; c < _cellCount; c++) {
+            drawCell(c, _accum[c]);
+            _cells[c] = _accum[c];
+        }
+        lv_obj_invalidate(_canvas);
+        _lastUpdateMicros = micros() - start;
+        return;
+    }
+
+    // Redraw changed cells, merging horizontal runs into as few areas as possible
+    lv_area_t canvasCoords;
+    lv_obj_get_coords(_canvas, &canvasCoords);
+
+    lv_area_t runs[PREVIEW_MAX_INVALIDATIONS];
+    uint8_t runCount = 0;
+    bool overflow = false;
+    lv_area_t bounds = {0, 0, 0, 0};
+    bool anyDirty = false;
+
+    for (uint16_t c = 0; c < _cellCount; c++) {
+        if (_accum[c] == _cells[c]) {
+            continue;
+        }
+        _cells[c] = _accum[c];
+        drawCell(c, _accum[c]);
+
+        lv_area_t area;
+        getCellArea(c, &area);
+        lv_area_move(&area, canvasCoords.x1, canvasCoords.y1);
+
+        if (!anyDirty) {
+            bounds = area;
+            anyDirty = true;
+        } else {
+            _lv_area_join(&bounds, &bounds, &area);
+        }
+
+        if (overflow) {
+            continue;
+        }
+        // Extend the previous run if this cell sits right after it on the same row
+        if (runCount > 0 && runs[runCount - 1].y1 == area.y1 && runs[runCount - 1].x2 + 1 >= area.x1) {
+            runs[runCount - 1].x2 = area.x2;
+        } else if (runCount < PREVIEW_MAX_INVALIDATIONS) {
+            runs[runCount++] = area;
+        } else {
+            overflow = true;
+        }
+    }
+
+    if (anyDirty) {
+        if (overflow) {
+            lv_obj_invalidate_area(_canvas, &bounds);
+        } else {
+            for (uint8_t r = 0; r < runCount; r++) {
+                lv_obj_invalidate_area(_canvas, &runs[r]);
+            }
+        }
+        _lastUpdateMicros = micros() - start;
+    }
+}
+
+void LEDPreview::rebuildLayout() {
+    if (_mode == PREVIEW_SPATIAL) {
+        // Project calibrated X/Y onto a grid of square cells (Y up)
+        _cellW = PREVIEW_SPATIAL_CELL;
+        _cellH = PREVIEW_SPATIAL_CELL;
+        _cols = PREVIEW_WIDTH / _cellW;
+        uint16_t rows = PREVIEW_HEIGHT / _cellH;
+        _cellCount = _cols * rows;
+
+        for (uint16_t i = 0; i < NUM_LEDS; i++) {
+            LEDPosition pos = _calibration.getPosition(i);
+            int col = lroundf((pos.x + 1.0f) * 0.5f * (_cols - 1));
+            int row = lroundf((1.0f - pos.y) * 0.5f * (rows - 1));
+            col = constrain(col, 0, _cols - 1);
+            row = constrain(row, 0, rows - 1);
+            _ledCell[i] = row * _cols + col;
+        }
+    } else {
+        // Strip order, several LEDs per cell when they don't fit
+        _cellCount = min(NUM_LEDS, PREVIEW_WIDTH / PREVIEW_MIN_CELL_WIDTH);
+        _cols = _cellCount;
+        _cellW = PREVIEW_WIDTH / _cellCount;
+        _cellH = PREVIEW_HEIGHT;
+
+        for (uint16_t i = 0; i < NUM_LEDS; i++) {
+            _ledCell[i] = (uint32_t)i * _cellCount / NUM_LEDS;
+        }
+    }
+
+    _originX = (PREVIEW_WIDTH - _cellW * _cols) / 2;
+    _originY = (PREVIEW_HEIGHT - _cellH * (_cellCount / _cols)) / 2;
+    _mappedRevision = _calibration.getRevision();
+    _needsRebuild = false;
+}
+
+void LEDPreview::getCellArea(uint16_t cell, lv_area_t* area) const {
+    area->x1 = _originX + (cell % _cols) * _cellW;
+    area->y1 = _originY + (cell / _cols) * _cellH;
+    area->x2 = area->x1 + _cellW - 1;
+    area->y2 = area->y1 + _cellH - 1;
+}
+
+void LEDPreview::drawCell(uint16_t cell, CRGB color) {
+    lv_area_t area;
+    getCellArea(cell, &area);
+
+    // Leave a 1px gap between strip cells when there is room for it
+    if (_mode == PREVIEW_STRIP && _cellW >= 3) {
+        area.x2--;
+    }
+
+    lv_color_t c = lv_color_make(color.r, color.g, color.b);
+    for (lv_coord_t y = area.y1; y <= area.y2; y++) {
+        lv_color_t* row = _buffer + y * PREVIEW_WIDTH;
+        for (lv_coord_t x = area.x1; x <= area.x2; x++) {
+            row[x] = c;
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#include "lv_mem_psram.h"
+
+#include <esp_heap_caps.h>
+#include <esp_idf_version.h>
+#if ESP_IDF_VERSION_MAJOR >= 5
+#include <esp_memory_utils.h>
+#else
+#include <soc/soc_memory_layout.h>
+#endif
+
+// Running totals of what LVGL holds in each heap
+static size_t usedExternal = 0;
+static size_t usedInternal = 0;
+
+static void trackAlloc(void* ptr) {
+    if (!ptr) return;
+    size_t size = heap_caps_get_allocated_size(ptr);
+    if (esp_ptr_external_ram(ptr)) {
+        usedExternal += size;
+    } else {
+        usedInternal += size;
+    }
+}
+
+static void trackFree(void* ptr) {
+    if (!ptr) return;
+    size_t size = heap_caps_get_allocated_size(ptr);
+    if (esp_ptr_external_ram(ptr)) {
+        usedExternal -= size;
+    } else {
+        usedInternal -= size;
+    }
+}
+
+extern "C" void* lv_mem_psram_alloc(size_t size) {
+    // Prefer PSRAM, fall back to internal RAM if PSRAM is missing or full
+    void* ptr = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!ptr) {
+        ptr = heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    trackAlloc(ptr);
+    return ptr;
+}
+
+extern "C" void* lv_mem_psram_realloc(void* ptr, size_t size) {
+    if (!ptr) {
+        return lv_mem_psram_alloc(size);
+    }
+
+    trackFree(ptr);
+    void* newPtr = heap_caps_realloc(ptr, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!newPtr) {
+        newPtr = heap_caps_realloc(ptr, size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    // On failure the original block is still valid and still ours
+    trackAlloc(newPtr ? newPtr : ptr);
+    return newPtr;
+}
+
+extern "C" void lv_mem_psram_free(void* ptr) {
+    trackFree(ptr);
+    heap_caps_free(ptr);
+}
+
+extern "C" size_t lv_mem_psram_used_external(void) {
+    return usedExternal;
+}
+
+extern "C" size_t lv_mem_psram_used_internal(void) {
+    return usedInternal;
+}
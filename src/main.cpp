@@ -6,10 +6,40 @@
 #include "led_controller.h"
 #include "wifi_manager.h"
 #include "web_server.h"
+#include "segment_store.h"
+#include "show_clock.h"
+#include "show_scheduler.h"
+#include "schedule_store.h"
+#include "preset_store.h"
+#include "sequence_player.h"
+#include "audio_input.h"
 
 // Global instances
 Calibration calibration;
 LEDController ledController(calibration);
+SegmentStore segmentStore(ledController, calibration);
+PresetStore presetStore(ledController);
+SequencePlayer sequencePlayer(ledController, calibration);
+AudioAnalyzer audioAnalyzer;
+AudioInput audioInput(audioAnalyzer);
+SystemClock showClock;
+
+// Scheduled scene changes go through the same controls as the UI
+static void applyScene(const Scene* scene, void* context) {
+    if (!scene) {
+        ledController.setOn(false);
+        return;
+    }
+    // One visible change, like a preset recall
+    ledController.beginBatch();
+    ledController.setAnimationSpeed(scene->speed);
+    ledController.setBrightness(scene->brightness);
+    ledController.setAnimation(static_cast<AnimationMode>(scene->mode), CRGB(scene->color));
+    ledController.setOn(true);
+    ledController.endBatch();
+}
+
+ShowScheduler scheduler(showClock, applyScene, nullptr);
 WiFiManager wifiManager;
 WebServer* webServer = nullptr;
 
@@ -44,15 +74,22 @@ void setup() {
     // Initialize LED controller
     Serial.println("Initializing LEDs...");
     ledController.begin();
+    segmentStore.begin();
+    presetStore.begin();
+    sequencePlayer.begin();
+    ledController.setAudioAnalyzer(&audioAnalyzer);
+    audioInput.begin();
+    showClock.begin();
+    ScheduleStore::load(scheduler, calibration.isSDAvailable());
 
     // Startup animation
     for (int i = 0; i < NUM_LEDS; i++) {
         ledController.setPixelColor(i, CRGB::Green);
-        FastLED.show();
+        ledController.show();
         delay(10);
     }
-    FastLED.clear();
-    FastLED.show();
+    ledController.clear();
+    ledController.show();
 
     // Initialize WiFi (non-blocking)
     Serial.println("Initializing WiFi...");
@@ -60,10 +97,16 @@ void setup() {
 
     // Create UI after display is ready
     Serial.println("Creating UI...");
-    displayUI = new DisplayUI(ledController, calibration, wifiManager);
+    displayUI = new DisplayUI(ledController, calibration, wifiManager, presetStore);
     displayUI->begin();
     Serial.println("UI created");
 
+#if RUN_BENCHMARKS
+    display.runBenchmark();
+    OutputStage::runBenchmark();
+    pixelKernelsBenchmark();
+#endif
+
     // Wait for WiFi connection
     Serial.print("Connecting to WiFi");
     int wifiAttempts = 0;
@@ -81,7 +124,7 @@ void setup() {
 
     // Initialize web server
     Serial.println("Initializing web server...");
-    webServer = new WebServer(ledController, calibration);
+    webServer = new WebServer(ledController, calibration, scheduler, showClock, presetStore, sequencePlayer, audioInput);
     webServer->begin();
 
     // Display connection info
@@ -111,15 +154,32 @@ void loop() {
     wifiManager.update();
 
     // Update display and UI (~60fps target)
+    // While dimmed or off the display throttles itself and UI polling stops
     if (now - lastUIUpdate >= UI_UPDATE_INTERVAL) {
         display.update();
-        displayUI->update();
+        if (display.isActive()) {
+            displayUI->update();
+        }
         lastUIUpdate = now;
     }
 
+    // Scene changes land on the frame rendered right after them
+    if (wifiManager.isConnected()) {
+        showClock.startNtp();
+    }
+    scheduler.update();
+    presetStore.update();
+    sequencePlayer.update();
+
     // Update LED animations (independent timing)
     ledController.update();
 
+    // Push state changes to web clients
+    webServer->update();
+
+    // Write segment edits once they settle
+    segmentStore.update();
+
     // Small delay to prevent watchdog issues
     delay(1);
 }
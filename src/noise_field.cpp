@@ -0,0 +1,139 @@
+#include "noise_field.h"
+#include <math.h>
+
+static_assert((NOISE_GRADIENTS & (NOISE_GRADIENTS - 1)) == 0 && NOISE_GRADIENTS <= 256,
+              "NOISE_GRADIENTS must be a power of two up to 256");
+
+static const float SKEW = 1.0f / 3.0f;
+static const float UNSKEW = 1.0f / 6.0f;
+static const float OUTPUT_GAIN = 48.0f;       // Sum of corners to roughly -1..1
+static const float OCTAVE_OFFSET = 19.37f;    // Keeps octaves from sharing a lattice origin
+static const float TWO_PI_F = 6.28318531f;
+
+// Lattice point to gradient slot; any well-mixed hash will do
+static inline uint8_t latticeHash(int32_t i, int32_t j, int32_t k, uint8_t octave) {
+    uint32_t h = (uint32_t)i * 0x8DA6B343u ^ (uint32_t)j * 0xD8163841u ^
+                 (uint32_t)k * 0xCB1AB31Fu ^ (uint32_t)octave * 0x9E3779B9u;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    return (uint8_t)(h >> 24) & (NOISE_GRADIENTS - 1);
+}
+
+static inline int16_t toQ14(float v) {
+    float q = v * 16384.0f;
+    q += q < 0 ? -0.5f : 0.5f;
+    return (int16_t)(q > 32767.0f ? 32767 : (q < -32767.0f ? -32767 : q));
+}
+
+NoiseField::NoiseField() : _count(0) {
+    // Fixed seed: the same field on every boot
+    uint32_t seed = 0x1234567u;
+    auto next = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return (float)(seed >> 8) / 16777216.0f * 2.0f - 1.0f;  // -1..1
+    };
+
+    for (uint16_t g = 0; g < NOISE_GRADIENTS; g++) {
+        // Random rotation axis, and a unit vector perpendicular to it
+        float a[3], v[3], len;
+        do {
+            a[0] = next(); a[1] = next(); a[2] = next();
+            len = a[0] * a[0] + a[1] * a[1] + a[2] * a[2];
+        } while (len < 0.01f || len > 1.0f);
+        len = sqrtf(len);
+        for (uint8_t c = 0; c < 3; c++) a[c] /= len;
+        do {
+            v[0] = next(); v[1] = next(); v[2] = next();
+            float along = v[0] * a[0] + v[1] * a[1] + v[2] * a[2];
+            for (uint8_t c = 0; c < 3; c++) v[c] -= along * a[c];
+            len = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+        } while (len < 0.01f);
+        len = sqrtf(len);
+        for (uint8_t c = 0; c < 3; c++) _base[g][c] = v[c] / len;
+        _perp[g][0] = a[1] * _base[g][2] - a[2] * _base[g][1];
+        _perp[g][1] = a[2] * _base[g][0] - a[0] * _base[g][2];
+        _perp[g][2] = a[0] * _base[g][1] - a[1] * _base[g][0];
+        // 1x to 3x the base rate, so the field doesn't visibly repeat
+        _rate[g] = 256 + (uint16_t)((next() + 1.0f) * 256.0f);
+    }
+    setTime(0);
+}
+
+void NoiseField::setTime(uint32_t t) {
+    for (uint16_t g = 0; g < NOISE_GRADIENTS; g++) {
+        uint16_t turn = (uint16_t)(((uint64_t)t * _rate[g]) >> 8);
+        float angle = turn * (TWO_PI_F / 65536.0f);
+        float c = cosf(angle);
+        float s = sinf(angle);
+        for (uint8_t k = 0; k < 3; k++) {
+            _gradients[g][k] = toQ14(_base[g][k] * c + _perp[g][k] * s);
+        }
+    }
+}
+
+void NoiseField::setupCorners(float x, float y, float z, float scale, Corner* out) {
+    float amplitudeSum = 0;
+    for (uint8_t o = 0; o < NOISE_OCTAVES; o++) {
+        amplitudeSum += 1.0f / (1 << o);
+    }
+
+    for (uint8_t o = 0; o < NOISE_OCTAVES; o++) {
+        float freq = scale * (1 << o);
+        float px = x * freq + o * OCTAVE_OFFSET;
+        float py = y * freq + o * OCTAVE_OFFSET;
+        float pz = z * freq + o * OCTAVE_OFFSET;
+
+        // Skew into the simplex lattice and find the containing cell
+        float s = (px + py + pz) * SKEW;
+        int32_t i = (int32_t)floorf(px + s);
+        int32_t j = (int32_t)floorf(py + s);
+        int32_t k = (int32_t)floorf(pz + s);
+        float t = (i + j + k) * UNSKEW;
+        float x0 = px - (i - t);
+        float y0 = py - (j - t);
+        float z0 = pz - (k - t);
+
+        // Which of the six tetrahedra: the middle two corners
+        uint8_t i1, j1, k1, i2, j2, k2;
+        if (x0 >= y0) {
+            if (y0 >= z0)      { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+            else if (x0 >= z0) { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 0; k2 = 1; }
+            else               { i1 = 0; j1 = 0; k1 = 1; i2 = 1; j2 = 0; k2 = 1; }
+        } else {
+            if (y0 < z0)       { i1 = 0; j1 = 0; k1 = 1; i2 = 0; j2 = 1; k2 = 1; }
+            else if (x0 < z0)  { i1 = 0; j1 = 1; k1 = 0; i2 = 0; j2 = 1; k2 = 1; }
+            else               { i1 = 0; j1 = 1; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+        }
+        const uint8_t ci[4] = { 0, i1, i2, 1 };
+        const uint8_t cj[4] = { 0, j1, j2, 1 };
+        const uint8_t ck[4] = { 0, k1, k2, 1 };
+
+        float amplitude = OUTPUT_GAIN * (1.0f / (1 << o)) / amplitudeSum;
+        for (uint8_t n = 0; n < 4; n++) {
+            float dx = x0 - ci[n] + n * UNSKEW;
+            float dy = y0 - cj[n] + n * UNSKEW;
+            float dz = z0 - ck[n] + n * UNSKEW;
+            float falloff = 0.6f - dx * dx - dy * dy - dz * dz;
+            float w = falloff > 0 ? falloff * falloff * falloff * falloff * amplitude : 0;
+            Corner& c = out[o * 4 + n];
+            c.dx = toQ14(w * dx);
+            c.dy = toQ14(w * dy);
+            c.dz = toQ14(w * dz);
+            c.gradient = latticeHash(i + ci[n], j + cj[n], k + ck[n], o);
+        }
+    }
+}
+
+void NoiseField::prepare(const LEDPosition* positions, uint16_t count, float scale) {
+    _count = count < NUM_LEDS ? count : NUM_LEDS;
+    for (uint16_t i = 0; i < _count; i++) {
+        setupCorners(positions[i].x, positions[i].y, positions[i].z, scale, _corners[i]);
+    }
+}
+
+uint8_t NoiseField::sampleAt(const LEDPosition& position, float scale) const {
+    Corner corners[NOISE_OCTAVES * 4];
+    setupCorners(position.x, position.y, position.z, scale, corners);
+    return blend(corners);
+}
@@ -0,0 +1,307 @@
+#include "output_stage.h"
+
+OutputStage::OutputStage()
+    : _brightness(DEFAULT_BRIGHTNESS)
+    , _dither(OUTPUT_DITHER)
+    , _mapping((OutputMapping)OUTPUT_MAPPING)
+    , _renderRange(nullptr)
+    , _lutDirty(true)
+    , _lastRenderMicros(0)
+    , _outputCount(0) {
+    setPowerOutputCount(1);
+    _gamma[0] = OUTPUT_GAMMA_R;
+    _gamma[1] = OUTPUT_GAMMA_G;
+    _gamma[2] = OUTPUT_GAMMA_B;
+    _correction = CRGB(OUTPUT_COLOR_CORRECTION);
+    memset(_output, 0, sizeof(_output));
+    memset(_residual, 0, sizeof(_residual));
+    selectRenderer();
+}
+
+void OutputStage::setBrightness(uint8_t brightness) {
+    if (brightness != _brightness) {
+        _brightness = brightness;
+        _lutDirty = true;
+    }
+}
+
+void OutputStage::setGamma(float r, float g, float b) {
+    if (r != _gamma[0] || g != _gamma[1] || b != _gamma[2]) {
+        _gamma[0] = r;
+        _gamma[1] = g;
+        _gamma[2] = b;
+        _lutDirty = true;
+    }
+}
+
+void OutputStage::setColorCorrection(CRGB correction) {
+    if (correction != _correction) {
+        _correction = correction;
+        _lutDirty = true;
+    }
+}
+
+void OutputStage::setDithering(bool enabled) {
+    if (enabled != _dither) {
+        _dither = enabled;
+        memset(_residual, 0, sizeof(_residual));
+        selectRenderer();
+    }
+}
+
+void OutputStage::setMapping(OutputMapping mapping) {
+    if (mapping < OUTPUT_MAP_COUNT && mapping != _mapping) {
+        _mapping = mapping;
+        memset(_residual, 0, sizeof(_residual));
+        selectRenderer();
+    }
+}
+
+void OutputStage::selectRenderer() {
+    static const RangeRenderer renderers[2][OUTPUT_MAP_COUNT] = {
+        { &OutputStage::renderRange<false, OUTPUT_MAP_NORMAL>,
+          &OutputStage::renderRange<false, OUTPUT_MAP_REVERSE>,
+          &OutputStage::renderRange<false, OUTPUT_MAP_MIRROR> },
+        { &OutputStage::renderRange<true, OUTPUT_MAP_NORMAL>,
+          &OutputStage::renderRange<true, OUTPUT_MAP_REVERSE>,
+          &OutputStage::renderRange<true, OUTPUT_MAP_MIRROR> },
+    };
+    _renderRange = renderers[_dither ? 1 : 0][_mapping];
+}
+
+void OutputStage::rebuildLut() {
+    // Top of the range is 255.0 in 8.8, so integer part + carry never exceeds 255
+    for (uint8_t c = 0; c < 3; c++) {
+        const float top = 255.0f * 256.0f * (_brightness / 255.0f) * (_correction.raw[c] / 255.0f);
+        for (uint16_t i = 0; i < 256; i++) {
+            _lut[c][i] = (uint16_t)(powf(i / 255.0f, _gamma[c]) * top + 0.5f);
+        }
+    }
+    _lutDirty = false;
+}
+
+void OutputStage::setPowerOutputCount(uint8_t count) {
+    count = constrain(count, 1, POWER_MAX_OUTPUTS);
+    // Split the strip into equal consecutive ranges, each on its own budget
+    for (uint8_t o = 0; o < count; o++) {
+        uint16_t start = (uint32_t)NUM_LEDS * o / count;
+        uint16_t end = (uint32_t)NUM_LEDS * (o + 1) / count;
+        setPowerOutput(o, start, end - start, POWER_BUDGET_MA);
+    }
+    _outputCount = count;
+}
+
+bool OutputStage::setPowerOutput(uint8_t output, uint16_t start, uint16_t count, uint32_t budgetMa) {
+    if (output >= POWER_MAX_OUTPUTS || start + count > NUM_LEDS) {
+        return false;
+    }
+    PowerOutput& o = _outputs[output];
+    o.start = start;
+    o.count = count;
+    o.budgetMa = budgetMa;
+    o.requestedMa = 0;
+    o.drawnMa = 0;
+    o.scale = 256;
+    if (output >= _outputCount) {
+        _outputCount = output + 1;
+    }
+    return true;
+}
+
+void OutputStage::render(const CRGB* frame) {
+    uint32_t start = micros();
+
+    if (_lutDirty) {
+        rebuildLut();
+    }
+
+    for (uint8_t o = 0; o < _outputCount; o++) {
+        (this->*_renderRange)(frame, _outputs[o]);
+    }
+
+    _lastRenderMicros = micros() - start;
+}
+
+// Frame pixel shown at output position i
+template <uint8_t MAPPING>
+static inline uint16_t sourceIndex(uint16_t i) {
+    if (MAPPING == OUTPUT_MAP_REVERSE) {
+        return NUM_LEDS - 1 - i;
+    }
+    if (MAPPING == OUTPUT_MAP_MIRROR) {
+        return i < (NUM_LEDS + 1) / 2 ? i : NUM_LEDS - 1 - i;
+    }
+    return i;
+}
+
+template <bool DITHER, uint8_t MAPPING>
+void OutputStage::renderRange(const CRGB* frame, PowerOutput& output) {
+    const uint16_t* lutR = _lut[0];
+    const uint16_t* lutG = _lut[1];
+    const uint16_t* lutB = _lut[2];
+    const uint32_t scale = output.scale;
+    const uint16_t end = output.start + output.count;
+    uint32_t demand = 0;  // LUT values before limiting (8.8)
+    uint32_t drawn = 0;   // Channel values actually emitted
+
+    for (uint16_t i = output.start; i < end; i++) {
+        const CRGB& in = frame[sourceIndex<MAPPING>(i)];
+        uint16_t lr = lutR[in.r];
+        uint16_t lg = lutG[in.g];
+        uint16_t lb = lutB[in.b];
+        demand += lr + lg + lb;
+
+        uint16_t r = (lr * scale) >> 8;
+        uint16_t g = (lg * scale) >> 8;
+        uint16_t b = (lb * scale) >> 8;
+        if (DITHER) {
+            uint8_t* carry = _residual[i];
+            r += carry[0];
+            g += carry[1];
+            b += carry[2];
+            carry[0] = r & 0xFF;
+            carry[1] = g & 0xFF;
+            carry[2] = b & 0xFF;
+        } else {
+            r += 0x80;
+            g += 0x80;
+            b += 0x80;
+        }
+        _output[i].r = r >> 8;
+        _output[i].g = g >> 8;
+        _output[i].b = b >> 8;
+        drawn += _output[i].r + _output[i].g + _output[i].b;
+    }
+
+    uint32_t idle = (uint32_t)output.count * LED_IDLE_MA;
+    output.drawnMa = drawn * LED_MA_PER_CHANNEL / 255 + idle;
+    output.requestedMa = (uint32_t)((uint64_t)demand * LED_MA_PER_CHANNEL / (255 * 256)) + idle;
+    updateLimiter(output, idle);
+}
+
+// Scale (of 256) that brings the requested current within budgetMa
+static uint16_t fitScale(uint32_t requestedMa, uint32_t idleMa, uint32_t budgetMa) {
+    if (requestedMa <= budgetMa) {
+        return 256;
+    }
+    uint32_t allowed = budgetMa > idleMa ? budgetMa - idleMa : 0;
+    return (uint16_t)(allowed * 256 / (requestedMa - idleMa));
+}
+
+void OutputStage::updateLimiter(PowerOutput& output, uint32_t idleMa) {
+    if (output.budgetMa == 0) {
+        output.scale = 256;
+        return;
+    }
+
+    // Clamp down at once to protect the supply, but only ease back up once
+    // the frame would fit a slightly smaller budget, so it doesn't hunt
+    uint16_t attack = fitScale(output.requestedMa, idleMa, output.budgetMa);
+    uint16_t release = fitScale(output.requestedMa, idleMa,
+                                output.budgetMa * (256 - POWER_LIMIT_HYSTERESIS) / 256);
+
+    if (attack < output.scale) {
+        output.scale = attack;
+    } else if (release > output.scale) {
+        output.scale += max((release - output.scale) / POWER_LIMIT_RELEASE, 1);
+    }
+}
+
+uint32_t OutputStage::getEstimatedMilliamps() const {
+    uint32_t total = 0;
+    for (uint8_t o = 0; o < _outputCount; o++) {
+        total += _outputs[o].drawnMa;
+    }
+    return total;
+}
+
+bool OutputStage::isLimiting() const {
+    for (uint8_t o = 0; o < _outputCount; o++) {
+        if (_outputs[o].scale < 256) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void OutputStage::runBenchmark() {
+    OutputStage* stage = new OutputStage();
+    CRGB* frame = new CRGB[NUM_LEDS];
+    CRGB* work = new CRGB[NUM_LEDS];
+    CRGB* out = new CRGB[NUM_LEDS];
+
+    const uint8_t brightness = 200;
+    const CRGB correction(255, 176, 240);
+    const uint8_t limit = 230;
+
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        frame[i] = CHSV(i * 7, 200, 255);
+    }
+
+    // 8-bit gamma tables for the staged version
+    static uint8_t gamma8[3][256];
+    for (uint8_t c = 0; c < 3; c++) {
+        for (uint16_t i = 0; i < 256; i++) {
+            gamma8[c][i] = (uint8_t)(powf(i / 255.0f, stage->_gamma[c]) * 255.0f + 0.5f);
+        }
+    }
+
+    Serial.printf("Output stage benchmark (%d LEDs, %d frames):\n", NUM_LEDS, OUTPUT_BENCHMARK_FRAMES);
+
+    // Each stage as its own pass over the buffer
+    uint32_t start = micros();
+    for (int f = 0; f < OUTPUT_BENCHMARK_FRAMES; f++) {
+        memcpy(work, frame, NUM_LEDS * sizeof(CRGB));
+        for (uint16_t i = 0; i < NUM_LEDS; i++) {
+            work[i].nscale8(brightness);
+        }
+        for (uint16_t i = 0; i < NUM_LEDS; i++) {
+            work[i].r = scale8(work[i].r, correction.r);
+            work[i].g = scale8(work[i].g, correction.g);
+            work[i].b = scale8(work[i].b, correction.b);
+        }
+        for (uint16_t i = 0; i < NUM_LEDS; i++) {
+            work[i].r = gamma8[0][work[i].r];
+            work[i].g = gamma8[1][work[i].g];
+            work[i].b = gamma8[2][work[i].b];
+        }
+        for (uint16_t i = 0; i < NUM_LEDS; i++) {
+            work[i].nscale8(limit);
+        }
+        for (uint16_t i = 0; i < NUM_LEDS; i++) {
+            out[NUM_LEDS - 1 - i] = work[i];
+        }
+    }
+    uint32_t staged = micros() - start;
+
+    // Same stages fused, with and without dithering (the limiter runs on its default budget)
+    stage->setBrightness(brightness);
+    stage->setColorCorrection(correction);
+    stage->setMapping(OUTPUT_MAP_REVERSE);
+
+    uint32_t fused[2];
+    for (uint8_t d = 0; d < 2; d++) {
+        stage->setDithering(d == 1);
+        stage->render(frame);  // LUT rebuild outside the timed loop
+        start = micros();
+        for (int f = 0; f < OUTPUT_BENCHMARK_FRAMES; f++) {
+            stage->render(frame);
+        }
+        fused[d] = micros() - start;
+    }
+
+    uint32_t checksum = 0;
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        checksum += out[i].r + stage->_output[i].r;
+    }
+
+    Serial.printf("  staged (5 passes)   %6lu us/frame\n", (unsigned long)(staged / OUTPUT_BENCHMARK_FRAMES));
+    Serial.printf("  fused               %6lu us/frame\n", (unsigned long)(fused[0] / OUTPUT_BENCHMARK_FRAMES));
+    Serial.printf("  fused + dithering   %6lu us/frame  (checksum %lu)\n",
+                  (unsigned long)(fused[1] / OUTPUT_BENCHMARK_FRAMES), (unsigned long)checksum);
+
+    delete[] frame;
+    delete[] work;
+    delete[] out;
+    delete stage;
+}
@@ -0,0 +1,281 @@
+#include "particle_system.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef ARDUINO
+#include <esp_heap_caps.h>
+#endif
+
+static const float BOUND = 1.2f;  // Particles this far outside the tree are gone
+static const float RADIUS_SQ = PARTICLE_RADIUS * PARTICLE_RADIUS;
+
+static_assert(PARTICLE_EMITTERS == 3, "one default per emitter");
+static const ParticleEmitter DEFAULT_EMITTERS[PARTICLE_EMITTERS] = {
+    // Snow: drifts down from the top at about 0.2 units/s, fluttering
+    { PARTICLE_SHAPE_TOP, 25.0f, 1, 0.18f, 0.05f, -0.05f, 0.3f, 0.4f, 15000, 0, 255, 255, 255, false },
+    // Fireworks: bursts of 80 sparks that slow, droop and fade
+    { PARTICLE_SHAPE_BURST, 0.7f, 80, 0.6f, 0.15f, -0.5f, 1.2f, 0.0f, 1800, 1200, 255, 255, 255, true },
+    // Embers: rise from the bottom, wandering, and cool as they go
+    { PARTICLE_SHAPE_BOTTOM, 12.0f, 1, 0.35f, 0.15f, 0.1f, 0.5f, 0.8f, 4000, 2500, 255, 90, 10, false }
+};
+
+ParticleSystem::ParticleSystem()
+    : _block(nullptr)
+    , _capacity(0)
+    , _count(0)
+    , _now(0)
+    , _started(false)
+    , _random(0x2545F491u) {
+    memset(_light, 0, sizeof(_light));
+    for (uint8_t e = 0; e < PARTICLE_EMITTERS; e++) {
+        _emitters[e] = DEFAULT_EMITTERS[e];
+        _carry[e] = 0;
+        _lastSplat[e] = 0;
+        _splatted[e] = false;
+    }
+}
+
+ParticleSystem::~ParticleSystem() {
+#ifdef ARDUINO
+    heap_caps_free(_block);
+#else
+    free(_block);
+#endif
+}
+
+bool ParticleSystem::begin(uint16_t capacity) {
+    if (_block) {
+        return _capacity == capacity;
+    }
+    size_t bytes = (size_t)capacity * (6 * sizeof(float) + sizeof(uint16_t) + 4);
+#ifdef ARDUINO
+    _block = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+#else
+    _block = malloc(bytes);
+#endif
+    if (!_block) {
+        _capacity = 0;
+        return false;
+    }
+
+    // Widest types first so every array stays aligned
+    float* f = (float*)_block;
+    _x = f;
+    _y = f + capacity;
+    _z = f + 2 * capacity;
+    _vx = f + 3 * capacity;
+    _vy = f + 4 * capacity;
+    _vz = f + 5 * capacity;
+    _life = (uint16_t*)(f + 6 * capacity);
+    uint8_t* bytesStart = (uint8_t*)(_life + capacity);
+    _r = bytesStart;
+    _g = bytesStart + capacity;
+    _b = bytesStart + 2 * capacity;
+    _emitter = bytesStart + 3 * capacity;
+    _capacity = capacity;
+    _count = 0;
+    return true;
+}
+
+void ParticleSystem::setEmitter(uint8_t index, const ParticleEmitter& emitter) {
+    if (index < PARTICLE_EMITTERS) {
+        _emitters[index] = emitter;
+    }
+}
+
+void ParticleSystem::resetEmitter(uint8_t index) {
+    if (index < PARTICLE_EMITTERS) {
+        _emitters[index] = DEFAULT_EMITTERS[index];
+    }
+}
+
+float ParticleSystem::randomUnit() {
+    // xorshift32: cheap, and the same sequence on the device and the host
+    _random ^= _random << 13;
+    _random ^= _random >> 17;
+    _random ^= _random << 5;
+    return (float)(_random >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+void ParticleSystem::hueToRgb(uint8_t hue, uint8_t& r, uint8_t& g, uint8_t& b) {
+    // Fully saturated hue wheel in six linear segments
+    uint8_t segment = hue / 43;
+    uint8_t rise = (uint8_t)((hue - segment * 43) * 6);
+    uint8_t fall = 255 - rise;
+    switch (segment) {
+        case 0:  r = 255;  g = rise; b = 0;    break;
+        case 1:  r = fall; g = 255;  b = 0;    break;
+        case 2:  r = 0;    g = 255;  b = rise; break;
+        case 3:  r = 0;    g = fall; b = 255;  break;
+        case 4:  r = rise; g = 0;    b = 255;  break;
+        default: r = 255;  g = 0;    b = fall; break;
+    }
+}
+
+bool ParticleSystem::spawn(uint8_t emitter, float x, float y, float z, float vx, float vy, float vz,
+                           uint8_t r, uint8_t g, uint8_t b) {
+    if (_count >= _capacity) {
+        return false;
+    }
+    uint16_t i = _count++;
+    _x[i] = x;
+    _y[i] = y;
+    _z[i] = z;
+    _vx[i] = vx;
+    _vy[i] = vy;
+    _vz[i] = vz;
+    _life[i] = _emitters[emitter].lifeMs;
+    _r[i] = r;
+    _g[i] = g;
+    _b[i] = b;
+    _emitter[i] = emitter;
+    return true;
+}
+
+void ParticleSystem::emit(uint8_t emitter, float dt) {
+    const ParticleEmitter& em = _emitters[emitter];
+    if (em.rate <= 0 || em.lifeMs == 0) {
+        return;
+    }
+    _carry[emitter] += em.rate * dt;
+
+    while (_carry[emitter] >= 1.0f) {
+        _carry[emitter] -= 1.0f;
+        uint8_t r = em.r, g = em.g, b = em.b;
+        if (em.randomHue) {
+            hueToRgb((uint8_t)((randomUnit() + 1.0f) * 127.99f), r, g, b);
+        }
+
+        bool room = true;
+        if (em.shape == PARTICLE_SHAPE_BURST) {
+            float cx = 0.6f * randomUnit();
+            float cy = 0.3f + 0.5f * randomUnit();
+            float cz = 0.6f * randomUnit();
+            for (uint16_t n = 0; n < em.burst && room; n++) {
+                // Uniform direction: a point in the unit ball, pushed to its surface
+                float dx, dy, dz, len;
+                do {
+                    dx = randomUnit();
+                    dy = randomUnit();
+                    dz = randomUnit();
+                    len = dx * dx + dy * dy + dz * dz;
+                } while (len > 1.0f || len < 0.01f);
+                float s = (em.speed + em.spread * randomUnit()) / sqrtf(len);
+                room = spawn(emitter, cx, cy, cz, dx * s, dy * s, dz * s, r, g, b);
+            }
+        } else {
+            bool top = em.shape == PARTICLE_SHAPE_TOP;
+            float drift = 0.5f * em.spread;
+            float s = em.speed + em.spread * randomUnit();
+            room = spawn(emitter, randomUnit(), top ? 1.0f : -1.0f, randomUnit(),
+                         drift * randomUnit(), top ? -s : s, drift * randomUnit(), r, g, b);
+        }
+        if (!room) {
+            _carry[emitter] = 0;  // Pool full: drop what's owed rather than bunching it up
+            break;
+        }
+    }
+}
+
+void ParticleSystem::update(uint32_t nowMs) {
+    if (!_started) {
+        _started = true;
+        _now = nowMs;
+        return;
+    }
+    int32_t elapsed = (int32_t)(nowMs - _now);
+    if (elapsed <= 0) {
+        return;
+    }
+    _now = nowMs;
+    uint16_t stepMs = elapsed > PARTICLE_MAX_STEP_MS ? PARTICLE_MAX_STEP_MS : (uint16_t)elapsed;
+    float dt = stepMs * 0.001f;
+
+    // Semi-implicit Euler: velocity first, then position with the new velocity
+    uint16_t i = 0;
+    while (i < _count) {
+        bool alive = _life[i] > stepMs;
+        if (alive) {
+            const ParticleEmitter& em = _emitters[_emitter[i]];
+            float keep = 1.0f - em.drag * dt;
+            if (keep < 0) keep = 0;
+            float kick = em.jitter * dt;
+            _vx[i] = (_vx[i] + kick * randomUnit()) * keep;
+            _vy[i] = (_vy[i] + em.gravity * dt + kick * randomUnit()) * keep;
+            _vz[i] = (_vz[i] + kick * randomUnit()) * keep;
+            _x[i] += _vx[i] * dt;
+            _y[i] += _vy[i] * dt;
+            _z[i] += _vz[i] * dt;
+            _life[i] -= stepMs;
+            alive = fabsf(_x[i]) <= BOUND && fabsf(_y[i]) <= BOUND && fabsf(_z[i]) <= BOUND;
+        }
+        if (alive) {
+            i++;
+            continue;
+        }
+
+        // Keep the pool packed: the last live particle takes this slot
+        _count--;
+        if (i != _count) {
+            _x[i] = _x[_count];
+            _y[i] = _y[_count];
+            _z[i] = _z[_count];
+            _vx[i] = _vx[_count];
+            _vy[i] = _vy[_count];
+            _vz[i] = _vz[_count];
+            _life[i] = _life[_count];
+            _r[i] = _r[_count];
+            _g[i] = _g[_count];
+            _b[i] = _b[_count];
+            _emitter[i] = _emitter[_count];
+        }
+    }
+
+    for (uint8_t e = 0; e < PARTICLE_EMITTERS; e++) {
+        if (_splatted[e] && _now - _lastSplat[e] < PARTICLE_IDLE_MS) {
+            emit(e, dt);
+        } else {
+            _carry[e] = 0;
+        }
+    }
+}
+
+void ParticleSystem::splat(uint8_t emitter, const SpatialIndex& index, const LEDPosition* positions) {
+    memset(_light, 0, sizeof(_light));
+    if (emitter >= PARTICLE_EMITTERS) {
+        return;
+    }
+    _splatted[emitter] = true;
+    _lastSplat[emitter] = _now;
+    const uint16_t fadeMs = _emitters[emitter].fadeMs;
+
+    for (uint16_t i = 0; i < _count; i++) {
+        if (_emitter[i] != emitter) continue;
+        // Brightness 0..256 from the fade-out at the end of life
+        uint32_t brightness = (fadeMs == 0 || _life[i] >= fadeMs) ? 256 : (uint32_t)_life[i] * 256 / fadeMs;
+        if (brightness == 0) continue;
+
+        const float px = _x[i], py = _y[i], pz = _z[i];
+        const uint8_t r = _r[i], g = _g[i], b = _b[i];
+        LEDPosition lo = { px - PARTICLE_RADIUS, py - PARTICLE_RADIUS, pz - PARTICLE_RADIUS };
+        LEDPosition hi = { px + PARTICLE_RADIUS, py + PARTICLE_RADIUS, pz + PARTICLE_RADIUS };
+        index.forEachSpan(lo, hi, [&](const uint16_t* leds, uint16_t n) {
+            for (uint16_t k = 0; k < n; k++) {
+                uint16_t led = leds[k];
+                float dx = positions[led].x - px;
+                float dy = positions[led].y - py;
+                float dz = positions[led].z - pz;
+                float d = (dx * dx + dy * dy + dz * dz) * (1.0f / RADIUS_SQ);
+                if (d >= 1.0f) continue;
+                // Smooth falloff: (1 - d^2/r^2)^2, scaled to 0..256
+                float w = 1.0f - d;
+                uint32_t scale = (uint32_t)(w * w * brightness);
+                uint16_t* light = _light[led];
+                uint32_t v;
+                v = light[0] + ((r * scale) >> 8); light[0] = v > 0xFFFF ? 0xFFFF : v;
+                v = light[1] + ((g * scale) >> 8); light[1] = v > 0xFFFF ? 0xFFFF : v;
+                v = light[2] + ((b * scale) >> 8); light[2] = v > 0xFFFF ? 0xFFFF : v;
+            }
+        });
+    }
+}
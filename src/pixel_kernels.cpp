@@ -0,0 +1,435 @@
+#include "pixel_kernels.h"
+
+#if PIXEL_KERNELS_SIMD && defined(CONFIG_IDF_TARGET_ESP32S3)
+#define PIXEL_HAVE_PIE 1
+#elif defined(PIXEL_KERNELS_EMULATE_PIE)
+#define PIXEL_HAVE_PIE 1  // C++ models of the instructions (tools/pixel_tool)
+#else
+#define PIXEL_HAVE_PIE 0
+#endif
+
+static bool usePie = PIXEL_HAVE_PIE;
+
+// ============================================
+// Scalar kernels (these define the results)
+// ============================================
+
+static void mulScalar(uint8_t* p, size_t n, uint8_t m) {
+    for (size_t i = 0; i < n; i++) {
+        p[i] = (p[i] * m) >> 8;
+    }
+}
+
+static void addScalar(uint8_t* d, const uint8_t* s, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        uint16_t v = d[i] + s[i];
+        d[i] = v > 255 ? 255 : v;
+    }
+}
+
+// wd + ws = 256, so the sum of the truncated terms never exceeds 255
+static void blendScalar(uint8_t* d, const uint8_t* s, size_t n, uint8_t wd, uint8_t ws) {
+    for (size_t i = 0; i < n; i++) {
+        d[i] = ((d[i] * wd) >> 8) + ((s[i] * ws) >> 8);
+    }
+}
+
+// Byte k of the buffer (counting from the first pixel) gets rgb[k % 3]
+static void fillScalar(uint8_t* d, size_t n, const uint8_t* rgb, size_t offset) {
+    uint8_t c = offset % 3;
+    for (size_t i = 0; i < n; i++) {
+        d[i] = rgb[c];
+        c = (c == 2) ? 0 : c + 1;
+    }
+}
+
+// ============================================
+// PIE kernels: whole 16-byte blocks at 16-byte aligned addresses
+// ============================================
+
+#if PIXEL_HAVE_PIE && defined(PIXEL_KERNELS_EMULATE_PIE)
+
+// Lane-by-lane models of the blocks below, so the dispatch around them can
+// be checked on a computer. Like EE.VLD.128 / EE.VST.128 they ignore the
+// low four address bits: a misaligned pointer gives wrong bytes, as it
+// would on the device.
+
+static inline uint8_t* pieBlock(const uint8_t* p) {
+    return (uint8_t*)((uintptr_t)p & ~(uintptr_t)15);
+}
+
+static void mulPie(uint8_t* p, uint32_t blocks, uint8_t m) {
+    for (; blocks; blocks--, p += 16) {
+        uint8_t* q = pieBlock(p);
+        for (uint8_t k = 0; k < 16; k++) {
+            q[k] = (q[k] * m) >> 8;
+        }
+    }
+}
+
+static void addPie(uint8_t* d, const uint8_t* s, uint32_t blocks) {
+    for (; blocks; blocks--, d += 16, s += 16) {
+        uint8_t* qd = pieBlock(d);
+        const uint8_t* qs = pieBlock(s);
+        for (uint8_t k = 0; k < 16; k++) {
+            uint16_t v = qd[k] + qs[k];
+            qd[k] = v > 255 ? 255 : v;
+        }
+    }
+}
+
+static void blendPie(uint8_t* d, const uint8_t* s, uint32_t blocks, uint8_t wd, uint8_t ws) {
+    for (; blocks; blocks--, d += 16, s += 16) {
+        uint8_t* qd = pieBlock(d);
+        const uint8_t* qs = pieBlock(s);
+        for (uint8_t k = 0; k < 16; k++) {
+            uint16_t v = ((qd[k] * wd) >> 8) + ((qs[k] * ws) >> 8);
+            qd[k] = v > 255 ? 255 : v;
+        }
+    }
+}
+
+static void fillPie(uint8_t* d, uint32_t groups, const uint8_t* pattern) {
+    const uint8_t* q = pieBlock(pattern);
+    for (; groups; groups--, d += 48) {
+        memcpy(pieBlock(d), q, 16);
+        memcpy(pieBlock(d + 16), q + 16, 16);
+        memcpy(pieBlock(d + 32), q + 32, 16);
+    }
+}
+
+#elif PIXEL_HAVE_PIE
+
+// The compiler doesn't track the Q registers or SAR, so each block saves the
+// ones it uses on entry and puts them back before it returns
+
+// EE.VMUL.U8 keeps (x * y) >> SAR, so SAR = 8 gives x * m / 256
+static void mulPie(uint8_t* p, uint32_t blocks, uint8_t m) {
+    uint8_t mul = m;
+    PIXEL_ALIGN uint8_t saved[2 * 16];
+    uint8_t* save = saved;
+    uint32_t sar;
+    asm volatile(
+        "rsr.sar %[sar]\n"
+        "ee.vst.128.ip q0, %[save], 16\n"
+        "ee.vst.128.ip q1, %[save], 16\n"
+        "ssai 8\n"
+        "ee.vldbc.8 q1, %[m]\n"
+        "1:\n"
+        "ee.vld.128.ip q0, %[p], 0\n"
+        "ee.vmul.u8 q0, q0, q1\n"
+        "ee.vst.128.ip q0, %[p], 16\n"
+        "addi %[n], %[n], -1\n"
+        "bnez %[n], 1b\n"
+        "addi %[save], %[save], -32\n"
+        "ee.vld.128.ip q0, %[save], 16\n"
+        "ee.vld.128.ip q1, %[save], 16\n"
+        "wsr.sar %[sar]\n"
+        : [p] "+r"(p), [n] "+r"(blocks), [save] "+r"(save), [sar] "=&r"(sar)
+        : [m] "r"(&mul)
+        : "memory");
+}
+
+static void addPie(uint8_t* d, const uint8_t* s, uint32_t blocks) {
+    PIXEL_ALIGN uint8_t saved[2 * 16];
+    uint8_t* save = saved;
+    asm volatile(
+        "ee.vst.128.ip q0, %[save], 16\n"
+        "ee.vst.128.ip q1, %[save], 16\n"
+        "1:\n"
+        "ee.vld.128.ip q0, %[d], 0\n"
+        "ee.vld.128.ip q1, %[s], 16\n"
+        "ee.vadds.u8 q0, q0, q1\n"
+        "ee.vst.128.ip q0, %[d], 16\n"
+        "addi %[n], %[n], -1\n"
+        "bnez %[n], 1b\n"
+        "addi %[save], %[save], -32\n"
+        "ee.vld.128.ip q0, %[save], 16\n"
+        "ee.vld.128.ip q1, %[save], 16\n"
+        : [d] "+r"(d), [s] "+r"(s), [n] "+r"(blocks), [save] "+r"(save)
+        :
+        : "memory");
+}
+
+static void blendPie(uint8_t* d, const uint8_t* s, uint32_t blocks, uint8_t wd, uint8_t ws) {
+    uint8_t weights[2] = { wd, ws };
+    const uint8_t* weightD = &weights[0];
+    const uint8_t* weightS = &weights[1];
+    PIXEL_ALIGN uint8_t saved[4 * 16];
+    uint8_t* save = saved;
+    uint32_t sar;
+    asm volatile(
+        "rsr.sar %[sar]\n"
+        "ee.vst.128.ip q0, %[save], 16\n"
+        "ee.vst.128.ip q1, %[save], 16\n"
+        "ee.vst.128.ip q2, %[save], 16\n"
+        "ee.vst.128.ip q3, %[save], 16\n"
+        "ssai 8\n"
+        "ee.vldbc.8 q2, %[wd]\n"
+        "ee.vldbc.8 q3, %[ws]\n"
+        "1:\n"
+        "ee.vld.128.ip q0, %[d], 0\n"
+        "ee.vld.128.ip q1, %[s], 16\n"
+        "ee.vmul.u8 q0, q0, q2\n"
+        "ee.vmul.u8 q1, q1, q3\n"
+        "ee.vadds.u8 q0, q0, q1\n"
+        "ee.vst.128.ip q0, %[d], 16\n"
+        "addi %[n], %[n], -1\n"
+        "bnez %[n], 1b\n"
+        "addi %[save], %[save], -64\n"
+        "ee.vld.128.ip q0, %[save], 16\n"
+        "ee.vld.128.ip q1, %[save], 16\n"
+        "ee.vld.128.ip q2, %[save], 16\n"
+        "ee.vld.128.ip q3, %[save], 16\n"
+        "wsr.sar %[sar]\n"
+        : [d] "+r"(d), [s] "+r"(s), [n] "+r"(blocks), [save] "+r"(save), [sar] "=&r"(sar)
+        : [wd] "r"(weightD), [ws] "r"(weightS)
+        : "memory");
+}
+
+// pattern: 48 aligned bytes (16 pixels), stored in groups of three blocks
+static void fillPie(uint8_t* d, uint32_t groups, const uint8_t* pattern) {
+    PIXEL_ALIGN uint8_t saved[3 * 16];
+    uint8_t* save = saved;
+    asm volatile(
+        "ee.vst.128.ip q0, %[save], 16\n"
+        "ee.vst.128.ip q1, %[save], 16\n"
+        "ee.vst.128.ip q2, %[save], 16\n"
+        "ee.vld.128.ip q0, %[pat], 16\n"
+        "ee.vld.128.ip q1, %[pat], 16\n"
+        "ee.vld.128.ip q2, %[pat], 16\n"
+        "1:\n"
+        "ee.vst.128.ip q0, %[d], 16\n"
+        "ee.vst.128.ip q1, %[d], 16\n"
+        "ee.vst.128.ip q2, %[d], 16\n"
+        "addi %[n], %[n], -1\n"
+        "bnez %[n], 1b\n"
+        "addi %[save], %[save], -48\n"
+        "ee.vld.128.ip q0, %[save], 16\n"
+        "ee.vld.128.ip q1, %[save], 16\n"
+        "ee.vld.128.ip q2, %[save], 16\n"
+        : [d] "+r"(d), [pat] "+r"(pattern), [n] "+r"(groups), [save] "+r"(save)
+        :
+        : "memory");
+}
+
+#endif // PIXEL_HAVE_PIE
+
+// ============================================
+// Dispatch: scalar head up to 16-byte alignment, vector body, scalar tail
+// ============================================
+
+static inline size_t headBytes(const void* p, size_t n) {
+    size_t head = (16 - ((uintptr_t)p & 15)) & 15;
+    return head < n ? head : n;
+}
+
+static void mulBytes(uint8_t* p, size_t n, uint8_t m, bool simd) {
+#if PIXEL_HAVE_PIE
+    if (simd) {
+        size_t head = headBytes(p, n);
+        mulScalar(p, head, m);
+        p += head;
+        n -= head;
+        uint32_t blocks = n / 16;
+        if (blocks) {
+            mulPie(p, blocks, m);
+            p += blocks * 16;
+            n -= blocks * 16;
+        }
+    }
+#endif
+    mulScalar(p, n, m);
+}
+
+static void addBytes(uint8_t* d, const uint8_t* s, size_t n, bool simd) {
+#if PIXEL_HAVE_PIE
+    // Both buffers must reach alignment at the same point
+    if (simd && (((uintptr_t)d ^ (uintptr_t)s) & 15) == 0) {
+        size_t head = headBytes(d, n);
+        addScalar(d, s, head);
+        d += head;
+        s += head;
+        n -= head;
+        uint32_t blocks = n / 16;
+        if (blocks) {
+            addPie(d, s, blocks);
+            d += blocks * 16;
+            s += blocks * 16;
+            n -= blocks * 16;
+        }
+    }
+#endif
+    addScalar(d, s, n);
+}
+
+static void blendBytes(uint8_t* d, const uint8_t* s, size_t n, uint8_t wd, uint8_t ws, bool simd) {
+#if PIXEL_HAVE_PIE
+    if (simd && (((uintptr_t)d ^ (uintptr_t)s) & 15) == 0) {
+        size_t head = headBytes(d, n);
+        blendScalar(d, s, head, wd, ws);
+        d += head;
+        s += head;
+        n -= head;
+        uint32_t blocks = n / 16;
+        if (blocks) {
+            blendPie(d, s, blocks, wd, ws);
+            d += blocks * 16;
+            s += blocks * 16;
+            n -= blocks * 16;
+        }
+    }
+#endif
+    blendScalar(d, s, n, wd, ws);
+}
+
+static void fillBytes(uint8_t* d, size_t n, const uint8_t* rgb, bool simd) {
+    size_t offset = 0;
+#if PIXEL_HAVE_PIE
+    if (simd) {
+        size_t head = headBytes(d, n);
+        fillScalar(d, head, rgb, 0);
+        offset = head;
+
+        // 48 bytes = 16 whole pixels, so the pattern repeats block-aligned
+        uint32_t groups = (n - head) / 48;
+        if (groups) {
+            PIXEL_ALIGN uint8_t pattern[48];
+            fillScalar(pattern, sizeof(pattern), rgb, offset);
+            fillPie(d + offset, groups, pattern);
+            offset += groups * 48;
+        }
+    }
+#endif
+    fillScalar(d + offset, n - offset, rgb, offset);
+}
+
+// ============================================
+// Public API
+// ============================================
+
+void pixelScale(CRGB* leds, uint16_t count, uint8_t scale) {
+    if (scale == 255) {
+        return;
+    }
+    mulBytes((uint8_t*)leds, count * 3, scale + 1, usePie);
+}
+
+void pixelFade(CRGB* leds, uint16_t count, uint8_t amount) {
+    if (amount == 0) {
+        return;
+    }
+    mulBytes((uint8_t*)leds, count * 3, 256 - amount, usePie);
+}
+
+void pixelAddSaturate(CRGB* dst, const CRGB* src, uint16_t count) {
+    addBytes((uint8_t*)dst, (const uint8_t*)src, count * 3, usePie);
+}
+
+void pixelBlend(CRGB* dst, const CRGB* src, uint16_t count, uint8_t amount) {
+    if (amount == 0) {
+        return;
+    }
+    blendBytes((uint8_t*)dst, (const uint8_t*)src, count * 3, 256 - amount, amount, usePie);
+}
+
+void pixelFill(CRGB* leds, uint16_t count, CRGB color) {
+    fillBytes((uint8_t*)leds, count * 3, color.raw, usePie);
+}
+
+bool pixelKernelsUsingSimd() {
+    return usePie;
+}
+
+void pixelKernelsSetSimd(bool enabled) {
+    usePie = PIXEL_HAVE_PIE && enabled;
+}
+
+// ============================================
+// Self-check and benchmark
+// ============================================
+
+// 16-byte aligned scratch buffer carved out of a larger allocation
+struct AlignedBuffer {
+    uint8_t* raw;
+    uint8_t* data;
+    explicit AlignedBuffer(size_t bytes) {
+        raw = new uint8_t[bytes + 15];
+        data = (uint8_t*)(((uintptr_t)raw + 15) & ~(uintptr_t)15);
+    }
+    ~AlignedBuffer() { delete[] raw; }
+};
+
+static void fillPseudoRandom(uint8_t* p, size_t n, uint32_t seed) {
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1664525UL + 1013904223UL;
+        p[i] = seed >> 24;
+    }
+}
+
+bool pixelKernelsBegin() {
+#if PIXEL_HAVE_PIE
+    // Odd lengths and a misaligned start exercise the head, body and tail paths
+    const size_t bytes = 3 * 83;
+    AlignedBuffer a(bytes + 16), b(bytes + 16), src(bytes + 16);
+    const uint8_t rgb[3] = { 0x12, 0xA5, 0xFE };
+    bool ok = true;
+
+    for (size_t shift = 0; shift < 16 && ok; shift += 3) {
+        uint8_t* pa = a.data + shift;
+        uint8_t* pb = b.data + shift;
+        uint8_t* ps = src.data + shift;
+        fillPseudoRandom(ps, bytes, 7 + shift);
+
+        for (int test = 0; test < 5 && ok; test++) {
+            fillPseudoRandom(pa, bytes, 42 + test);
+            memcpy(pb, pa, bytes);
+            switch (test) {
+                case 0: mulBytes(pa, bytes, 200, true); mulBytes(pb, bytes, 200, false); break;
+                case 1: mulBytes(pa, bytes, 1, true); mulBytes(pb, bytes, 1, false); break;
+                case 2: addBytes(pa, ps, bytes, true); addBytes(pb, ps, bytes, false); break;
+                case 3: blendBytes(pa, ps, bytes, 256 - 77, 77, true); blendBytes(pb, ps, bytes, 256 - 77, 77, false); break;
+                case 4: fillBytes(pa, bytes, rgb, true); fillBytes(pb, bytes, rgb, false); break;
+            }
+            if (memcmp(pa, pb, bytes) != 0) {
+                Serial.printf("Pixel kernels: SIMD mismatch (test %d, offset %u), using scalar\n", test, (unsigned)shift);
+                ok = false;
+            }
+        }
+    }
+    usePie = ok;
+#endif
+    Serial.printf("Pixel kernels: %s\n", usePie ? "PIE SIMD" : "scalar");
+    return usePie;
+}
+
+void pixelKernelsBenchmark() {
+    const size_t bytes = PIXEL_BENCHMARK_PIXELS * 3;
+    AlignedBuffer a(bytes), b(bytes);
+    fillPseudoRandom(a.data, bytes, 1);
+    fillPseudoRandom(b.data, bytes, 2);
+    const uint8_t rgb[3] = { 255, 128, 0 };
+    const char* names[] = { "scale", "add", "blend", "fill" };
+
+    Serial.printf("Pixel kernel benchmark (%d pixels, %d rounds):\n", PIXEL_BENCHMARK_PIXELS, PIXEL_BENCHMARK_ROUNDS);
+    for (int k = 0; k < 4; k++) {
+        uint32_t elapsed[2];
+        for (int simd = 0; simd < 2; simd++) {
+            uint32_t start = micros();
+            for (int r = 0; r < PIXEL_BENCHMARK_ROUNDS; r++) {
+                switch (k) {
+                    case 0: mulBytes(a.data, bytes, 250, simd && usePie); break;
+                    case 1: addBytes(a.data, b.data, bytes, simd && usePie); break;
+                    case 2: blendBytes(a.data, b.data, bytes, 128, 128, simd && usePie); break;
+                    case 3: fillBytes(a.data, bytes, rgb, simd && usePie); break;
+                }
+            }
+            elapsed[simd] = micros() - start;
+        }
+        // Bytes per microsecond = MB/s
+        Serial.printf("  %-6s scalar %6.1f MB/s   %s %6.1f MB/s\n", names[k],
+                      (float)bytes * PIXEL_BENCHMARK_ROUNDS / max(elapsed[0], (uint32_t)1),
+                      usePie ? "PIE" : "(scalar)",
+                      (float)bytes * PIXEL_BENCHMARK_ROUNDS / max(elapsed[1], (uint32_t)1));
+    }
+}
@@ -0,0 +1,179 @@
+#include "preset_store.h"
+#include <Preferences.h>
+
+static const char* PRESET_NAMESPACE = "presets";
+
+static void presetKey(uint8_t index, char* key) {
+    snprintf(key, 4, "p%u", index);
+}
+
+static void packColor(CRGB color, uint8_t* out) {
+    out[0] = color.r;
+    out[1] = color.g;
+    out[2] = color.b;
+}
+
+PresetStore::PresetStore(LEDController& ledController)
+    : _ledController(ledController)
+    , _pendingRecall(-1) {
+    memset(_presets, 0, sizeof(_presets));
+}
+
+void PresetStore::begin() {
+    Preferences prefs;
+    if (!prefs.begin(PRESET_NAMESPACE, true)) {
+        return;  // Nothing saved yet
+    }
+    uint8_t loaded = 0;
+    for (uint8_t i = 0; i < MAX_PRESETS; i++) {
+        char key[4];
+        presetKey(i, key);
+        PresetRecord record;
+        // Records from another firmware layout are ignored rather than misread
+        if (prefs.getBytesLength(key) == sizeof(record) &&
+            prefs.getBytes(key, &record, sizeof(record)) == sizeof(record) &&
+            record.version == PRESET_RECORD_VERSION) {
+            record.name[PRESET_NAME_LENGTH - 1] = '\0';
+            _presets[i] = record;
+            loaded++;
+        }
+    }
+    prefs.end();
+    Serial.printf("Loaded %u presets (%u bytes each)\n", loaded, sizeof(PresetRecord));
+}
+
+void PresetStore::update() {
+    int8_t index = _pendingRecall.exchange(-1);
+    if (index >= 0 && isUsed(index)) {
+        apply(_presets[index]);
+    }
+}
+
+bool PresetStore::save(uint8_t index, const char* name) {
+    if (index >= MAX_PRESETS) {
+        return false;
+    }
+    PresetRecord& record = _presets[index];
+    capture(record);
+    strlcpy(record.name, name ? name : "", sizeof(record.name));
+    return persist(index);
+}
+
+bool PresetStore::remove(uint8_t index) {
+    if (index >= MAX_PRESETS) {
+        return false;
+    }
+    memset(&_presets[index], 0, sizeof(PresetRecord));
+
+    Preferences prefs;
+    if (!prefs.begin(PRESET_NAMESPACE, false)) {
+        return false;
+    }
+    char key[4];
+    presetKey(index, key);
+    prefs.remove(key);
+    prefs.end();
+    return true;
+}
+
+bool PresetStore::recall(uint8_t index) {
+    if (!isUsed(index)) {
+        return false;
+    }
+    _pendingRecall = index;
+    return true;
+}
+
+bool PresetStore::persist(uint8_t index) {
+    Preferences prefs;
+    if (!prefs.begin(PRESET_NAMESPACE, false)) {
+        Serial.println("Failed to open preset storage");
+        return false;
+    }
+    char key[4];
+    presetKey(index, key);
+    size_t written = prefs.putBytes(key, &_presets[index], sizeof(PresetRecord));
+    prefs.end();
+    return written == sizeof(PresetRecord);
+}
+
+void PresetStore::capture(PresetRecord& record) {
+    memset(&record, 0, sizeof(record));
+    record.version = PRESET_RECORD_VERSION;
+    record.flags = PRESET_FLAG_USED | (_ledController.isOn() ? PRESET_FLAG_ON : 0);
+    record.mode = _ledController.getAnimation();
+    packColor(_ledController.getSolidColor(), record.color);
+    record.speed = _ledController.getAnimationSpeed();
+    record.brightness = _ledController.getBrightness();
+
+    for (uint8_t i = 0; i < MAX_SEGMENTS; i++) {
+        const Segment& segment = _ledController.getSegment(i);
+        PresetSegment& out = record.segments[i];
+        if (!segment.enabled) continue;
+        memcpy(out.name, segment.name, sizeof(out.name));
+        out.start = segment.anim.start;
+        out.count = segment.anim.count;
+        out.flags = PRESET_FLAG_ENABLED | (segment.anim.reverse ? PRESET_FLAG_REVERSE : 0);
+        out.mode = segment.anim.mode;
+        packColor(segment.anim.color, out.color);
+        out.speed = segment.anim.speed;
+    }
+
+    for (uint8_t l = 0; l < OVERLAY_LAYERS; l++) {
+        const Layer& layer = _ledController.getLayer(l);
+        PresetLayer& out = record.layers[l];
+        if (!layer.enabled) continue;
+        out.flags = PRESET_FLAG_ENABLED;
+        out.mode = layer.anim.mode;
+        out.opacity = layer.opacity;
+        out.blend = layer.blend;
+        packColor(layer.anim.color, out.color);
+        out.speed = layer.anim.speed;
+    }
+}
+
+void PresetStore::apply(const PresetRecord& record) {
+    // One batch, so the strip goes straight from the old state to the new
+    _ledController.beginBatch();
+
+    // Segments go first: clearing them all frees their buffer before any are set
+    for (uint8_t i = 0; i < MAX_SEGMENTS; i++) {
+        _ledController.clearSegment(i);
+    }
+    for (uint8_t i = 0; i < MAX_SEGMENTS; i++) {
+        const PresetSegment& seg = record.segments[i];
+        if (!(seg.flags & PRESET_FLAG_ENABLED)) continue;
+        char name[SEGMENT_NAME_LENGTH];
+        memcpy(name, seg.name, sizeof(name));
+        name[SEGMENT_NAME_LENGTH - 1] = '\0';
+        _ledController.setSegment(i, name, seg.start, seg.count, seg.flags & PRESET_FLAG_REVERSE,
+                                  static_cast<AnimationMode>(seg.mode),
+                                  CRGB(seg.color[0], seg.color[1], seg.color[2]), seg.speed);
+    }
+
+    for (uint8_t l = 0; l < OVERLAY_LAYERS; l++) {
+        const PresetLayer& layer = record.layers[l];
+        if (layer.flags & PRESET_FLAG_ENABLED) {
+            _ledController.setLayer(l, static_cast<AnimationMode>(layer.mode),
+                                    CRGB(layer.color[0], layer.color[1], layer.color[2]), layer.speed,
+                                    layer.opacity, static_cast<BlendMode>(layer.blend));
+        } else {
+            _ledController.clearLayer(l);
+        }
+    }
+
+    _ledController.setBrightness(record.brightness);
+    _ledController.setAnimationSpeed(record.speed);
+    // No crossfade: segments and layers switch at once, so the base animation
+    // does too, and the recall lands in one frame
+    uint16_t transitionMs = _ledController.getTransitionDuration();
+    uint8_t transitionType = _ledController.getTransitionType();
+    SortOrder transitionAxis = _ledController.getTransitionAxis();
+    _ledController.setTransition(0, transitionType, transitionAxis);
+    _ledController.setAnimation(static_cast<AnimationMode>(record.mode),
+                                CRGB(record.color[0], record.color[1], record.color[2]));
+    _ledController.setTransition(transitionMs, transitionType, transitionAxis);
+    _ledController.setOn(record.flags & PRESET_FLAG_ON);
+
+    _ledController.endBatch();
+}
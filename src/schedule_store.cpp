@@ -0,0 +1,171 @@
+#include "schedule_store.h"
+#include <SD.h>
+
+static void formatMinute(uint16_t minute, char* buf, size_t size) {
+    snprintf(buf, size, "%02u:%02u", minute / 60, minute % 60);
+}
+
+// "HH:MM", or minutes after midnight as a number
+static bool parseMinute(JsonVariantConst value, uint16_t& minute) {
+    if (value.is<uint16_t>()) {
+        minute = value.as<uint16_t>();
+        return minute < 24 * 60;
+    }
+    const char* text = value.as<const char*>();
+    unsigned hours, minutes;
+    if (!text || sscanf(text, "%u:%u", &hours, &minutes) != 2 || hours > 23 || minutes > 59) {
+        return false;
+    }
+    minute = hours * 60 + minutes;
+    return true;
+}
+
+void ScheduleStore::toJson(ShowScheduler& scheduler, JsonObject out) {
+    ScheduleConfig config;
+    scheduler.getConfig(config);
+    out["enabled"] = config.enabled;
+
+    JsonArray scenes = out["scenes"].to<JsonArray>();
+    for (uint8_t i = 0; i < config.sceneCount; i++) {
+        const Scene& scene = config.scenes[i];
+        JsonObject s = scenes.add<JsonObject>();
+        char color[8];
+        snprintf(color, sizeof(color), "#%06lx", (unsigned long)scene.color);
+        s["mode"] = scene.mode;
+        s["color"] = color;
+        s["speed"] = scene.speed;
+        s["brightness"] = scene.brightness;
+        s["duration"] = scene.durationMs;
+    }
+
+    JsonArray rules = out["rules"].to<JsonArray>();
+    for (uint8_t i = 0; i < SCHEDULE_MAX_RULES; i++) {
+        const ScheduleRule& rule = config.rules[i];
+        if (!rule.enabled) continue;
+        JsonObject r = rules.add<JsonObject>();
+        char time[6];
+        formatMinute(rule.startMinute, time, sizeof(time));
+        r["start"] = time;
+        formatMinute(rule.endMinute, time, sizeof(time));
+        r["end"] = time;
+        r["days"] = rule.days;
+        r["scene"] = rule.scene;
+    }
+
+    JsonObject status = out["status"].to<JsonObject>();
+    status["scene"] = scheduler.getActiveScene();
+    status["rule"] = scheduler.getActiveRule();
+    status["remainingMs"] = scheduler.getSceneRemaining();
+}
+
+bool ScheduleStore::fromJson(JsonObjectConst in, ScheduleConfig& config) {
+    // Everything is parsed into a copy; config is only written once it all checks out
+    ScheduleConfig parsed = config;
+
+    if (in["scenes"].is<JsonArrayConst>()) {
+        JsonArrayConst list = in["scenes"];
+        if (list.size() > SCHEDULE_MAX_SCENES) {
+            return false;
+        }
+        parsed.sceneCount = 0;
+        for (JsonObjectConst s : list) {
+            Scene& scene = parsed.scenes[parsed.sceneCount++];
+            scene.mode = s["mode"] | 0;
+            const char* color = s["color"] | "#ffffff";
+            scene.color = strtoul(color[0] == '#' ? color + 1 : color, nullptr, 16) & 0xFFFFFF;
+            scene.speed = s["speed"] | DEFAULT_ANIMATION_SPEED;
+            scene.brightness = s["brightness"] | DEFAULT_BRIGHTNESS;
+            scene.durationMs = s["duration"] | 60000UL;
+        }
+    }
+
+    if (in["rules"].is<JsonArrayConst>()) {
+        JsonArrayConst list = in["rules"];
+        if (list.size() > SCHEDULE_MAX_RULES) {
+            return false;
+        }
+        memset(parsed.rules, 0, sizeof(parsed.rules));
+        uint8_t index = 0;
+        for (JsonObjectConst r : list) {
+            ScheduleRule& rule = parsed.rules[index++];
+            if (!parseMinute(r["start"], rule.startMinute) || !parseMinute(r["end"], rule.endMinute)) {
+                return false;
+            }
+            rule.days = r["days"] | 0x7F;
+            rule.scene = r["scene"] | -1;
+            rule.enabled = true;
+        }
+    }
+
+    if (in.containsKey("enabled")) {
+        parsed.enabled = in["enabled"].as<bool>();
+    }
+
+    if (!ShowScheduler::isValid(parsed)) {
+        return false;
+    }
+    config = parsed;
+    return true;
+}
+
+bool ScheduleStore::save(ShowScheduler& scheduler, bool sdAvailable) {
+    if (!sdAvailable) {
+        Serial.println("SD card not available for saving schedule");
+        return false;
+    }
+
+    // Kept next to the calibration file
+    String dirPath = String(SCHEDULE_FILE_PATH);
+    dirPath = dirPath.substring(0, dirPath.lastIndexOf('/'));
+    if (dirPath.length() > 0 && !SD.exists(dirPath)) {
+        SD.mkdir(dirPath);
+    }
+
+    File file = SD.open(SCHEDULE_FILE_PATH, FILE_WRITE);
+    if (!file) {
+        Serial.println("Failed to open schedule file for writing");
+        return false;
+    }
+
+    JsonDocument doc;
+    toJson(scheduler, doc.to<JsonObject>());
+    doc.remove("status");
+    if (serializeJson(doc, file) == 0) {
+        Serial.println("Failed to write schedule");
+        file.close();
+        return false;
+    }
+    file.close();
+    Serial.println("Schedule saved to SD card");
+    return true;
+}
+
+bool ScheduleStore::load(ShowScheduler& scheduler, bool sdAvailable) {
+    if (!sdAvailable || !SD.exists(SCHEDULE_FILE_PATH)) {
+        return false;
+    }
+
+    File file = SD.open(SCHEDULE_FILE_PATH, FILE_READ);
+    if (!file) {
+        Serial.println("Failed to open schedule file for reading");
+        return false;
+    }
+
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, file);
+    file.close();
+    if (error) {
+        Serial.print("Failed to parse schedule: ");
+        Serial.println(error.c_str());
+        return false;
+    }
+
+    ScheduleConfig config;
+    scheduler.getConfig(config);
+    if (!fromJson(doc.as<JsonObjectConst>(), config) || !scheduler.submit(config)) {
+        Serial.println("Saved schedule is invalid");
+        return false;
+    }
+    Serial.printf("Schedule: %u scenes, %s\n", config.sceneCount, config.enabled ? "enabled" : "disabled");
+    return true;
+}
@@ -0,0 +1,112 @@
+#include "segment_store.h"
+
+SegmentStore::SegmentStore(LEDController& ledController, Calibration& calibration)
+    : _ledController(ledController)
+    , _calibration(calibration)
+    , _dirty(false)
+    , _changedAt(0)
+    , _loading(false) {
+}
+
+void SegmentStore::begin() {
+    load();
+    _ledController.addListener(onStateEvent, this);
+}
+
+void SegmentStore::onStateEvent(StateEvent event, void* context) {
+    SegmentStore* store = (SegmentStore*)context;
+    if (event == STATE_EVENT_SEGMENTS && !store->_loading) {
+        store->_changedAt = millis();
+        store->_dirty = true;
+    }
+}
+
+void SegmentStore::update() {
+    if (_dirty && millis() - _changedAt >= SEGMENTS_SAVE_DELAY) {
+        _dirty = false;
+        save();
+    }
+}
+
+bool SegmentStore::save() {
+    if (!_calibration.isSDAvailable()) {
+        Serial.println("SD card not available for saving segments");
+        return false;
+    }
+
+    // Segments live next to the calibration file
+    String dirPath = String(SEGMENTS_FILE_PATH);
+    dirPath = dirPath.substring(0, dirPath.lastIndexOf('/'));
+    if (dirPath.length() > 0 && !SD.exists(dirPath)) {
+        SD.mkdir(dirPath);
+    }
+
+    File file = SD.open(SEGMENTS_FILE_PATH, FILE_WRITE);
+    if (!file) {
+        Serial.println("Failed to open segments file for writing");
+        return false;
+    }
+
+    JsonDocument doc;
+    JsonArray segments = doc["segments"].to<JsonArray>();
+    for (uint8_t i = 0; i < MAX_SEGMENTS; i++) {
+        const Segment& segment = _ledController.getSegment(i);
+        if (!segment.enabled) continue;
+        JsonObject seg = segments.add<JsonObject>();
+        seg["index"] = i;
+        seg["name"] = segment.name;
+        seg["start"] = segment.anim.start;
+        seg["length"] = segment.anim.count;
+        seg["reverse"] = segment.anim.reverse;
+        seg["mode"] = static_cast<int>(segment.anim.mode);
+        seg["color"] = ((uint32_t)segment.anim.color.r << 16) | ((uint32_t)segment.anim.color.g << 8) | segment.anim.color.b;
+        seg["speed"] = segment.anim.speed;
+    }
+
+    if (serializeJson(doc, file) == 0) {
+        Serial.println("Failed to write segments");
+        file.close();
+        return false;
+    }
+
+    file.close();
+    Serial.println("Segments saved to SD card");
+    return true;
+}
+
+bool SegmentStore::load() {
+    if (!_calibration.isSDAvailable() || !SD.exists(SEGMENTS_FILE_PATH)) {
+        return false;
+    }
+
+    File file = SD.open(SEGMENTS_FILE_PATH, FILE_READ);
+    if (!file) {
+        Serial.println("Failed to open segments file for reading");
+        return false;
+    }
+
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, file);
+    file.close();
+
+    if (error) {
+        Serial.print("Failed to parse segments: ");
+        Serial.println(error.c_str());
+        return false;
+    }
+
+    _loading = true;
+    uint8_t loaded = 0;
+    for (JsonObject seg : doc["segments"].as<JsonArray>()) {
+        uint32_t color = seg["color"] | 0xFFFFFFUL;
+        if (_ledController.setSegment(seg["index"] | 0, seg["name"] | "", seg["start"] | 0, seg["length"] | 0,
+                                      seg["reverse"] | false, static_cast<AnimationMode>(seg["mode"] | 0),
+                                      CRGB(color), seg["speed"] | DEFAULT_ANIMATION_SPEED)) {
+            loaded++;
+        }
+    }
+    _loading = false;
+
+    Serial.printf("Loaded %u segments\n", loaded);
+    return true;
+}
@@ -0,0 +1,162 @@
+#include "sequence_player.h"
+
+SequencePlayer::SequencePlayer(LEDController& ledController, Calibration& calibration)
+    : _ledController(ledController)
+    , _calibration(calibration)
+    , _command(COMMAND_NONE)
+    , _pendingLoop(false)
+    , _error("")
+    , _playing(false)
+    , _loop(false)
+    , _finished(false)
+    , _previousMode(ANIMATION_STATIC)
+    , _started(false)
+    , _startTime(0)
+    , _frame(-1)
+    , _framesShown(0)
+    , _underruns(0)
+    , _decodeMicros(0)
+    , _peakDecodeMicros(0) {
+    _pendingName[0] = '\0';
+    _name[0] = '\0';
+}
+
+size_t SequencePlayer::FileSource::read(uint32_t offset, uint8_t* buffer, size_t length) {
+    if (!file || !file.seek(offset)) {
+        return 0;
+    }
+    return file.read(buffer, length);
+}
+
+void SequencePlayer::begin() {
+    _ledController.setFrameSource(this);
+}
+
+bool SequencePlayer::play(const char* name, bool loop) {
+    if (!name || !name[0] || strlen(name) >= SEQUENCE_NAME_LENGTH || strchr(name, '/')) {
+        return false;
+    }
+    strlcpy(_pendingName, name, sizeof(_pendingName));
+    _pendingLoop = loop;
+    _command.store(COMMAND_PLAY);
+    return true;
+}
+
+void SequencePlayer::stop() {
+    _command.store(COMMAND_STOP);
+}
+
+void SequencePlayer::update() {
+    uint8_t command = _command.exchange(COMMAND_NONE);
+    if (command == COMMAND_PLAY) {
+        _loop = _pendingLoop;
+        open(_pendingName);
+        return;
+    }
+    if ((command == COMMAND_STOP || _finished) && _playing) {
+        close();
+        // Hand the tree back to whatever ran before the show
+        if (_ledController.getAnimation() == ANIMATION_SEQUENCE) {
+            _ledController.setAnimation(_previousMode);
+        }
+    }
+}
+
+bool SequencePlayer::open(const char* name) {
+    close();
+    if (!_calibration.isSDAvailable()) {
+        _error = "SD card not available";
+        return false;
+    }
+
+    String path = String(SEQUENCE_DIR) + "/" + name;
+    _source.file = SD.open(path, FILE_READ);
+    if (!_source.file || _source.file.isDirectory()) {
+        _source.file.close();
+        _error = "sequence not found";
+        Serial.printf("Sequence %s not found\n", path.c_str());
+        return false;
+    }
+    if (!_reader.open(&_source, FSEQ_START_CHANNEL, NUM_LEDS * 3)) {
+        _error = _reader.getError();
+        Serial.printf("Sequence %s: %s\n", path.c_str(), _error);
+        _source.file.close();
+        return false;
+    }
+
+    strlcpy(_name, name, sizeof(_name));
+    _error = "";
+    _playing = true;
+    _finished = false;
+    _started = false;
+    _frame = -1;
+    _framesShown = 0;
+    _underruns = 0;
+    _decodeMicros = 0;
+    _peakDecodeMicros = 0;
+
+    if (_ledController.getAnimation() != ANIMATION_SEQUENCE) {
+        _previousMode = _ledController.getAnimation();
+    }
+    _ledController.setAnimation(ANIMATION_SEQUENCE);
+
+    Serial.printf("Playing %s: %u frames at %u ms, %u channels\n", name,
+                  _reader.getFrameCount(), _reader.getStepMs(), _reader.getChannelCount());
+    return true;
+}
+
+void SequencePlayer::close() {
+    _playing = false;
+    _finished = false;
+    _reader.close();
+    if (_source.file) {
+        _source.file.close();
+    }
+}
+
+bool SequencePlayer::renderFrame(CRGB* leds, uint16_t count, unsigned long now) {
+    if (!_playing || _finished || count != NUM_LEDS) {
+        return false;
+    }
+    // The clock starts with the first frame actually drawn
+    if (!_started) {
+        _started = true;
+        _startTime = now;
+    }
+
+    uint32_t frames = _reader.getFrameCount();
+    uint32_t step = _reader.getStepMs();
+    uint32_t target = (now - _startTime) / step;
+    uint32_t skipped;
+    if (target >= frames) {
+        if (!_loop) {
+            _finished = true;  // Hold the last frame until update() stops
+            return false;
+        }
+        uint32_t loops = target / frames;
+        _startTime += loops * frames * step;
+        target -= loops * frames;
+        skipped = (frames - 1 - _frame) + target;
+    } else if ((int32_t)target == _frame) {
+        return false;
+    } else {
+        skipped = target - (uint32_t)(_frame + 1);
+    }
+
+    uint32_t start = micros();
+    if (!_reader.readFrame(target, (uint8_t*)leds)) {
+        _error = _reader.getError();
+        Serial.printf("Sequence %s: %s at frame %u\n", _name, _error, target);
+        _finished = true;
+        return false;
+    }
+    _decodeMicros = micros() - start;
+    if (_decodeMicros > _peakDecodeMicros) {
+        _peakDecodeMicros = _decodeMicros;
+    }
+
+    _underruns += skipped;
+    _framesShown++;
+    _frame = (int32_t)target;
+    return true;
+}
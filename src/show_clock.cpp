@@ -0,0 +1,52 @@
+#include "show_clock.h"
+#include <Arduino.h>
+#include <time.h>
+#include <sys/time.h>
+#include "config.h"
+
+// Anything earlier means the RTC still holds its power-on value
+static const time_t CLOCK_VALID_AFTER = 1600000000;  // September 2020
+
+void SystemClock::begin() {
+    setenv("TZ", SCHEDULE_TIMEZONE, 1);
+    tzset();
+}
+
+void SystemClock::startNtp() {
+    if (_ntpStarted || SCHEDULE_NTP_SERVER[0] == '\0') {
+        return;
+    }
+    configTzTime(SCHEDULE_TIMEZONE, SCHEDULE_NTP_SERVER);
+    _ntpStarted = true;
+    Serial.printf("NTP: syncing with %s\n", SCHEDULE_NTP_SERVER);
+}
+
+void SystemClock::setEpoch(uint32_t epoch) {
+    struct timeval tv = { (time_t)epoch, 0 };
+    settimeofday(&tv, nullptr);
+    Serial.printf("Clock set to %lu\n", (unsigned long)epoch);
+}
+
+bool SystemClock::isSet() const {
+    return time(nullptr) > CLOCK_VALID_AFTER;
+}
+
+uint32_t SystemClock::getEpoch() const {
+    return (uint32_t)time(nullptr);
+}
+
+uint32_t SystemClock::millis() {
+    return ::millis();
+}
+
+bool SystemClock::localTime(uint16_t& minuteOfDay, uint8_t& weekday) {
+    time_t now = time(nullptr);
+    if (now <= CLOCK_VALID_AFTER) {
+        return false;
+    }
+    struct tm local;
+    localtime_r(&now, &local);
+    minuteOfDay = local.tm_hour * 60 + local.tm_min;
+    weekday = local.tm_wday;
+    return true;
+}
@@ -0,0 +1,168 @@
+#include "show_scheduler.h"
+#include <string.h>
+
+static const uint16_t MINUTES_PER_DAY = 24 * 60;
+
+ShowScheduler::ShowScheduler(ShowClock& clock, SceneHandler handler, void* context)
+    : _clock(clock)
+    , _handler(handler)
+    , _context(context)
+    , _stage(STAGE_EMPTY)
+    , _activeRule(-1)
+    , _activeScene(-1)
+    , _playlistIndex(0)
+    , _playlistRunning(false)
+    , _sceneStart(0)
+    , _sceneDuration(0) {
+    memset(&_config, 0, sizeof(_config));
+    memset(&_staged, 0, sizeof(_staged));
+}
+
+bool ShowScheduler::isValid(const ScheduleConfig& config) {
+    if (config.sceneCount > SCHEDULE_MAX_SCENES) {
+        return false;
+    }
+    for (uint8_t i = 0; i < config.sceneCount; i++) {
+        if (!animationHasContent(config.scenes[i].mode)) {
+            return false;
+        }
+    }
+    for (uint8_t i = 0; i < SCHEDULE_MAX_RULES; i++) {
+        const ScheduleRule& rule = config.rules[i];
+        if (rule.enabled && (rule.startMinute >= MINUTES_PER_DAY || rule.endMinute >= MINUTES_PER_DAY ||
+                             rule.scene < -1 || rule.scene >= (int8_t)config.sceneCount)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ShowScheduler::submit(const ScheduleConfig& config) {
+    if (!isValid(config)) {
+        return false;
+    }
+    // Take the stage if it's empty, or holds a config update() hasn't taken yet
+    uint8_t state = STAGE_EMPTY;
+    if (!_stage.compare_exchange_strong(state, STAGE_WRITING)) {
+        state = STAGE_READY;
+        if (!_stage.compare_exchange_strong(state, STAGE_WRITING)) {
+            return false;
+        }
+    }
+    _staged = config;
+    _stage.store(STAGE_READY);
+    return true;
+}
+
+void ShowScheduler::getConfig(ScheduleConfig& config) const {
+    config = _staged;
+}
+
+void ShowScheduler::restart() {
+    // Re-evaluate everything on the next update
+    _activeRule = -1;
+    _activeScene = -1;
+    _playlistIndex = 0;
+    _playlistRunning = false;
+}
+
+bool ShowScheduler::ruleMatches(const ScheduleRule& rule, uint16_t minuteOfDay, uint8_t weekday) {
+    if (!rule.enabled || rule.startMinute == rule.endMinute) {
+        return false;
+    }
+    if (rule.startMinute < rule.endMinute) {
+        return minuteOfDay >= rule.startMinute && minuteOfDay < rule.endMinute &&
+               (rule.days & (1 << weekday));
+    }
+    // Wraps past midnight: the early-morning part belongs to the previous day
+    if (minuteOfDay >= rule.startMinute) {
+        return rule.days & (1 << weekday);
+    }
+    if (minuteOfDay < rule.endMinute) {
+        return rule.days & (1 << ((weekday + 6) % 7));
+    }
+    return false;
+}
+
+int8_t ShowScheduler::findRule() {
+    uint16_t minute;
+    uint8_t weekday;
+    if (!_clock.localTime(minute, weekday)) {
+        return -1;  // Rules need the wall clock; the playlist does not
+    }
+    for (uint8_t i = 0; i < SCHEDULE_MAX_RULES; i++) {
+        if (ruleMatches(_config.rules[i], minute, weekday)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void ShowScheduler::apply(int8_t scene) {
+    _activeScene = scene;
+    _sceneDuration = scene >= 0 ? _config.scenes[scene].durationMs : 0;
+    if (_handler) {
+        _handler(scene >= 0 ? &_config.scenes[scene] : nullptr, _context);
+    }
+}
+
+void ShowScheduler::update() {
+    uint8_t state = STAGE_READY;
+    if (_stage.compare_exchange_strong(state, STAGE_TAKING)) {
+        _config = _staged;
+        _stage.store(STAGE_EMPTY);
+        restart();
+    }
+
+    if (!_config.enabled) {
+        return;
+    }
+    uint32_t now = _clock.millis();
+
+    int8_t rule = findRule();
+    if (rule >= 0) {
+        if (rule != _activeRule) {
+            _activeRule = rule;
+            _playlistRunning = false;
+            int8_t scene = _config.rules[rule].scene;
+            apply(scene < (int8_t)_config.sceneCount ? scene : -1);
+        }
+        return;
+    }
+    _activeRule = -1;
+
+    if (_config.sceneCount == 0) {
+        return;
+    }
+    if (!_playlistRunning) {
+        // Start, or resume where the playlist left off when a rule took over
+        _playlistRunning = true;
+        _playlistIndex %= _config.sceneCount;
+        _sceneStart = now;
+        apply(_playlistIndex);
+        return;
+    }
+
+    uint32_t duration = _config.scenes[_playlistIndex].durationMs;
+    if (duration == 0 || now - _sceneStart < duration) {
+        return;
+    }
+    // Due time is counted from the previous change, unless we've fallen a
+    // whole scene behind (clock jump, long stall) - then resync
+    _sceneStart += duration;
+    if (now - _sceneStart >= duration) {
+        _sceneStart = now;
+    }
+    _playlistIndex = (_playlistIndex + 1) % _config.sceneCount;
+    apply(_playlistIndex);
+}
+
+uint32_t ShowScheduler::getSceneRemaining() {
+    // Called from the web task: only reads fields update() sets as a whole
+    if (!_playlistRunning || _activeRule >= 0) {
+        return 0;
+    }
+    uint32_t duration = _sceneDuration;
+    uint32_t elapsed = _clock.millis() - _sceneStart;
+    return elapsed < duration ? duration - elapsed : 0;
+}
@@ -0,0 +1,173 @@
+#include "spatial_index.h"
+#include <string.h>
+
+static const float CELL_SIZE = 2.0f / SpatialIndex::GRID;
+
+SpatialIndex::SpatialIndex()
+    : _positions(nullptr) {
+    memset(_cellStart, 0, sizeof(_cellStart));
+}
+
+uint16_t SpatialIndex::cellFor(const LEDPosition& p) const {
+    return cellIndex(cellCoord(p.x), cellCoord(p.y), cellCoord(p.z));
+}
+
+void SpatialIndex::build(const LEDPosition* positions) {
+    _positions = positions;
+
+    // Counting sort of LEDs by cell
+    memset(_cellStart, 0, sizeof(_cellStart));
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        _ledCell[i] = cellFor(positions[i]);
+        _cellStart[_ledCell[i] + 1]++;
+    }
+    for (uint16_t c = 0; c < CELL_COUNT; c++) {
+        _cellStart[c + 1] += _cellStart[c];
+    }
+
+    uint16_t fill[CELL_COUNT];
+    memcpy(fill, _cellStart, sizeof(fill));
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        uint16_t slot = fill[_ledCell[i]]++;
+        _items[slot] = i;
+        _slot[i] = slot;
+    }
+}
+
+void SpatialIndex::swapSlots(uint16_t a, uint16_t b) {
+    if (a == b) return;
+    uint16_t ia = _items[a];
+    uint16_t ib = _items[b];
+    _items[a] = ib;
+    _items[b] = ia;
+    _slot[ib] = a;
+    _slot[ia] = b;
+}
+
+void SpatialIndex::update(uint16_t index) {
+    if (!_positions || index >= NUM_LEDS) return;
+
+    uint16_t from = _ledCell[index];
+    uint16_t to = cellFor(_positions[index]);
+    if (from == to) return;
+
+    // Walk the LED across cell boundaries one cell at a time: move it to the
+    // edge of its current range, then shift that boundary past it.
+    if (to > from) {
+        for (uint16_t c = from; c < to; c++) {
+            uint16_t last = _cellStart[c + 1] - 1;
+            swapSlots(_slot[index], last);
+            _cellStart[c + 1]--;
+        }
+    } else {
+        for (uint16_t c = from; c > to; c--) {
+            uint16_t first = _cellStart[c];
+            swapSlots(_slot[index], first);
+            _cellStart[c]++;
+        }
+    }
+    _ledCell[index] = to;
+}
+
+uint16_t SpatialIndex::querySphere(const LEDPosition& center, float radius, uint16_t* out, uint16_t maxOut) const {
+    if (!_positions) return 0;
+
+    LEDPosition lo = { center.x - radius, center.y - radius, center.z - radius };
+    LEDPosition hi = { center.x + radius, center.y + radius, center.z + radius };
+    float r2 = radius * radius;
+    uint16_t found = 0;
+
+    forEachSpan(lo, hi, [&](const uint16_t* indices, uint16_t count) {
+        for (uint16_t n = 0; n < count && found < maxOut; n++) {
+            const LEDPosition& p = _positions[indices[n]];
+            float dx = p.x - center.x;
+            float dy = p.y - center.y;
+            float dz = p.z - center.z;
+            if (dx * dx + dy * dy + dz * dz <= r2) {
+                out[found++] = indices[n];
+            }
+        }
+    });
+    return found;
+}
+
+uint16_t SpatialIndex::queryBox(const LEDPosition& min, const LEDPosition& max, uint16_t* out, uint16_t maxOut) const {
+    if (!_positions) return 0;
+
+    uint16_t found = 0;
+    forEachSpan(min, max, [&](const uint16_t* indices, uint16_t count) {
+        for (uint16_t n = 0; n < count && found < maxOut; n++) {
+            const LEDPosition& p = _positions[indices[n]];
+            if (p.x >= min.x && p.x <= max.x &&
+                p.y >= min.y && p.y <= max.y &&
+                p.z >= min.z && p.z <= max.z) {
+                out[found++] = indices[n];
+            }
+        }
+    });
+    return found;
+}
+
+uint16_t SpatialIndex::queryNearest(const LEDPosition& point, uint16_t k, uint16_t* out, float* outDistSq) const {
+    if (!_positions || k == 0) return 0;
+    if (k > SPATIAL_MAX_NEAREST) k = SPATIAL_MAX_NEAREST;
+
+    // Best k so far, kept sorted by distance
+    float bestDist[SPATIAL_MAX_NEAREST];
+    uint16_t bestIndex[SPATIAL_MAX_NEAREST];
+    uint16_t found = 0;
+
+    int px = cellCoord(point.x);
+    int py = cellCoord(point.y);
+    int pz = cellCoord(point.z);
+
+    // Search shells of cells at increasing Chebyshev distance
+    for (int ring = 0; ring < GRID; ring++) {
+        for (int cx = px - ring; cx <= px + ring; cx++) {
+            if (cx < 0 || cx >= GRID) continue;
+            for (int cy = py - ring; cy <= py + ring; cy++) {
+                if (cy < 0 || cy >= GRID) continue;
+                bool onShellXY = (cx == px - ring || cx == px + ring || cy == py - ring || cy == py + ring);
+                // Interior columns only contribute their two end cells
+                int step = onShellXY ? 1 : (ring > 0 ? 2 * ring : 1);
+                for (int cz = pz - ring; cz <= pz + ring; cz += step) {
+                    if (cz < 0 || cz >= GRID) continue;
+
+                    uint16_t cell = cellIndex(cx, cy, cz);
+                    for (uint16_t s = _cellStart[cell]; s < _cellStart[cell + 1]; s++) {
+                        uint16_t idx = _items[s];
+                        const LEDPosition& p = _positions[idx];
+                        float dx = p.x - point.x;
+                        float dy = p.y - point.y;
+                        float dz = p.z - point.z;
+                        float d = dx * dx + dy * dy + dz * dz;
+
+                        if (found == k && d >= bestDist[k - 1]) continue;
+
+                        // Insertion into the sorted list
+                        uint16_t pos = (found < k) ? found++ : k - 1;
+                        while (pos > 0 && bestDist[pos - 1] > d) {
+                            bestDist[pos] = bestDist[pos - 1];
+                            bestIndex[pos] = bestIndex[pos - 1];
+                            pos--;
+                        }
+                        bestDist[pos] = d;
+                        bestIndex[pos] = idx;
+                    }
+                }
+            }
+        }
+
+        // Anything beyond this shell is at least ring cells away
+        float reach = ring * CELL_SIZE;
+        if (found == k && bestDist[k - 1] <= reach * reach) {
+            break;
+        }
+    }
+
+    for (uint16_t i = 0; i < found; i++) {
+        out[i] = bestIndex[i];
+        if (outDistSq) outDistSq[i] = bestDist[i];
+    }
+    return found;
+}
@@ -0,0 +1,232 @@
+#include "triangulation.h"
+#include <math.h>
+#include <string.h>
+#include <new>
+
+static const float DEG_TO_RADIANS = 3.14159265f / 180.0f;
+
+TriangulationSolver::TriangulationSolver(uint16_t ledCount)
+    : _ledCount(ledCount)
+    , _viewCount(0)
+    , _triangulated(0)
+    , _interpolated(0)
+    , _rmsError(0) {
+}
+
+TriangulationSolver::~TriangulationSolver() {
+    for (uint8_t i = 0; i < _viewCount; i++) {
+        delete[] _views[i].points;
+    }
+}
+
+bool TriangulationSolver::addView(float angleDegrees, const ImagePoint* points) {
+    if (_viewCount >= TRIANGULATION_MAX_VIEWS) {
+        return false;
+    }
+
+    View& view = _views[_viewCount];
+    view.points = new (std::nothrow) ImagePoint[_ledCount];
+    if (!view.points) {
+        return false;
+    }
+    memcpy(view.points, points, _ledCount * sizeof(ImagePoint));
+
+    view.angle = angleDegrees * DEG_TO_RADIANS;
+    view.cosA = cosf(view.angle);
+    view.sinA = sinf(view.angle);
+    normalizeView(view);
+    _viewCount++;
+    return true;
+}
+
+void TriangulationSolver::normalizeView(View& view) {
+    // Centre on the mean of the LEDs this view saw
+    float sumU = 0, sumV = 0;
+    uint16_t seen = 0;
+    for (uint16_t i = 0; i < _ledCount; i++) {
+        if (view.points[i].seen) {
+            sumU += view.points[i].u;
+            sumV += view.points[i].v;
+            seen++;
+        }
+    }
+    if (seen == 0) {
+        return;
+    }
+    float meanU = sumU / seen;
+    float meanV = sumV / seen;
+
+    // Height is view-independent, so its spread gives a common scale
+    float sumSq = 0;
+    for (uint16_t i = 0; i < _ledCount; i++) {
+        if (view.points[i].seen) {
+            float dv = view.points[i].v - meanV;
+            sumSq += dv * dv;
+        }
+    }
+    float spread = sqrtf(sumSq / seen);
+    float scale = spread > 0 ? 1.0f / spread : 1.0f;
+
+    for (uint16_t i = 0; i < _ledCount; i++) {
+        view.points[i].u = (view.points[i].u - meanU) * scale;
+        view.points[i].v = (view.points[i].v - meanV) * scale;
+    }
+}
+
+bool TriangulationSolver::solve(LEDPosition* out) {
+    _triangulated = 0;
+    _interpolated = 0;
+    _rmsError = 0;
+
+    float* xs = new (std::nothrow) float[_ledCount * 3];
+    bool* known = new (std::nothrow) bool[_ledCount * 2];
+    if (!xs || !known) {
+        delete[] xs;
+        delete[] known;
+        return false;
+    }
+    float* ys = xs + _ledCount;
+    float* zs = ys + _ledCount;
+    bool* knownXZ = known;
+    bool* knownY = known + _ledCount;
+
+    // Views whose angles differ by less than this leave depth undetermined
+    float minSep = sinf(TRIANGULATION_MIN_SEPARATION * DEG_TO_RADIANS);
+    float minDet = minSep * minSep;
+
+    // Views that saw different subsets of LEDs were centred on slightly
+    // different means. Alternate between solving positions and shifting each
+    // view by its mean residual until the offsets settle.
+    float errorSum = 0;
+    uint32_t errorCount = 0;
+    for (uint8_t pass = 0; pass < TRIANGULATION_PASSES; pass++) {
+        _triangulated = 0;
+        errorSum = 0;
+        errorCount = 0;
+        float offsetU[TRIANGULATION_MAX_VIEWS] = {};
+        float offsetV[TRIANGULATION_MAX_VIEWS] = {};
+        uint16_t offsetCount[TRIANGULATION_MAX_VIEWS] = {};
+
+        for (uint16_t i = 0; i < _ledCount; i++) {
+            // Normal equations for c*x - s*z = u over the views that saw LED i
+            float cc = 0, cs = 0, ss = 0, cu = 0, su = 0, sumV = 0;
+            uint8_t seen = 0;
+            for (uint8_t k = 0; k < _viewCount; k++) {
+                const ImagePoint& p = _views[k].points[i];
+                if (!p.seen) continue;
+                float c = _views[k].cosA;
+                float s = _views[k].sinA;
+                cc += c * c;
+                cs += c * s;
+                ss += s * s;
+                cu += c * p.u;
+                su += s * p.u;
+                sumV += p.v;
+                seen++;
+            }
+
+            knownY[i] = seen > 0;
+            ys[i] = seen > 0 ? -sumV / seen : 0;
+
+            // det = sum over view pairs of sin^2(angle difference)
+            float det = cc * ss - cs * cs;
+            knownXZ[i] = seen >= 2 && det >= minDet;
+            if (!knownXZ[i]) {
+                xs[i] = 0;
+                zs[i] = 0;
+                continue;
+            }
+            xs[i] = (ss * cu - cs * su) / det;
+            zs[i] = (cs * cu - cc * su) / det;
+            _triangulated++;
+
+            for (uint8_t k = 0; k < _viewCount; k++) {
+                const ImagePoint& p = _views[k].points[i];
+                if (!p.seen) continue;
+                float du = p.u - (_views[k].cosA * xs[i] - _views[k].sinA * zs[i]);
+                float dv = p.v + ys[i];
+                offsetU[k] += du;
+                offsetV[k] += dv;
+                offsetCount[k]++;
+                errorSum += du * du + dv * dv;
+                errorCount++;
+            }
+        }
+
+        for (uint8_t k = 0; k < _viewCount; k++) {
+            if (offsetCount[k] == 0) continue;
+            float mu = offsetU[k] / offsetCount[k];
+            float mv = offsetV[k] / offsetCount[k];
+            for (uint16_t i = 0; i < _ledCount; i++) {
+                _views[k].points[i].u -= mu;
+                _views[k].points[i].v -= mv;
+            }
+        }
+    }
+
+    if (_triangulated < 2) {
+        delete[] xs;
+        delete[] known;
+        return false;
+    }
+
+    _interpolated = _ledCount - _triangulated;
+    _rmsError = errorCount > 0 ? sqrtf(errorSum / errorCount) : 0;
+
+    fillGaps(xs, knownXZ, _ledCount);
+    fillGaps(zs, knownXZ, _ledCount);
+    fillGaps(ys, knownY, _ledCount);
+
+    // Fit into -1..1 with one scale for all axes so proportions survive
+    float lo[3] = { xs[0], ys[0], zs[0] };
+    float hi[3] = { xs[0], ys[0], zs[0] };
+    for (uint16_t i = 1; i < _ledCount; i++) {
+        float v[3] = { xs[i], ys[i], zs[i] };
+        for (uint8_t a = 0; a < 3; a++) {
+            if (v[a] < lo[a]) lo[a] = v[a];
+            if (v[a] > hi[a]) hi[a] = v[a];
+        }
+    }
+    float center[3];
+    float halfExtent = 0;
+    for (uint8_t a = 0; a < 3; a++) {
+        center[a] = (lo[a] + hi[a]) * 0.5f;
+        float half = (hi[a] - lo[a]) * 0.5f;
+        if (half > halfExtent) halfExtent = half;
+    }
+    float scale = halfExtent > 0 ? 1.0f / halfExtent : 1.0f;
+
+    for (uint16_t i = 0; i < _ledCount; i++) {
+        out[i].x = (xs[i] - center[0]) * scale;
+        out[i].y = (ys[i] - center[1]) * scale;
+        out[i].z = (zs[i] - center[2]) * scale;
+    }
+
+    delete[] xs;
+    delete[] known;
+    return true;
+}
+
+void TriangulationSolver::fillGaps(float* values, const bool* known, uint16_t count) {
+    // Linear interpolation between the nearest known neighbours along the
+    // strip; the ends copy the closest known value.
+    int32_t prev = -1;
+    for (uint16_t i = 0; i <= count; i++) {
+        if (i < count && !known[i]) continue;
+
+        int32_t next = (i < count) ? i : -1;
+        int32_t gapStart = prev + 1;
+        int32_t gapEnd = (next >= 0) ? next : count;
+        for (int32_t g = gapStart; g < gapEnd; g++) {
+            if (prev >= 0 && next >= 0) {
+                float t = (float)(g - prev) / (next - prev);
+                values[g] = values[prev] + (values[next] - values[prev]) * t;
+            } else if (prev >= 0) {
+                values[g] = values[prev];
+            } else if (next >= 0) {
+                values[g] = values[next];
+            }
+        }
+        prev = next;
+    }
+}
@@ -1,4 +1,9 @@
 #include "web_server.h"
+#include "schedule_store.h"
+#include "triangulation.h"
+
+// Binary bulk calibration record: uint16 led + 3 x int16 coordinate
+static const size_t BULK_RECORD_SIZE = 8;
 
 const char INDEX_HTML[] PROGMEM = R"rawliteral(
 <!DOCTYPE html>
@@ -304,6 +309,35 @@ const char INDEX_HTML[] PROGMEM = R"rawliteral(
                     <button class="anim-btn spatial" data-anim="11" onclick="setAnimation(11)">Pulse</button>
                     <button class="anim-btn spatial" data-anim="12" onclick="setAnimation(12)">Rotate</button>
                     <button class="anim-btn spatial" data-anim="13" onclick="setAnimation(13)">Planes</button>
+                    <button class="anim-btn spatial" data-anim="14" onclick="setAnimation(14)">Wipe</button>
+                    <button class="anim-btn spatial" data-anim="15" onclick="setAnimation(15)">Ripple</button>
+                    <button class="anim-btn spatial" data-anim="16" onclick="setAnimation(16)">Sweep</button>
+                </div>
+
+                <div class="section-divider">
+                    <div class="section-label">Audio Reactive</div>
+                </div>
+                <div class="animation-grid">
+                    <button class="anim-btn spatial" data-anim="19" onclick="setAnimation(19)">Spectrum</button>
+                    <button class="anim-btn spatial" data-anim="20" onclick="setAnimation(20)">Beat</button>
+                </div>
+
+                <div class="section-divider">
+                    <div class="section-label">Noise</div>
+                </div>
+                <div class="animation-grid">
+                    <button class="anim-btn spatial" data-anim="21" onclick="setAnimation(21)">Clouds</button>
+                    <button class="anim-btn spatial" data-anim="22" onclick="setAnimation(22)">Lava</button>
+                    <button class="anim-btn spatial" data-anim="23" onclick="setAnimation(23)">Aurora</button>
+                </div>
+
+                <div class="section-divider">
+                    <div class="section-label">Particles</div>
+                </div>
+                <div class="animation-grid">
+                    <button class="anim-btn spatial" data-anim="24" onclick="setAnimation(24)">Snowfall</button>
+                    <button class="anim-btn spatial" data-anim="25" onclick="setAnimation(25)">Fireworks</button>
+                    <button class="anim-btn spatial" data-anim="26" onclick="setAnimation(26)">Embers</button>
                 </div>
             </div>
 
@@ -363,6 +397,10 @@ const char INDEX_HTML[] PROGMEM = R"rawliteral(
                         <button class="btn-reset" onclick="resetCalibration()">Reset All</button>
                         <button class="btn-exit" onclick="exitCalibration()">Exit</button>
                     </div>
+                    <div class="calibration-actions">
+                        <button class="btn-reset" onclick="document.getElementById('calibFile').click()">Upload File</button>
+                        <input type="file" id="calibFile" accept=".json,application/json" style="display:none" onchange="uploadCalibration(this.files[0])">
+                    </div>
                 </div>
             </div>
         </div>
@@ -523,7 +561,14 @@ const char INDEX_HTML[] PROGMEM = R"rawliteral(
             }
         }
 
-        async function updatePosition() {
+        // Slider edits are batched per frame interval with at most one request in
+        // flight, so a fast drag never queues a backlog of POSTs on the controller
+        const POSITION_BATCH_MS = 50;
+        const pendingPositions = new Map();
+        let positionTimer = null;
+        let positionInFlight = false;
+
+        function updatePosition() {
             const x = parseInt(document.getElementById('posX').value) / 100;
             const y = parseInt(document.getElementById('posY').value) / 100;
             const z = parseInt(document.getElementById('posZ').value) / 100;
@@ -533,11 +578,47 @@ const char INDEX_HTML[] PROGMEM = R"rawliteral(
             document.getElementById('posZVal').textContent = z.toFixed(2);
 
             calibrationData[currentCalibrationLed] = { x, y, z };
+            pendingPositions.set(currentCalibrationLed, [currentCalibrationLed, x, y, z]);
+            schedulePositionFlush();
+        }
 
-            await api('/api/calibration/position', {
-                led: currentCalibrationLed,
-                x, y, z
-            });
+        function schedulePositionFlush() {
+            if (!positionTimer && !positionInFlight) {
+                positionTimer = setTimeout(flushPositions, POSITION_BATCH_MS);
+            }
+        }
+
+        async function flushPositions() {
+            positionTimer = null;
+            if (pendingPositions.size === 0) return;
+            const positions = Array.from(pendingPositions.values());
+            pendingPositions.clear();
+            positionInFlight = true;
+            try {
+                await api('/api/calibration/positions', { positions });
+            } catch (e) {
+                console.error('Failed to send positions:', e);
+            } finally {
+                positionInFlight = false;
+                if (pendingPositions.size > 0) schedulePositionFlush();
+            }
+        }
+
+        async function uploadCalibration(file) {
+            if (!file) return;
+            try {
+                // Accepts the GET /api/calibration format or a bare [[led, x, y, z], ...] list
+                const data = JSON.parse(await file.text());
+                const list = Array.isArray(data) ? data : data.positions;
+                const positions = list.map((p, i) => Array.isArray(p) ? p : [i, p.x, p.y, p.z]);
+                await api('/api/calibration/positions', { positions });
+                await loadCalibration();
+                if (currentCalibrationLed >= 0) updateCalibrationUI();
+                alert('Uploaded ' + positions.length + ' positions');
+            } catch (e) {
+                alert('Failed to upload calibration');
+            }
+            document.getElementById('calibFile').value = '';
         }
 
         async function saveCalibration() {
@@ -569,31 +650,85 @@ const char INDEX_HTML[] PROGMEM = R"rawliteral(
             document.getElementById('nextBtn').disabled = true;
         }
 
-        // Load initial state
+        // Load initial state, then follow changes pushed by the controller
         loadState();
+        if (window.EventSource) {
+            const events = new EventSource('/api/events');
+            events.addEventListener('state', e => updateUI(JSON.parse(e.data)));
+            events.addEventListener('calibration', e => {
+                const data = JSON.parse(e.data);
+                if (currentCalibrationLed >= 0 && data.currentLed >= 0 && data.currentLed !== currentCalibrationLed) {
+                    currentCalibrationLed = data.currentLed;
+                    updateCalibrationUI();
+                }
+            });
+        }
     </script>
 </body>
 </html>
 )rawliteral";
 
-WebServer::WebServer(LEDController& ledController, Calibration& calibration)
+WebServer::WebServer(LEDController& ledController, Calibration& calibration, ShowScheduler& scheduler, SystemClock& clock,
+                     PresetStore& presets, SequencePlayer& sequence, AudioInput& audio)
     : _server(WEB_SERVER_PORT)
+    , _events("/api/events")
     , _ledController(ledController)
-    , _calibration(calibration) {
+    , _calibration(calibration)
+    , _scheduler(scheduler)
+    , _clock(clock)
+    , _presets(presets)
+    , _sequence(sequence)
+    , _audio(audio)
+    , _pendingEvents(0)
+    , _lastPush(0) {
 }
 
 void WebServer::begin() {
     setupRoutes();
     _server.begin();
+    _ledController.addListener(onStateEvent, this);
+    _calibration.addListener(onStateEvent, this);
     Serial.println("Web server started on port 80");
 }
 
+void WebServer::onStateEvent(StateEvent event, void* context) {
+    WebServer* server = (WebServer*)context;
+    server->_pendingEvents.fetch_or(STATE_EVENT_BIT(event));
+}
+
+void WebServer::update() {
+    if (millis() - _lastPush < WEB_EVENT_INTERVAL) {
+        return;
+    }
+
+    uint32_t events = _pendingEvents.exchange(0);
+    if (!events || _events.count() == 0) {
+        return;
+    }
+    _lastPush = millis();
+
+    const uint32_t stateEvents = STATE_EVENT_BIT(STATE_EVENT_POWER) | STATE_EVENT_BIT(STATE_EVENT_BRIGHTNESS) |
+                                 STATE_EVENT_BIT(STATE_EVENT_COLOR) | STATE_EVENT_BIT(STATE_EVENT_ANIMATION) |
+                                 STATE_EVENT_BIT(STATE_EVENT_SPEED) | STATE_EVENT_BIT(STATE_EVENT_SEGMENTS);
+    if (events & stateEvents) {
+        _events.send(getStateJson().c_str(), "state", millis());
+    }
+    if (events & STATE_EVENT_BIT(STATE_EVENT_CALIBRATION_LED)) {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "{\"currentLed\":%d}", _calibration.getCalibrationLED());
+        _events.send(buf, "calibration", millis());
+    }
+}
+
 void WebServer::setupRoutes() {
     // Serve main page
     _server.on("/", HTTP_GET, [](AsyncWebServerRequest* request) {
         request->send_P(200, "text/html", INDEX_HTML);
     });
 
+    // State change stream (server-sent events)
+    _server.addHandler(&_events);
+
     // Get current state
     _server.on("/api/state", HTTP_GET, [this](AsyncWebServerRequest* request) {
         handleGetState(request);
@@ -634,6 +769,115 @@ void WebServer::setupRoutes() {
         });
     _server.addHandler(speedHandler);
 
+    _server.on("/api/output", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        request->send(200, "application/json", getOutputJson());
+    });
+
+    AsyncCallbackJsonWebHandler* outputHandler = new AsyncCallbackJsonWebHandler("/api/output",
+        [this](AsyncWebServerRequest* request, JsonVariant& json) {
+            handleSetOutput(request, json);
+        });
+    _server.addHandler(outputHandler);
+
+    AsyncCallbackJsonWebHandler* transitionHandler = new AsyncCallbackJsonWebHandler("/api/transition",
+        [this](AsyncWebServerRequest* request, JsonVariant& json) {
+            handleSetTransition(request, json);
+        });
+    _server.addHandler(transitionHandler);
+
+    AsyncCallbackJsonWebHandler* cacheHandler = new AsyncCallbackJsonWebHandler("/api/cache",
+        [this](AsyncWebServerRequest* request, JsonVariant& json) {
+            handleSetFrameCache(request, json);
+        });
+    _server.addHandler(cacheHandler);
+
+    _server.on("/api/particles", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        request->send(200, "application/json", getParticlesJson());
+    });
+
+    AsyncCallbackJsonWebHandler* particleHandler = new AsyncCallbackJsonWebHandler("/api/particles",
+        [this](AsyncWebServerRequest* request, JsonVariant& json) {
+            handleSetParticles(request, json);
+        });
+    _server.addHandler(particleHandler);
+
+    AsyncCallbackJsonWebHandler* layerHandler = new AsyncCallbackJsonWebHandler("/api/layers",
+        [this](AsyncWebServerRequest* request, JsonVariant& json) {
+            handleSetLayer(request, json);
+        });
+    _server.addHandler(layerHandler);
+
+    AsyncCallbackJsonWebHandler* segmentHandler = new AsyncCallbackJsonWebHandler("/api/segments",
+        [this](AsyncWebServerRequest* request, JsonVariant& json) {
+            handleSetSegment(request, json);
+        });
+    _server.addHandler(segmentHandler);
+
+    // Scheduler endpoints
+    _server.on("/api/schedule", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        request->send(200, "application/json", getScheduleJson());
+    });
+
+    AsyncCallbackJsonWebHandler* scheduleHandler = new AsyncCallbackJsonWebHandler("/api/schedule",
+        [this](AsyncWebServerRequest* request, JsonVariant& json) {
+            handleSetSchedule(request, json);
+        });
+    _server.addHandler(scheduleHandler);
+
+    _server.on("/api/clock", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        request->send(200, "application/json", getClockJson());
+    });
+
+    AsyncCallbackJsonWebHandler* clockHandler = new AsyncCallbackJsonWebHandler("/api/clock",
+        [this](AsyncWebServerRequest* request, JsonVariant& json) {
+            handleSetClock(request, json);
+        });
+    _server.addHandler(clockHandler);
+
+    // Preset endpoints. Recall takes the index as a query/form parameter so
+    // the hot path never builds a JSON document.
+    _server.on("/api/presets", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        request->send(200, "application/json", getPresetsJson());
+    });
+
+    _server.on("/api/presets/recall", HTTP_POST, [this](AsyncWebServerRequest* request) {
+        handleRecallPreset(request);
+    });
+
+    AsyncCallbackJsonWebHandler* presetSaveHandler = new AsyncCallbackJsonWebHandler("/api/presets/save",
+        [this](AsyncWebServerRequest* request, JsonVariant& json) {
+            handleSavePreset(request, json);
+        });
+    _server.addHandler(presetSaveHandler);
+
+    AsyncCallbackJsonWebHandler* presetDeleteHandler = new AsyncCallbackJsonWebHandler("/api/presets/delete",
+        [this](AsyncWebServerRequest* request, JsonVariant& json) {
+            handleDeletePreset(request, json);
+        });
+    _server.addHandler(presetDeleteHandler);
+
+    // Audio input
+    _server.on("/api/audio", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        request->send(200, "application/json", getAudioJson());
+    });
+
+    AsyncCallbackJsonWebHandler* audioHandler = new AsyncCallbackJsonWebHandler("/api/audio",
+        [this](AsyncWebServerRequest* request, JsonVariant& json) {
+            handleSetAudio(request, json);
+        });
+    _server.addHandler(audioHandler);
+
+    // Sequence playback
+    _server.on("/api/sequence", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        request->send(200, "application/json", getSequenceJson());
+    });
+
+    AsyncCallbackJsonWebHandler* sequenceHandler = new AsyncCallbackJsonWebHandler("/api/sequence",
+        [this](AsyncWebServerRequest* request, JsonVariant& json) {
+            handleSetSequence(request, json);
+        });
+    _server.addHandler(sequenceHandler);
+
     // Calibration endpoints
     _server.on("/api/calibration", HTTP_GET, [this](AsyncWebServerRequest* request) {
         handleGetCalibration(request);
@@ -651,6 +895,32 @@ void WebServer::setupRoutes() {
         });
     _server.addHandler(calibPosHandler);
 
+    // Bulk edits: JSON tuples, or the binary form below
+    AsyncCallbackJsonWebHandler* calibPositionsHandler = new AsyncCallbackJsonWebHandler("/api/calibration/positions",
+        [this](AsyncWebServerRequest* request, JsonVariant& json) {
+            handleSetLEDPositions(request, json);
+        });
+    calibPositionsHandler->setMaxContentLength(CALIBRATION_IMPORT_MAX_BODY);
+    _server.addHandler(calibPositionsHandler);
+
+    // Non-JSON bodies on the same path are collected and parsed as binary records
+    _server.on("/api/calibration/positions", HTTP_POST,
+        [this](AsyncWebServerRequest* request) {
+            handleSetLEDPositionsBinary(request);
+        },
+        nullptr,
+        [](AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+            if (total > BULK_RECORD_SIZE * NUM_LEDS) {
+                return;
+            }
+            if (index == 0) {
+                request->_tempObject = malloc(total);
+            }
+            if (request->_tempObject) {
+                memcpy((uint8_t*)request->_tempObject + index, data, len);
+            }
+        });
+
     AsyncCallbackJsonWebHandler* calibSaveHandler = new AsyncCallbackJsonWebHandler("/api/calibration/save",
         [this](AsyncWebServerRequest* request, JsonVariant& json) {
             handleSaveCalibration(request);
@@ -662,17 +932,385 @@ void WebServer::setupRoutes() {
             handleResetCalibration(request);
         });
     _server.addHandler(calibResetHandler);
+
+    AsyncCallbackJsonWebHandler* calibImportHandler = new AsyncCallbackJsonWebHandler("/api/calibration/import",
+        [this](AsyncWebServerRequest* request, JsonVariant& json) {
+            handleImportCalibration(request, json);
+        });
+    calibImportHandler->setMaxContentLength(CALIBRATION_IMPORT_MAX_BODY);
+    _server.addHandler(calibImportHandler);
+
+    AsyncCallbackJsonWebHandler* grayCodeHandler = new AsyncCallbackJsonWebHandler("/api/calibration/graycode",
+        [this](AsyncWebServerRequest* request, JsonVariant& json) {
+            handleGrayCode(request, json);
+        });
+    _server.addHandler(grayCodeHandler);
 }
 
 void WebServer::handleGetState(AsyncWebServerRequest* request) {
     request->send(200, "application/json", getStateJson());
 }
 
+void WebServer::handleSetSegment(AsyncWebServerRequest* request, JsonVariant& json) {
+    JsonObject obj = json.as<JsonObject>();
+    if (!obj.containsKey("index")) {
+        request->send(400, "application/json", "{\"ok\":false,\"error\":\"Missing index\"}");
+        return;
+    }
+    uint8_t index = obj["index"].as<uint8_t>();
+    if (index >= MAX_SEGMENTS) {
+        request->send(400, "application/json", "{\"ok\":false,\"error\":\"Invalid index\"}");
+        return;
+    }
+
+    if (!(obj["enabled"] | true)) {
+        _ledController.clearSegment(index);
+        request->send(200, "application/json", getStateJson());
+        return;
+    }
+
+    // Unspecified fields keep the segment's current settings
+    const Segment& segment = _ledController.getSegment(index);
+    const AnimationInstance& anim = segment.anim;
+    bool existing = segment.enabled;
+    const char* name = obj["name"] | (existing ? segment.name : "");
+    uint16_t start = obj["start"] | (existing ? anim.start : (uint16_t)0);
+    uint16_t length = obj["length"] | (existing ? anim.count : (uint16_t)0);
+    bool reverse = obj["reverse"] | (existing && anim.reverse);
+    AnimationMode mode = static_cast<AnimationMode>(obj["mode"] | (existing ? static_cast<int>(anim.mode) : 0));
+    CRGB color = existing ? anim.color : _ledController.getSolidColor();
+    if (obj.containsKey("color")) {
+        JsonObject c = obj["color"];
+        color = CRGB(c["r"] | 0, c["g"] | 0, c["b"] | 0);
+    }
+    uint16_t speed = obj["speed"] | (existing ? anim.speed : (uint16_t)DEFAULT_ANIMATION_SPEED);
+
+    // Copy the name: it may point into the segment being replaced
+    char nameCopy[SEGMENT_NAME_LENGTH];
+    strlcpy(nameCopy, name, sizeof(nameCopy));
+    if (!_ledController.setSegment(index, nameCopy, start, length, reverse, mode, color, speed)) {
+        request->send(400, "application/json",
+                      "{\"ok\":false,\"error\":\"Span out of range or overlapping, invalid mode, or no free buffer\"}");
+        return;
+    }
+    request->send(200, "application/json", getStateJson());
+}
+
+void WebServer::handleSetSchedule(AsyncWebServerRequest* request, JsonVariant& json) {
+    // Parsed into a copy here and swapped in by the main loop's scheduler.update()
+    ScheduleConfig config;
+    _scheduler.getConfig(config);
+    if (!ScheduleStore::fromJson(json.as<JsonObjectConst>(), config)) {
+        request->send(400, "application/json", "{\"ok\":false,\"error\":\"Invalid schedule\"}");
+        return;
+    }
+    if (!_scheduler.submit(config)) {
+        request->send(503, "application/json", "{\"ok\":false,\"error\":\"Schedule busy, try again\"}");
+        return;
+    }
+    ScheduleStore::save(_scheduler, _calibration.isSDAvailable());
+    request->send(200, "application/json", getScheduleJson());
+}
+
+void WebServer::handleSetClock(AsyncWebServerRequest* request, JsonVariant& json) {
+    JsonObject obj = json.as<JsonObject>();
+    if (!obj.containsKey("epoch")) {
+        request->send(400, "application/json", "{\"ok\":false,\"error\":\"Missing epoch\"}");
+        return;
+    }
+    _clock.setEpoch(obj["epoch"].as<uint32_t>());
+    request->send(200, "application/json", getClockJson());
+}
+
+String WebServer::getScheduleJson() {
+    JsonDocument doc;
+    ScheduleStore::toJson(_scheduler, doc.to<JsonObject>());
+    String output;
+    serializeJson(doc, output);
+    return output;
+}
+
+String WebServer::getClockJson() {
+    JsonDocument doc;
+    uint16_t minute;
+    uint8_t weekday;
+    bool set = _clock.localTime(minute, weekday);
+    doc["set"] = set;
+    doc["epoch"] = _clock.getEpoch();
+    if (set) {
+        char time[6];
+        snprintf(time, sizeof(time), "%02u:%02u", minute / 60, minute % 60);
+        doc["local"] = time;
+        doc["weekday"] = weekday;
+    }
+    String output;
+    serializeJson(doc, output);
+    return output;
+}
+
+void WebServer::handleSavePreset(AsyncWebServerRequest* request, JsonVariant& json) {
+    JsonObject obj = json.as<JsonObject>();
+    uint8_t index = obj["index"] | MAX_PRESETS;
+    if (!_presets.save(index, obj["name"] | "")) {
+        request->send(400, "application/json", "{\"ok\":false,\"error\":\"Invalid preset index\"}");
+        return;
+    }
+    request->send(200, "application/json", getPresetsJson());
+}
+
+void WebServer::handleDeletePreset(AsyncWebServerRequest* request, JsonVariant& json) {
+    JsonObject obj = json.as<JsonObject>();
+    if (!_presets.remove(obj["index"] | MAX_PRESETS)) {
+        request->send(400, "application/json", "{\"ok\":false,\"error\":\"Invalid preset index\"}");
+        return;
+    }
+    request->send(200, "application/json", getPresetsJson());
+}
+
+void WebServer::handleRecallPreset(AsyncWebServerRequest* request) {
+    const AsyncWebParameter* param = request->hasParam("index", true) ? request->getParam("index", true)
+                                                                      : request->getParam("index");
+    if (!param || !_presets.recall(param->value().toInt())) {
+        request->send(404, "application/json", "{\"ok\":false,\"error\":\"No such preset\"}");
+        return;
+    }
+    // Applied by the main loop before the next frame
+    request->send(202, "application/json", "{\"ok\":true}");
+}
+
+String WebServer::getPresetsJson() {
+    JsonDocument doc;
+    JsonArray presets = doc["presets"].to<JsonArray>();
+    for (uint8_t i = 0; i < MAX_PRESETS; i++) {
+        if (!_presets.isUsed(i)) continue;
+        JsonObject preset = presets.add<JsonObject>();
+        preset["index"] = i;
+        preset["name"] = _presets.getName(i);
+    }
+    String output;
+    serializeJson(doc, output);
+    return output;
+}
+
+void WebServer::handleSetAudio(AsyncWebServerRequest* request, JsonVariant& json) {
+    JsonObject obj = json.as<JsonObject>();
+    if (obj.containsKey("source")) {
+        uint8_t source = obj["source"].as<uint8_t>();
+        if (source > AUDIO_SOURCE_UDP) {
+            request->send(400, "application/json", "{\"ok\":false,\"error\":\"Invalid source\"}");
+            return;
+        }
+        _audio.setSource(source);
+    }
+    request->send(200, "application/json", getAudioJson());
+}
+
+String WebServer::getAudioJson() {
+    AudioSnapshot snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    _audio.getAnalyzer().read(snapshot);
+
+    JsonDocument doc;
+    doc["source"] = _audio.getSource();
+    doc["receiving"] = _audio.isReceiving();
+    doc["level"] = snapshot.level;
+    doc["beats"] = snapshot.beats;
+    doc["blocks"] = snapshot.blocks;
+    JsonArray bands = doc["bands"].to<JsonArray>();
+    for (uint8_t b = 0; b < AUDIO_BANDS; b++) {
+        bands.add(snapshot.bands[b]);
+    }
+    doc["blockMicros"] = _audio.getBlockMicros();
+    doc["peakBlockMicros"] = _audio.getPeakBlockMicros();
+
+    String output;
+    serializeJson(doc, output);
+    return output;
+}
+
+void WebServer::handleSetSequence(AsyncWebServerRequest* request, JsonVariant& json) {
+    JsonObject obj = json.as<JsonObject>();
+    bool stop = obj["stop"] | false;
+    if (stop) {
+        _sequence.stop();
+    } else if (!_sequence.play(obj["name"] | "", obj["loop"] | false)) {
+        request->send(400, "application/json", "{\"ok\":false,\"error\":\"Invalid sequence name\"}");
+        return;
+    }
+    // Opened by the main loop; errors show up in GET /api/sequence
+    request->send(202, "application/json", "{\"ok\":true}");
+}
+
+String WebServer::getSequenceJson() {
+    static const char* compressionNames[] = { "none", "zstd", "zlib" };
+    JsonDocument doc;
+    doc["playing"] = _sequence.isPlaying();
+    doc["name"] = _sequence.getName();
+    doc["loop"] = _sequence.isLooping();
+    doc["error"] = _sequence.getError();
+    if (_sequence.isPlaying()) {
+        doc["frame"] = _sequence.getFrame();
+        doc["frames"] = _sequence.getFrameCount();
+        doc["stepMs"] = _sequence.getStepMs();
+        doc["channels"] = _sequence.getChannelCount();
+        doc["compression"] = compressionNames[_sequence.getCompression()];
+    }
+
+    JsonObject stats = doc["stats"].to<JsonObject>();
+    stats["framesShown"] = _sequence.getFramesShown();
+    stats["underruns"] = _sequence.getUnderruns();
+    stats["decodeMicros"] = _sequence.getDecodeMicros();
+    stats["peakDecodeMicros"] = _sequence.getPeakDecodeMicros();
+
+    JsonArray files = doc["files"].to<JsonArray>();
+    if (_calibration.isSDAvailable()) {
+        File dir = SD.open(SEQUENCE_DIR);
+        if (dir && dir.isDirectory()) {
+            for (File entry = dir.openNextFile(); entry; entry = dir.openNextFile()) {
+                if (!entry.isDirectory()) {
+                    files.add(String(entry.name()));
+                }
+                entry.close();
+            }
+        }
+        dir.close();
+    }
+
+    String output;
+    serializeJson(doc, output);
+    return output;
+}
+
+void WebServer::handleSetParticles(AsyncWebServerRequest* request, JsonVariant& json) {
+    JsonObject obj = json.as<JsonObject>();
+    if (!obj.containsKey("emitter")) {
+        request->send(400, "application/json", "{\"ok\":false,\"error\":\"Missing emitter\"}");
+        return;
+    }
+    uint8_t index = obj["emitter"].as<uint8_t>();
+    if (index >= PARTICLE_EMITTERS) {
+        request->send(400, "application/json", "{\"ok\":false,\"error\":\"Invalid emitter\"}");
+        return;
+    }
+    if (obj["reset"] | false) {
+        _ledController.resetParticleEmitter(index);
+        request->send(200, "application/json", getParticlesJson());
+        return;
+    }
+
+    // Unspecified fields keep the emitter's current settings
+    ParticleEmitter emitter = _ledController.getParticles().getEmitter(index);
+    emitter.shape = obj["shape"] | emitter.shape;
+    emitter.rate = obj["rate"] | emitter.rate;
+    emitter.burst = obj["burst"] | emitter.burst;
+    emitter.speed = obj["speed"] | emitter.speed;
+    emitter.spread = obj["spread"] | emitter.spread;
+    emitter.gravity = obj["gravity"] | emitter.gravity;
+    emitter.drag = obj["drag"] | emitter.drag;
+    emitter.jitter = obj["jitter"] | emitter.jitter;
+    emitter.lifeMs = obj["lifeMs"] | emitter.lifeMs;
+    emitter.fadeMs = obj["fadeMs"] | emitter.fadeMs;
+    emitter.randomHue = obj["randomHue"] | emitter.randomHue;
+    if (obj.containsKey("color")) {
+        JsonObject c = obj["color"];
+        emitter.r = c["r"] | 0;
+        emitter.g = c["g"] | 0;
+        emitter.b = c["b"] | 0;
+    }
+    if (emitter.shape >= PARTICLE_SHAPE_COUNT || emitter.rate < 0 || emitter.drag < 0) {
+        request->send(400, "application/json", "{\"ok\":false,\"error\":\"Invalid emitter settings\"}");
+        return;
+    }
+
+    _ledController.setParticleEmitter(index, emitter);
+    request->send(200, "application/json", getParticlesJson());
+}
+
+String WebServer::getParticlesJson() {
+    static const char* emitterNames[PARTICLE_EMITTERS] = { "snow", "fireworks", "embers" };
+    const ParticleSystem& particles = _ledController.getParticles();
+
+    JsonDocument doc;
+    doc["capacity"] = particles.getCapacity();
+    doc["live"] = particles.getCount();
+    doc["frameMicros"] = _ledController.getParticleMicros();
+
+    JsonArray emitters = doc["emitters"].to<JsonArray>();
+    for (uint8_t e = 0; e < PARTICLE_EMITTERS; e++) {
+        const ParticleEmitter& emitter = particles.getEmitter(e);
+        JsonObject entry = emitters.add<JsonObject>();
+        entry["name"] = emitterNames[e];
+        entry["shape"] = emitter.shape;
+        entry["rate"] = emitter.rate;
+        entry["burst"] = emitter.burst;
+        entry["speed"] = emitter.speed;
+        entry["spread"] = emitter.spread;
+        entry["gravity"] = emitter.gravity;
+        entry["drag"] = emitter.drag;
+        entry["jitter"] = emitter.jitter;
+        entry["lifeMs"] = emitter.lifeMs;
+        entry["fadeMs"] = emitter.fadeMs;
+        entry["color"]["r"] = emitter.r;
+        entry["color"]["g"] = emitter.g;
+        entry["color"]["b"] = emitter.b;
+        entry["randomHue"] = emitter.randomHue;
+    }
+
+    String output;
+    serializeJson(doc, output);
+    return output;
+}
+
+void WebServer::handleSetLayer(AsyncWebServerRequest* request, JsonVariant& json) {
+    JsonObject obj = json.as<JsonObject>();
+    if (!obj.containsKey("layer")) {
+        request->send(400, "application/json", "{\"ok\":false,\"error\":\"Missing layer\"}");
+        return;
+    }
+    uint8_t index = obj["layer"].as<uint8_t>();
+    if (index >= OVERLAY_LAYERS) {
+        request->send(400, "application/json", "{\"ok\":false,\"error\":\"Invalid layer\"}");
+        return;
+    }
+
+    if (!(obj["enabled"] | true)) {
+        _ledController.clearLayer(index);
+        request->send(200, "application/json", getStateJson());
+        return;
+    }
+
+    // Unspecified fields keep the layer's current settings
+    const Layer& layer = _ledController.getLayer(index);
+    AnimationMode mode = static_cast<AnimationMode>(obj["mode"] | static_cast<int>(layer.anim.mode));
+    CRGB color = layer.enabled ? layer.anim.color : _ledController.getSolidColor();
+    if (obj.containsKey("color")) {
+        JsonObject c = obj["color"];
+        color = CRGB(c["r"] | 0, c["g"] | 0, c["b"] | 0);
+    }
+    uint16_t speed = obj["speed"] | (layer.enabled ? layer.anim.speed : (uint16_t)DEFAULT_ANIMATION_SPEED);
+    uint8_t opacity = obj["opacity"] | layer.opacity;
+    BlendMode blend = static_cast<BlendMode>(obj["blend"] | static_cast<int>(layer.blend));
+
+    if (!_ledController.setLayer(index, mode, color, speed, opacity, blend)) {
+        request->send(400, "application/json", "{\"ok\":false,\"error\":\"Invalid layer settings or no free buffer\"}");
+        return;
+    }
+    request->send(200, "application/json", getStateJson());
+}
+
 void WebServer::handleSetPower(AsyncWebServerRequest* request, JsonVariant& json) {
     JsonObject obj = json.as<JsonObject>();
     if (obj.containsKey("on")) {
         _ledController.setOn(obj["on"].as<bool>());
     }
+    if (obj.containsKey("budgetMa")) {
+        // Same budget for every output (0 = no limit)
+        OutputStage& stage = _ledController.getOutputStage();
+        for (uint8_t o = 0; o < stage.getPowerOutputCount(); o++) {
+            stage.setPowerOutput(o, stage.getPowerOutputStart(o), stage.getPowerOutputLength(o),
+                                  obj["budgetMa"].as<uint32_t>());
+        }
+    }
     request->send(200, "application/json", getStateJson());
 }
 
@@ -709,6 +1347,49 @@ void WebServer::handleSetSpeed(AsyncWebServerRequest* request, JsonVariant& json
     request->send(200, "application/json", getStateJson());
 }
 
+void WebServer::handleSetOutput(AsyncWebServerRequest* request, JsonVariant& json) {
+    OutputStage& stage = _ledController.getOutputStage();
+    JsonObject obj = json.as<JsonObject>();
+
+    if (obj["gamma"].is<JsonArray>()) {
+        JsonArray g = obj["gamma"].as<JsonArray>();
+        stage.setGamma(g[0] | 2.2f, g[1] | 2.2f, g[2] | 2.2f);
+    } else if (obj.containsKey("gamma")) {
+        float g = obj["gamma"].as<float>();
+        stage.setGamma(g, g, g);
+    }
+    if (obj.containsKey("correction")) {
+        JsonObject c = obj["correction"];
+        stage.setColorCorrection(CRGB(c["r"] | 255, c["g"] | 255, c["b"] | 255));
+    }
+    if (obj.containsKey("dither")) {
+        stage.setDithering(obj["dither"].as<bool>());
+    }
+    if (obj.containsKey("mapping")) {
+        stage.setMapping((OutputMapping)obj["mapping"].as<uint8_t>());
+    }
+    _ledController.show();
+
+    request->send(200, "application/json", getOutputJson());
+}
+
+void WebServer::handleSetFrameCache(AsyncWebServerRequest* request, JsonVariant& json) {
+    JsonObject obj = json.as<JsonObject>();
+    if (obj.containsKey("enabled")) {
+        _ledController.setFrameCache(obj["enabled"].as<bool>());
+    }
+    request->send(200, "application/json", getStateJson());
+}
+
+void WebServer::handleSetTransition(AsyncWebServerRequest* request, JsonVariant& json) {
+    JsonObject obj = json.as<JsonObject>();
+    uint16_t duration = obj["duration"] | _ledController.getTransitionDuration();
+    uint8_t type = obj["type"] | _ledController.getTransitionType();
+    uint8_t axis = obj["axis"] | (uint8_t)_ledController.getTransitionAxis();
+    _ledController.setTransition(duration, type, (SortOrder)axis);
+    request->send(200, "application/json", getStateJson());
+}
+
 void WebServer::handleGetCalibration(AsyncWebServerRequest* request) {
     request->send(200, "application/json", getCalibrationJson());
 }
@@ -734,6 +1415,61 @@ void WebServer::handleSetLEDPosition(AsyncWebServerRequest* request, JsonVariant
     request->send(200, "application/json", "{\"ok\":true}");
 }
 
+void WebServer::handleSetLEDPositions(AsyncWebServerRequest* request, JsonVariant& json) {
+    // { "positions": [[led, x, y, z], ...] }
+    JsonArray tuples = json["positions"].as<JsonArray>();
+    if (tuples.isNull() || tuples.size() > NUM_LEDS) {
+        request->send(400, "application/json", "{\"ok\":false,\"error\":\"Expected up to one [led, x, y, z] per LED\"}");
+        return;
+    }
+
+    static uint16_t indices[NUM_LEDS];
+    static LEDPosition positions[NUM_LEDS];
+    uint16_t count = 0;
+    for (JsonArray t : tuples) {
+        if (t.size() != 4) {
+            request->send(400, "application/json", "{\"ok\":false,\"error\":\"Expected [led, x, y, z]\"}");
+            return;
+        }
+        indices[count] = t[0].as<uint16_t>();
+        positions[count] = { t[1].as<float>(), t[2].as<float>(), t[3].as<float>() };
+        count++;
+    }
+
+    if (!_calibration.setPositions(indices, positions, count)) {
+        request->send(400, "application/json", "{\"ok\":false,\"error\":\"LED index out of range\"}");
+        return;
+    }
+    request->send(200, "application/json", "{\"ok\":true}");
+}
+
+void WebServer::handleSetLEDPositionsBinary(AsyncWebServerRequest* request) {
+    // Little-endian records of (uint16 led, int16 x, int16 y, int16 z), coordinates scaled by 32767
+    size_t length = request->contentLength();
+    const uint8_t* body = (const uint8_t*)request->_tempObject;
+    if (!body || length == 0 || length % BULK_RECORD_SIZE != 0) {
+        request->send(400, "application/json", "{\"ok\":false,\"error\":\"Expected 8-byte records, one per LED at most\"}");
+        return;
+    }
+
+    static uint16_t indices[NUM_LEDS];
+    static LEDPosition positions[NUM_LEDS];
+    uint16_t count = length / BULK_RECORD_SIZE;
+    for (uint16_t i = 0; i < count; i++) {
+        const uint8_t* r = body + i * BULK_RECORD_SIZE;
+        indices[i] = (uint16_t)(r[0] | (r[1] << 8));
+        positions[i].x = (int16_t)(r[2] | (r[3] << 8)) / 32767.0f;
+        positions[i].y = (int16_t)(r[4] | (r[5] << 8)) / 32767.0f;
+        positions[i].z = (int16_t)(r[6] | (r[7] << 8)) / 32767.0f;
+    }
+
+    if (!_calibration.setPositions(indices, positions, count)) {
+        request->send(400, "application/json", "{\"ok\":false,\"error\":\"LED index out of range\"}");
+        return;
+    }
+    request->send(200, "application/json", "{\"ok\":true}");
+}
+
 void WebServer::handleSaveCalibration(AsyncWebServerRequest* request) {
     bool success = _calibration.save();
     if (success) {
@@ -748,6 +1484,72 @@ void WebServer::handleResetCalibration(AsyncWebServerRequest* request) {
     request->send(200, "application/json", getCalibrationJson());
 }
 
+void WebServer::handleImportCalibration(AsyncWebServerRequest* request, JsonVariant& json) {
+    // { "views": [ { "angle": 0, "points": [[u, v], null, ...] }, ... ] }
+    // One entry per LED in strip order; null (or a short array) = not visible in that photo
+    JsonArray views = json["views"].as<JsonArray>();
+    if (views.isNull() || views.size() < 2) {
+        request->send(400, "application/json", "{\"ok\":false,\"error\":\"Need at least 2 views\"}");
+        return;
+    }
+
+    TriangulationSolver solver(NUM_LEDS);
+    static ImagePoint points[NUM_LEDS];
+    for (JsonObject view : views) {
+        JsonArray coords = view["points"].as<JsonArray>();
+        for (uint16_t i = 0; i < NUM_LEDS; i++) {
+            JsonArray p = coords[i].as<JsonArray>();
+            points[i].seen = !p.isNull() && p.size() >= 2;
+            points[i].u = points[i].seen ? p[0].as<float>() : 0;
+            points[i].v = points[i].seen ? p[1].as<float>() : 0;
+        }
+        if (!solver.addView(view["angle"] | 0.0f, points)) {
+            request->send(400, "application/json", "{\"ok\":false,\"error\":\"Too many views\"}");
+            return;
+        }
+    }
+
+    static LEDPosition solved[NUM_LEDS];
+    if (!solver.solve(solved)) {
+        request->send(422, "application/json", "{\"ok\":false,\"error\":\"Too few LEDs seen in 2+ views\"}");
+        return;
+    }
+    _calibration.setPositions(solved);
+    Serial.printf("Calibration import: %u triangulated, %u interpolated, rms %.3f\n",
+                  solver.getTriangulatedCount(), solver.getInterpolatedCount(), solver.getRmsError());
+
+    JsonDocument doc;
+    doc["ok"] = true;
+    doc["triangulated"] = solver.getTriangulatedCount();
+    doc["interpolated"] = solver.getInterpolatedCount();
+    doc["rmsError"] = solver.getRmsError();
+    String output;
+    serializeJson(doc, output);
+    request->send(200, "application/json", output);
+}
+
+void WebServer::handleGrayCode(AsyncWebServerRequest* request, JsonVariant& json) {
+    JsonObject obj = json.as<JsonObject>();
+    if (obj.containsKey("active")) {
+        if (obj["active"].as<bool>()) {
+            _ledController.startGrayCode(obj["hold"] | (uint16_t)GRAYCODE_DEFAULT_HOLD, obj["repeat"] | false);
+        } else {
+            _ledController.stopGrayCode();
+        }
+    }
+
+    JsonDocument doc;
+    doc["active"] = _ledController.isGrayCodeActive();
+    doc["frame"] = _ledController.getGrayCodeFrame();
+    doc["frames"] = grayCodeFrameCount(NUM_LEDS);
+    doc["bits"] = grayCodeBits(NUM_LEDS);
+    doc["hold"] = _ledController.getGrayCodeHold();
+    doc["leds"] = NUM_LEDS;
+    String output;
+    serializeJson(doc, output);
+    request->send(200, "application/json", output);
+}
+
 String WebServer::getStateJson() {
     JsonDocument doc;
     doc["on"] = _ledController.isOn();
@@ -761,6 +1563,95 @@ String WebServer::getStateJson() {
     doc["animation"] = static_cast<int>(_ledController.getAnimation());
     doc["speed"] = _ledController.getAnimationSpeed();
 
+    // Estimated supply current and limiter activity from the last output refresh
+    OutputStage& stage = _ledController.getOutputStage();
+    JsonObject power = doc["power"].to<JsonObject>();
+    power["mA"] = stage.getEstimatedMilliamps();
+    power["limiting"] = stage.isLimiting();
+    JsonArray outputs = power["outputs"].to<JsonArray>();
+    for (uint8_t o = 0; o < stage.getPowerOutputCount(); o++) {
+        JsonObject out = outputs.add<JsonObject>();
+        out["mA"] = stage.getEstimatedMilliamps(o);
+        out["requestedMa"] = stage.getRequestedMilliamps(o);
+        out["budgetMa"] = stage.getPowerBudget(o);
+        out["scale"] = stage.getLimiterScale(o) * 100 / 256;  // Percent of requested
+    }
+
+    JsonObject transition = doc["transition"].to<JsonObject>();
+    transition["durationMs"] = _ledController.getTransitionDuration();
+    transition["type"] = _ledController.getTransitionType();
+    transition["axis"] = static_cast<int>(_ledController.getTransitionAxis());
+    transition["active"] = _ledController.isTransitioning();
+    transition["progress"] = _ledController.getTransitionProgress() * 100 / 255;
+    transition["frameMicros"] = _ledController.getTransitionMicros();
+    transition["peakMicros"] = _ledController.getTransitionPeakMicros();
+
+    JsonArray layers = doc["layers"].to<JsonArray>();
+    for (uint8_t l = 0; l < OVERLAY_LAYERS; l++) {
+        const Layer& layer = _ledController.getLayer(l);
+        JsonObject entry = layers.add<JsonObject>();
+        entry["enabled"] = layer.enabled;
+        if (!layer.enabled) continue;
+        entry["mode"] = static_cast<int>(layer.anim.mode);
+        entry["color"]["r"] = layer.anim.color.r;
+        entry["color"]["g"] = layer.anim.color.g;
+        entry["color"]["b"] = layer.anim.color.b;
+        entry["speed"] = layer.anim.speed;
+        entry["opacity"] = layer.opacity;
+        entry["blend"] = static_cast<int>(layer.blend);
+    }
+    doc["layerMicros"] = _ledController.getLayerMicros();
+    doc["noiseMicros"] = _ledController.getNoiseMicros();
+
+    const FrameCache& cache = _ledController.getFrameCache();
+    JsonObject frameCache = doc["frameCache"].to<JsonObject>();
+    uint32_t lookups = cache.getHits() + cache.getMisses();
+    frameCache["enabled"] = cache.isEnabled();
+    frameCache["bytes"] = cache.getBytes();
+    frameCache["frames"] = cache.getFilled();
+    frameCache["cycle"] = ANIMATION_PHASE_STEPS;
+    frameCache["hits"] = cache.getHits();
+    frameCache["misses"] = cache.getMisses();
+    frameCache["hitRate"] = lookups ? (uint32_t)((uint64_t)cache.getHits() * 100 / lookups) : 0;  // Percent
+
+    JsonArray segments = doc["segments"].to<JsonArray>();
+    for (uint8_t i = 0; i < MAX_SEGMENTS; i++) {
+        const Segment& segment = _ledController.getSegment(i);
+        JsonObject entry = segments.add<JsonObject>();
+        entry["enabled"] = segment.enabled;
+        if (!segment.enabled) continue;
+        entry["name"] = segment.name;
+        entry["start"] = segment.anim.start;
+        entry["length"] = segment.anim.count;
+        entry["reverse"] = segment.anim.reverse;
+        entry["mode"] = static_cast<int>(segment.anim.mode);
+        entry["color"]["r"] = segment.anim.color.r;
+        entry["color"]["g"] = segment.anim.color.g;
+        entry["color"]["b"] = segment.anim.color.b;
+        entry["speed"] = segment.anim.speed;
+    }
+
+    String output;
+    serializeJson(doc, output);
+    return output;
+}
+
+String WebServer::getOutputJson() {
+    OutputStage& stage = _ledController.getOutputStage();
+    JsonDocument doc;
+
+    JsonArray gamma = doc["gamma"].to<JsonArray>();
+    for (uint8_t c = 0; c < 3; c++) {
+        gamma.add(stage.getGamma(c));
+    }
+    CRGB correction = stage.getColorCorrection();
+    doc["correction"]["r"] = correction.r;
+    doc["correction"]["g"] = correction.g;
+    doc["correction"]["b"] = correction.b;
+    doc["dither"] = stage.isDithering();
+    doc["mapping"] = static_cast<int>(stage.getMapping());
+    doc["renderMicros"] = stage.getLastRenderMicros();
+
     String output;
     serializeJson(doc, output);
     return output;
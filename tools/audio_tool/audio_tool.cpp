@@ -0,0 +1,245 @@
+// Host-side check for the audio analysis stage.
+//
+// `gen` writes a synthetic WAV (kick drum at a given tempo and/or a steady
+// tone); `analyze` runs any 16-bit PCM WAV through the same AudioAnalyzer
+// the controller uses and prints the beats it found, the mean level of
+// each band and the CPU time per analysis block. -e and -p turn it into a
+// pass/fail check against the expected tempo or loudest band.
+//
+// Build:  g++ -O2 -std=c++17 -I../../include audio_tool.cpp ../../src/audio_analyzer.cpp -o audio_tool
+// Usage:  audio_tool gen -b 120 -f 1000 -t 10 test.wav
+//         audio_tool analyze -e 120 test.wav
+//         audio_tool analyze -p 4 tone.wav
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "audio_analyzer.h"
+
+static const double TWO_PI = 6.283185307179586;
+
+static void put16(FILE* f, uint16_t v) { fputc(v & 0xFF, f); fputc(v >> 8, f); }
+static void put32(FILE* f, uint32_t v) { put16(f, v & 0xFFFF); put16(f, v >> 16); }
+static uint16_t get16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+static uint32_t get32(const uint8_t* p) { return get16(p) | ((uint32_t)get16(p + 2) << 16); }
+
+static bool writeWav(const char* path, const std::vector<int16_t>& samples, uint32_t rate) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    uint32_t bytes = (uint32_t)samples.size() * 2;
+    fwrite("RIFF", 1, 4, f); put32(f, 36 + bytes); fwrite("WAVE", 1, 4, f);
+    fwrite("fmt ", 1, 4, f); put32(f, 16); put16(f, 1); put16(f, 1);
+    put32(f, rate); put32(f, rate * 2); put16(f, 2); put16(f, 16);
+    fwrite("data", 1, 4, f); put32(f, bytes);
+    for (int16_t s : samples) put16(f, (uint16_t)s);
+    fclose(f);
+    return true;
+}
+
+// 16-bit PCM, any channel count (mixed to mono), any rate (linear resample)
+static bool readWav(const char* path, std::vector<int16_t>& out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    std::vector<uint8_t> file;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) file.insert(file.end(), chunk, chunk + n);
+    fclose(f);
+
+    if (file.size() < 12 || memcmp(&file[0], "RIFF", 4) || memcmp(&file[8], "WAVE", 4)) {
+        fprintf(stderr, "%s: not a WAV file\n", path);
+        return false;
+    }
+    uint16_t channels = 0, bits = 0;
+    uint32_t rate = 0;
+    size_t pos = 12;
+    const uint8_t* data = nullptr;
+    uint32_t dataBytes = 0;
+    while (pos + 8 <= file.size()) {
+        uint32_t size = get32(&file[pos + 4]);
+        const uint8_t* body = &file[pos + 8];
+        if (!memcmp(&file[pos], "fmt ", 4) && size >= 16) {
+            if (get16(body) != 1) {
+                fprintf(stderr, "%s: only PCM is supported\n", path);
+                return false;
+            }
+            channels = get16(body + 2);
+            rate = get32(body + 4);
+            bits = get16(body + 14);
+        } else if (!memcmp(&file[pos], "data", 4)) {
+            data = body;
+            dataBytes = (uint32_t)std::min<size_t>(size, file.size() - pos - 8);
+        }
+        pos += 8 + size + (size & 1);
+    }
+    if (!data || channels == 0 || bits != 16) {
+        fprintf(stderr, "%s: need 16-bit PCM\n", path);
+        return false;
+    }
+
+    size_t frames = dataBytes / (2 * channels);
+    std::vector<float> mono(frames);
+    for (size_t i = 0; i < frames; i++) {
+        int32_t sum = 0;
+        for (uint16_t c = 0; c < channels; c++) sum += (int16_t)get16(data + 2 * (i * channels + c));
+        mono[i] = (float)sum / channels;
+    }
+    double ratio = (double)rate / AUDIO_SAMPLE_RATE;
+    size_t count = (size_t)(frames / ratio);
+    out.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        double src = i * ratio;
+        size_t k = (size_t)src;
+        double t = src - k;
+        float next = k + 1 < frames ? mono[k + 1] : mono[k];
+        out[i] = (int16_t)(mono[k] * (1 - t) + next * t);
+    }
+    if (rate != AUDIO_SAMPLE_RATE) {
+        fprintf(stderr, "resampled %u Hz to %u Hz\n", rate, AUDIO_SAMPLE_RATE);
+    }
+    return true;
+}
+
+static int generate(double bpm, double tone, double seconds, const char* path) {
+    size_t count = (size_t)(seconds * AUDIO_SAMPLE_RATE);
+    std::vector<int16_t> samples(count);
+    double beatSamples = bpm > 0 ? 60.0 * AUDIO_SAMPLE_RATE / bpm : 0;
+    srand(1);
+    for (size_t i = 0; i < count; i++) {
+        double v = 0;
+        if (tone > 0) {
+            v += 0.2 * sin(TWO_PI * tone * i / AUDIO_SAMPLE_RATE);
+        }
+        if (beatSamples > 0) {
+            // Kick: 150 -> 50 Hz sweep with a fast decay
+            double t = fmod((double)i, beatSamples) / AUDIO_SAMPLE_RATE;
+            if (t < 0.25) {
+                double freq = 50 + 100 * exp(-t * 30);
+                v += 0.7 * exp(-t * 12) * sin(TWO_PI * freq * t);
+            }
+        }
+        v += 0.005 * ((double)rand() / RAND_MAX - 0.5);  // Room noise
+        samples[i] = (int16_t)std::max(-32767.0, std::min(32767.0, v * 32767));
+    }
+    if (!writeWav(path, samples, AUDIO_SAMPLE_RATE)) {
+        fprintf(stderr, "%s: cannot create\n", path);
+        return 1;
+    }
+    fprintf(stderr, "%s: %.1f s, kick %.0f bpm, tone %.0f Hz\n", path, seconds, bpm, tone);
+    return 0;
+}
+
+static int analyze(const char* path, double expectBpm, int expectBand, bool verbose) {
+    std::vector<int16_t> samples;
+    if (!readWav(path, samples)) return 1;
+
+    AudioAnalyzer analyzer;
+    AudioSnapshot snap;
+    std::vector<double> beatTimes;
+    double bandSum[AUDIO_BANDS] = {};
+    uint32_t blocks = 0;
+    double totalMicros = 0, peakMicros = 0;
+
+    for (size_t pos = 0; pos + AUDIO_HOP_SIZE <= samples.size(); pos += AUDIO_HOP_SIZE) {
+        auto start = std::chrono::steady_clock::now();
+        analyzer.feed(&samples[pos], AUDIO_HOP_SIZE);
+        double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        totalMicros += micros;
+        peakMicros = std::max(peakMicros, micros);
+
+        analyzer.read(snap);
+        blocks++;
+        double t = (double)(pos + AUDIO_HOP_SIZE) / AUDIO_SAMPLE_RATE;
+        for (uint8_t b = 0; b < AUDIO_BANDS; b++) bandSum[b] += snap.bands[b];
+        if (analyzer.lastBlockWasBeat()) beatTimes.push_back(t);
+        if (verbose) {
+            printf("%7.3f %c", t, analyzer.lastBlockWasBeat() ? '*' : ' ');
+            for (uint8_t b = 0; b < AUDIO_BANDS; b++) printf(" %3u", snap.bands[b]);
+            printf("  level %3u\n", snap.level);
+        }
+    }
+    if (blocks == 0) {
+        fprintf(stderr, "%s: too short\n", path);
+        return 1;
+    }
+
+    printf("blocks %u, %.1f us/block average, %.1f us peak (budget %u us)\n", blocks, totalMicros / blocks,
+           peakMicros, (unsigned)(1000000ULL * AUDIO_HOP_SIZE / AUDIO_SAMPLE_RATE));
+    printf("mean band levels:");
+    int loudest = 0;
+    for (uint8_t b = 0; b < AUDIO_BANDS; b++) {
+        printf(" %5.1f", bandSum[b] / blocks);
+        if (bandSum[b] > bandSum[loudest]) loudest = b;
+    }
+    printf("\n");
+
+    double bpm = 0;
+    if (beatTimes.size() >= 2) {
+        std::vector<double> intervals;
+        for (size_t i = 1; i < beatTimes.size(); i++) intervals.push_back(beatTimes[i] - beatTimes[i - 1]);
+        std::sort(intervals.begin(), intervals.end());
+        bpm = 60.0 / intervals[intervals.size() / 2];
+    }
+    printf("beats %zu, tempo %.1f bpm (median interval)\n", beatTimes.size(), bpm);
+
+    bool ok = true;
+    if (expectBpm > 0) {
+        bool match = fabs(bpm - expectBpm) <= expectBpm * 0.05;
+        printf("tempo %s (expected %.0f)\n", match ? "ok" : "MISMATCH", expectBpm);
+        ok &= match;
+    }
+    if (expectBand >= 0) {
+        bool match = loudest == expectBand;
+        printf("loudest band %d %s (expected %d)\n", loudest, match ? "ok" : "MISMATCH", expectBand);
+        ok &= match;
+    }
+    return ok ? 0 : 1;
+}
+
+static void usage() {
+    fprintf(stderr,
+        "usage: audio_tool gen [-b BPM] [-f TONE_HZ] [-t SECONDS] out.wav\n"
+        "       audio_tool analyze [-e BPM] [-p BAND] [-v] in.wav\n"
+        "  gen writes a kick drum at BPM (0 = none) over a tone (0 = none), default 120 bpm, no tone, 10 s\n"
+        "  analyze prints beats, mean band levels and us per block; -e/-p check tempo/loudest band,\n"
+        "  -v prints every block\n");
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        usage();
+        return 2;
+    }
+    bool gen = !strcmp(argv[1], "gen");
+    if (!gen && strcmp(argv[1], "analyze")) {
+        usage();
+        return 2;
+    }
+
+    double bpm = 120, tone = 0, seconds = 10, expectBpm = 0;
+    int expectBand = -1;
+    bool verbose = false;
+    const char* path = nullptr;
+    for (int i = 2; i < argc; i++) {
+        if (!strcmp(argv[i], "-b") && i + 1 < argc) bpm = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-f") && i + 1 < argc) tone = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc) seconds = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-e") && i + 1 < argc) expectBpm = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-p") && i + 1 < argc) expectBand = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-v")) verbose = true;
+        else if (argv[i][0] == '-') { usage(); return 2; }
+        else path = argv[i];
+    }
+    if (!path) {
+        usage();
+        return 2;
+    }
+    return gen ? generate(bpm, tone, seconds, path) : analyze(path, expectBpm, expectBand, verbose);
+}
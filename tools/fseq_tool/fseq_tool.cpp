@@ -0,0 +1,279 @@
+// Host-side generator and checker for FSEQ v2 sequences.
+//
+// `gen` writes a synthetic sequence whose every byte is a known function of
+// frame and channel, optionally as sparse ranges; `check` plays any FSEQ
+// file through the same reader the controller uses, reports decode speed
+// and, with -n, compares a generated file against the pattern it was
+// written with, frame by frame and again after seeking backwards.
+//
+// Build:  g++ -O2 -std=c++17 -DFSEQ_TOOL_ZLIB -I../host -I../../include fseq_tool.cpp
+//             ../../src/fseq_reader.cpp -lz -o fseq_tool
+//         ../host/miniz.h stands in for the miniz inflater in the ESP32 ROM.
+//         Without -DFSEQ_TOOL_ZLIB -I../host -lz only uncompressed files work.
+// Usage:  fseq_tool gen -n 50 -f 2400 -s 25 -c zlib -b 64 show.fseq
+//         fseq_tool check -n 50 show.fseq
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "fseq_reader.h"
+
+#ifdef FSEQ_TOOL_ZLIB
+#include <zlib.h>
+#endif
+
+class FileSource : public FseqSource {
+public:
+    explicit FileSource(FILE* f) : _file(f) {}
+    size_t read(uint32_t offset, uint8_t* buffer, size_t length) override {
+        if (fseek(_file, offset, SEEK_SET) != 0) return 0;
+        return fread(buffer, 1, length, _file);
+    }
+private:
+    FILE* _file;
+};
+
+static uint8_t patternByte(uint32_t frame, uint32_t channel) {
+    return (uint8_t)(channel * 7 + frame * 3 + (channel / 3) * (frame & 15));
+}
+
+// Sparse ranges, as in the file: { first channel, channel count }
+struct Range {
+    uint32_t start;
+    uint32_t count;
+};
+
+// What a reader should produce for a channel: the pattern where the file
+// carries it, zero where it doesn't
+static uint8_t expectedByte(const std::vector<Range>& ranges, uint32_t frame, uint32_t channel) {
+    if (ranges.empty()) return patternByte(frame, channel);
+    for (const Range& r : ranges) {
+        if (channel >= r.start && channel < r.start + r.count) return patternByte(frame, channel);
+    }
+    return 0;
+}
+
+static void putLE(std::vector<uint8_t>& out, size_t at, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) out[at + i] = (uint8_t)(value >> (8 * i));
+}
+
+static void usage() {
+    fprintf(stderr,
+        "usage: fseq_tool gen -n LEDS [-f FRAMES] [-s STEP_MS] [-c none|zlib] [-b FRAMES_PER_BLOCK]\n"
+        "                     [-r START,COUNT]... out.fseq\n"
+        "       fseq_tool check [-n LEDS] [-o FIRST_CHANNEL] [-r START,COUNT]... in.fseq\n"
+        "  gen writes 3*LEDS channels per frame (default 1000 frames at 25 ms), or\n"
+        "  only the given channel ranges as a sparse file\n"
+        "  check decodes every frame; with -n it also verifies a generated file\n"
+        "  (pass gen's -r ranges so it knows which channels should read zero)\n");
+}
+
+static int generate(uint32_t leds, uint32_t frames, uint8_t step, bool zlib, uint32_t perBlock,
+                    const std::vector<Range>& ranges, const char* path) {
+    uint32_t channels = leds * 3;
+    if (!ranges.empty()) {
+        channels = 0;
+        for (const Range& r : ranges) channels += r.count;
+    }
+    uint32_t blocks = zlib ? (frames + perBlock - 1) / perBlock : 0;
+    if (blocks > 4095) {
+        fprintf(stderr, "too many blocks, raise -b\n");
+        return 1;
+    }
+    if (ranges.size() > 255) {
+        fprintf(stderr, "at most 255 sparse ranges\n");
+        return 1;
+    }
+    uint32_t rangeOffset = 32 + blocks * 8;
+    uint32_t headerLength = rangeOffset + (uint32_t)ranges.size() * 6;
+    uint32_t dataOffset = (headerLength + 3) & ~3u;
+
+    std::vector<uint8_t> header(dataOffset, 0);
+    memcpy(&header[0], "PSEQ", 4);
+    putLE(header, 4, dataOffset, 2);
+    header[6] = 0;
+    header[7] = 2;
+    putLE(header, 8, headerLength, 2);
+    putLE(header, 10, channels, 4);
+    putLE(header, 14, frames, 4);
+    header[18] = step;
+    header[20] = (uint8_t)((zlib ? FSEQ_COMPRESSION_ZLIB : FSEQ_COMPRESSION_NONE) | ((blocks >> 8) << 4));
+    header[21] = (uint8_t)blocks;
+    header[22] = (uint8_t)ranges.size();
+    for (size_t r = 0; r < ranges.size(); r++) {
+        putLE(header, rangeOffset + r * 6, ranges[r].start, 3);
+        putLE(header, rangeOffset + r * 6 + 3, ranges[r].count, 3);
+    }
+
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> frame(channels);
+    for (uint32_t b = 0; b < (zlib ? blocks : 1); b++) {
+        uint32_t first = zlib ? b * perBlock : 0;
+        uint32_t last = zlib ? std::min(frames, first + perBlock) : frames;
+        std::vector<uint8_t> raw;
+        for (uint32_t f = first; f < last; f++) {
+            if (ranges.empty()) {
+                for (uint32_t c = 0; c < channels; c++) frame[c] = patternByte(f, c);
+            } else {
+                // Sparse: the ranges back to back
+                uint32_t at = 0;
+                for (const Range& r : ranges) {
+                    for (uint32_t c = r.start; c < r.start + r.count; c++) frame[at++] = patternByte(f, c);
+                }
+            }
+            raw.insert(raw.end(), frame.begin(), frame.end());
+        }
+        if (!zlib) {
+            data = raw;
+            break;
+        }
+#ifdef FSEQ_TOOL_ZLIB
+        uLongf size = compressBound(raw.size());
+        std::vector<uint8_t> packed(size);
+        if (compress2(packed.data(), &size, raw.data(), raw.size(), 6) != Z_OK) {
+            fprintf(stderr, "compression failed\n");
+            return 1;
+        }
+        putLE(header, 32 + b * 8, first, 4);
+        putLE(header, 36 + b * 8, (uint32_t)size, 4);
+        data.insert(data.end(), packed.begin(), packed.begin() + size);
+#endif
+    }
+
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "%s: cannot create\n", path);
+        return 1;
+    }
+    fwrite(header.data(), 1, header.size(), f);
+    fwrite(data.data(), 1, data.size(), f);
+    fclose(f);
+    fprintf(stderr, "%s: %u frames of %u channels, %zu bytes\n", path, frames, channels, header.size() + data.size());
+    return 0;
+}
+
+static uint32_t compareFrame(FseqReader& reader, const std::vector<Range>& ranges, uint32_t frame,
+                             uint32_t firstChannel, std::vector<uint8_t>& out) {
+    if (!reader.readFrame(frame, out.data())) return (uint32_t)out.size();
+    uint32_t mismatches = 0;
+    for (uint32_t c = 0; c < out.size(); c++) {
+        if (out[c] != expectedByte(ranges, frame, firstChannel + c)) mismatches++;
+    }
+    return mismatches;
+}
+
+static int check(uint32_t leds, uint32_t firstChannel, const std::vector<Range>& ranges, const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return 1;
+    }
+    FileSource source(f);
+    FseqReader reader;
+    uint32_t window = leds ? leds * 3 : NUM_LEDS * 3;
+    if (!reader.open(&source, firstChannel, window)) {
+        fprintf(stderr, "%s: %s\n", path, reader.getError());
+        fclose(f);
+        return 1;
+    }
+    static const char* names[] = { "none", "zstd", "zlib" };
+    printf("frames %u, step %u ms, channels %u, compression %s, blocks %u\n",
+           reader.getFrameCount(), reader.getStepMs(), reader.getChannelCount(),
+           names[reader.getCompression()], reader.getBlockCount());
+
+    std::vector<uint8_t> out(window);
+    uint32_t mismatches = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < reader.getFrameCount(); frame++) {
+        if (!reader.readFrame(frame, out.data())) {
+            fprintf(stderr, "frame %u: %s\n", frame, reader.getError());
+            fclose(f);
+            return 1;
+        }
+        if (leds) {
+            for (uint32_t c = 0; c < window; c++) {
+                if (out[c] != expectedByte(ranges, frame, firstChannel + c)) mismatches++;
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("decoded in %.3f s (%.1f us/frame)\n", seconds, seconds * 1e6 / reader.getFrameCount());
+
+    // Seeking backwards restarts the block: into an earlier block, back
+    // within the same one, to the start and forward to the end
+    if (leds && reader.getFrameCount() > 1) {
+        uint32_t middle = reader.getFrameCount() / 2;
+        const uint32_t seeks[] = { middle, middle - 1, 0, reader.getFrameCount() - 1, middle };
+        uint32_t seekMismatches = 0;
+        for (uint32_t frame : seeks) {
+            seekMismatches += compareFrame(reader, ranges, frame, firstChannel, out);
+        }
+        printf("seeks to frames %u, %u, 0, %u, %u: %s\n", middle, middle - 1, reader.getFrameCount() - 1, middle,
+               seekMismatches ? "MISMATCH" : "ok");
+        mismatches += seekMismatches;
+    }
+    fclose(f);
+
+    if (leds) {
+        printf("%s\n", mismatches ? "MISMATCH" : "pattern ok");
+    }
+    return mismatches ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        usage();
+        return 2;
+    }
+    bool gen = !strcmp(argv[1], "gen");
+    if (!gen && strcmp(argv[1], "check")) {
+        usage();
+        return 2;
+    }
+
+    uint32_t leds = 0, frames = 1000, perBlock = 64, firstChannel = 0;
+    uint8_t step = 25;
+    bool zlib = false;
+    std::vector<Range> ranges;
+    const char* path = nullptr;
+    for (int i = 2; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) leds = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-f") && i + 1 < argc) frames = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc) step = (uint8_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-b") && i + 1 < argc) perBlock = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc) firstChannel = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-c") && i + 1 < argc) zlib = !strcmp(argv[++i], "zlib");
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+            Range r;
+            if (sscanf(argv[++i], "%u,%u", &r.start, &r.count) != 2 || r.count == 0) {
+                usage();
+                return 2;
+            }
+            ranges.push_back(r);
+        }
+        else if (argv[i][0] == '-') { usage(); return 2; }
+        else path = argv[i];
+    }
+    if (!path) {
+        usage();
+        return 2;
+    }
+
+    if (!gen) {
+        return check(leds, firstChannel, ranges, path);
+    }
+    if (leds == 0 || frames == 0 || step == 0 || perBlock == 0) {
+        usage();
+        return 2;
+    }
+#ifndef FSEQ_TOOL_ZLIB
+    if (zlib) {
+        fprintf(stderr, "built without zlib, rebuild with -DFSEQ_TOOL_ZLIB -lz\n");
+        return 2;
+    }
+#endif
+    return generate(leds, frames, step, zlib, perBlock, ranges, path);
+}
@@ -0,0 +1,491 @@
+// Host-side decoder for the Gray-code calibration sequence.
+//
+// Reads the captured frames (PGM/PPM, in capture order) and prints one view
+// in the format accepted by POST /api/calibration/import:
+//
+//   { "angle": 90, "width": 1280, "height": 720, "points": [[u, v], null, ...] }
+//
+// `gen` renders the sequence a camera would capture of a helix-wound strip
+// (blurred LEDs of uneven brightness, ambient light, sensor noise, some LEDs
+// hidden behind the tree) and writes the frames plus the true pixel
+// positions. `check` renders views at several angles in memory, decodes them
+// with the same code and compares the result with the truth.
+//
+// Build:  g++ -O2 -std=c++17 -I../../include graycode_decoder.cpp -o graycode_decoder
+// Usage:  graycode_decoder -n 50 -a 90 frame_*.pgm > view90.json
+//         graycode_decoder gen -n 50 -a 90 DIR     (DIR/frame_NN.pgm, DIR/truth.json)
+//         graycode_decoder check -n 50
+//
+// Convert camera output first, e.g. `magick IMG_0001.jpg -colorspace gray frame_00.pgm`.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include "gray_code.h"
+
+struct Image {
+    int width = 0;
+    int height = 0;
+    std::vector<float> pixels;  // Luma, 0..1
+};
+
+static bool readToken(FILE* f, std::string& out) {
+    out.clear();
+    int c;
+    // Skip whitespace and comments
+    while ((c = fgetc(f)) != EOF) {
+        if (c == '#') {
+            while ((c = fgetc(f)) != EOF && c != '\n') {}
+        } else if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+            break;
+        }
+    }
+    while (c != EOF && c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+        out += (char)c;
+        c = fgetc(f);
+    }
+    return !out.empty();
+}
+
+// P2/P5 greyscale or P3/P6 colour (converted to luma), 8 or 16 bit
+static bool loadImage(const char* path, Image& img) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+
+    std::string magic, w, h, maxv;
+    if (!readToken(f, magic) || !readToken(f, w) || !readToken(f, h) || !readToken(f, maxv)) {
+        fprintf(stderr, "%s: bad header\n", path);
+        fclose(f);
+        return false;
+    }
+    bool binary = (magic == "P5" || magic == "P6");
+    bool colour = (magic == "P3" || magic == "P6");
+    if (!binary && magic != "P2" && magic != "P3") {
+        fprintf(stderr, "%s: not a PGM/PPM file\n", path);
+        fclose(f);
+        return false;
+    }
+
+    img.width = atoi(w.c_str());
+    img.height = atoi(h.c_str());
+    int maxValue = atoi(maxv.c_str());
+    if (img.width <= 0 || img.height <= 0 || maxValue <= 0 || maxValue > 65535) {
+        fprintf(stderr, "%s: bad header\n", path);
+        fclose(f);
+        return false;
+    }
+
+    int channels = colour ? 3 : 1;
+    int bytesPerSample = maxValue > 255 ? 2 : 1;
+    size_t count = (size_t)img.width * img.height;
+    img.pixels.assign(count, 0.0f);
+
+    auto readSample = [&](unsigned& value) -> bool {
+        if (!binary) {
+            std::string token;
+            if (!readToken(f, token)) return false;
+            value = (unsigned)atoi(token.c_str());
+            return true;
+        }
+        int hi = fgetc(f);
+        if (hi == EOF) return false;
+        if (bytesPerSample == 1) {
+            value = (unsigned)hi;
+            return true;
+        }
+        int lo = fgetc(f);
+        if (lo == EOF) return false;
+        value = ((unsigned)hi << 8) | (unsigned)lo;
+        return true;
+    };
+
+    for (size_t i = 0; i < count; i++) {
+        unsigned s[3] = {0, 0, 0};
+        for (int c = 0; c < channels; c++) {
+            if (!readSample(s[c])) {
+                fprintf(stderr, "%s: truncated\n", path);
+                fclose(f);
+                return false;
+            }
+        }
+        float luma = colour ? (0.299f * s[0] + 0.587f * s[1] + 0.114f * s[2]) : (float)s[0];
+        img.pixels[i] = luma / maxValue;
+    }
+
+    fclose(f);
+    return true;
+}
+
+static bool saveImage(const char* path, const Image& img) {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "%s: cannot create\n", path);
+        return false;
+    }
+    fprintf(f, "P5\n%d %d\n255\n", img.width, img.height);
+    for (float p : img.pixels) {
+        float v = p < 0 ? 0 : (p > 1 ? 1 : p);
+        fputc((int)(v * 255.0f + 0.5f), f);
+    }
+    bool ok = !ferror(f);
+    fclose(f);
+    return ok;
+}
+
+static float meanLevel(const Image& img) {
+    double sum = 0;
+    for (float p : img.pixels) sum += p;
+    return img.pixels.empty() ? 0 : (float)(sum / img.pixels.size());
+}
+
+struct DecodeOptions {
+    float threshold = 0.25f;
+    float contrast = 0.3f;
+    int minPixels = 2;
+};
+
+// Brightness-weighted centroid of the pixels that decoded to each LED
+struct DecodedPoint {
+    double u = 0;
+    double v = 0;
+    double weight = 0;
+    int pixels = 0;
+};
+
+struct DecodeResult {
+    size_t start = 0;     // Index of the sync frame
+    size_t rejected = 0;  // Lit pixels whose code was ambiguous or out of range
+    std::vector<DecodedPoint> points;
+
+    bool found(uint16_t index, const DecodeOptions& options) const {
+        return points[index].pixels >= options.minPixels;
+    }
+};
+
+static void decode(const std::vector<Image>& frames, uint16_t count, const DecodeOptions& options,
+                   DecodeResult& result) {
+    uint8_t bits = grayCodeBits(count);
+    size_t needed = grayCodeFrameCount(count);
+
+    // Locate the sync frame: largest drop in brightness into the next frame
+    float bestDrop = -1;
+    for (size_t s = 0; s + needed <= frames.size(); s++) {
+        float drop = meanLevel(frames[s + GRAY_CODE_FRAME_SYNC]) - meanLevel(frames[s + GRAY_CODE_FRAME_DARK]);
+        if (drop > bestDrop) {
+            bestDrop = drop;
+            result.start = s;
+        }
+    }
+
+    const size_t start = result.start;
+    const Image& sync = frames[start + GRAY_CODE_FRAME_SYNC];
+    const Image& dark = frames[start + GRAY_CODE_FRAME_DARK];
+    int width = sync.width;
+    int height = sync.height;
+    result.points.assign(count, DecodedPoint());
+    result.rejected = 0;
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            size_t p = (size_t)y * width + x;
+            float weight = sync.pixels[p] - dark.pixels[p];
+            if (weight < options.threshold) continue;
+
+            uint16_t code = 0;
+            bool reliable = true;
+            for (uint8_t b = 0; b < bits && reliable; b++) {
+                size_t frame = start + GRAY_CODE_FIRST_BIT_FRAME + 2 * b;
+                float diff = frames[frame].pixels[p] - frames[frame + 1].pixels[p];
+                if (diff > -options.contrast * weight && diff < options.contrast * weight) {
+                    reliable = false;
+                }
+                code = (uint16_t)((code << 1) | (diff > 0 ? 1 : 0));
+            }
+            uint16_t index = grayDecode(code);
+            if (!reliable || index >= count) {
+                result.rejected++;
+                continue;
+            }
+
+            DecodedPoint& point = result.points[index];
+            point.u += x * (double)weight;
+            point.v += y * (double)weight;
+            point.weight += weight;
+            point.pixels++;
+        }
+    }
+    for (DecodedPoint& point : result.points) {
+        if (point.weight > 0) {
+            point.u /= point.weight;
+            point.v /= point.weight;
+        }
+    }
+}
+
+// ---- Synthetic capture ----
+
+struct Scene {
+    int width = 640;
+    int height = 480;
+    float blur = 2.0f;        // LED blob radius (Gaussian sigma) in pixels
+    float ambient = 0.12f;    // Background light, brighter towards the bottom
+    float noise = 0.03f;      // Per-pixel sensor noise, +-
+    float hidden = 0.3f;      // Share of far-side LEDs hidden behind the tree
+    unsigned extraFrames = 2; // Frames captured before the sequence starts
+};
+
+struct Truth {
+    float u;
+    float v;
+    bool visible;
+};
+
+static float randomUnit() {
+    return (float)rand() / RAND_MAX * 2.0f - 1.0f;
+}
+
+// Where each LED of a helix wound round a cone lands in a view from angleDegrees
+static void project(uint16_t count, float angleDegrees, const Scene& scene, std::vector<Truth>& truth) {
+    const float pi = 3.14159265f;
+    float a = angleDegrees * pi / 180.0f;
+    float pixelsPerUnit = scene.height * 0.4f;
+    truth.resize(count);
+    for (uint16_t i = 0; i < count; i++) {
+        float h = count > 1 ? (float)i / (count - 1) : 0;
+        float turn = h * 6.0f * 2.0f * pi;
+        float radius = 0.8f * (1.0f - 0.8f * h);
+        float x = radius * cosf(turn), y = 2.0f * h - 1.0f, z = radius * sinf(turn);
+        float depth = x * sinf(a) + z * cosf(a);
+        truth[i].u = scene.width * 0.5f + (x * cosf(a) - z * sinf(a)) * pixelsPerUnit;
+        truth[i].v = scene.height * 0.5f - y * pixelsPerUnit;
+        truth[i].visible = !(depth > 0 && (randomUnit() + 1.0f) * 0.5f < scene.hidden);
+    }
+}
+
+static void render(uint16_t count, const std::vector<Truth>& truth, const Scene& scene, std::vector<Image>& frames) {
+    std::vector<float> level(count);
+    for (uint16_t i = 0; i < count; i++) {
+        level[i] = 0.6f + 0.4f * (randomUnit() + 1.0f) * 0.5f;  // Not every LED looks equally bright
+    }
+
+    size_t total = scene.extraFrames + grayCodeFrameCount(count);
+    frames.assign(total, Image());
+    int reach = (int)ceilf(scene.blur * 3);
+    for (size_t f = 0; f < total; f++) {
+        Image& img = frames[f];
+        img.width = scene.width;
+        img.height = scene.height;
+        img.pixels.resize((size_t)scene.width * scene.height);
+        for (int y = 0; y < scene.height; y++) {
+            float background = scene.ambient * (0.5f + (float)y / scene.height);
+            for (int x = 0; x < scene.width; x++) {
+                img.pixels[(size_t)y * scene.width + x] = background;
+            }
+        }
+
+        // The frames before the sequence are the strip still showing an animation
+        bool before = f < scene.extraFrames;
+        for (uint16_t i = 0; i < count; i++) {
+            bool lit = before ? (rand() & 3) == 0 : grayCodeLit((uint16_t)(f - scene.extraFrames), i, count);
+            if (!lit || !truth[i].visible) continue;
+            int cu = (int)truth[i].u, cv = (int)truth[i].v;
+            for (int y = cv - reach; y <= cv + reach; y++) {
+                if (y < 0 || y >= scene.height) continue;
+                for (int x = cu - reach; x <= cu + reach; x++) {
+                    if (x < 0 || x >= scene.width) continue;
+                    float du = x - truth[i].u, dv = y - truth[i].v;
+                    img.pixels[(size_t)y * scene.width + x] +=
+                        level[i] * expf(-(du * du + dv * dv) / (2 * scene.blur * scene.blur));
+                }
+            }
+        }
+
+        // Sensor noise, then the 8-bit quantization of a real capture
+        for (float& p : img.pixels) {
+            p += scene.noise * randomUnit();
+            p = p < 0 ? 0 : (p > 1 ? 1 : p);
+            p = roundf(p * 255.0f) / 255.0f;
+        }
+    }
+}
+
+static int generate(uint16_t count, float angle, const Scene& scene, const char* dir) {
+    std::vector<Truth> truth;
+    std::vector<Image> frames;
+    project(count, angle, scene, truth);
+    render(count, truth, scene, frames);
+
+    char path[1024];
+    for (size_t f = 0; f < frames.size(); f++) {
+        snprintf(path, sizeof(path), "%s/frame_%02zu.pgm", dir, f);
+        if (!saveImage(path, frames[f])) return 1;
+    }
+    snprintf(path, sizeof(path), "%s/truth.json", dir);
+    FILE* out = fopen(path, "w");
+    if (!out) {
+        fprintf(stderr, "%s: cannot create\n", path);
+        return 1;
+    }
+    fprintf(out, "{\"angle\":%g,\"width\":%d,\"height\":%d,\"points\":[", angle, scene.width, scene.height);
+    for (uint16_t i = 0; i < count; i++) {
+        if (i > 0) fprintf(out, ",");
+        if (truth[i].visible) fprintf(out, "[%.2f,%.2f]", truth[i].u, truth[i].v);
+        else fprintf(out, "null");
+    }
+    fprintf(out, "]}\n");
+    fclose(out);
+    fprintf(stderr, "wrote %zu frames (%u before the sync frame) to %s\n", frames.size(), scene.extraFrames, dir);
+    return 0;
+}
+
+// Decode synthetic views and hold them to the truth: every visible LED found
+// within a pixel, no hidden LED reported, the sync frame found
+static int check(uint16_t count, const Scene& scene, const DecodeOptions& options) {
+    static const float ANGLES[] = { 0, 90, 180, 270 };
+    const float maxError = 1.0f;
+    bool ok = true;
+    for (float angle : ANGLES) {
+        std::vector<Truth> truth;
+        std::vector<Image> frames;
+        project(count, angle, scene, truth);
+        render(count, truth, scene, frames);
+
+        DecodeResult result;
+        decode(frames, count, options, result);
+
+        int visible = 0, found = 0, phantom = 0;
+        float worst = 0;
+        for (uint16_t i = 0; i < count; i++) {
+            bool seen = result.found(i, options);
+            if (!truth[i].visible) {
+                phantom += seen;
+                continue;
+            }
+            visible++;
+            if (!seen) continue;
+            found++;
+            float du = (float)result.points[i].u - truth[i].u;
+            float dv = (float)result.points[i].v - truth[i].v;
+            float error = sqrtf(du * du + dv * dv);
+            if (error > worst) worst = error;
+        }
+        printf("angle %3g: found %d of %d visible LEDs, %d hidden reported, worst %.2f px, %zu ambiguous pixels\n",
+               angle, found, visible, phantom, worst, result.rejected);
+
+        if (result.start != scene.extraFrames) {
+            printf("ERROR: sync frame found at %zu, expected %u\n", result.start, scene.extraFrames);
+            ok = false;
+        }
+        if (found < visible || phantom > 0 || worst > maxError) {
+            printf("ERROR: decode doesn't match the rendered positions\n");
+            ok = false;
+        }
+    }
+    if (ok) printf("graycode ok\n");
+    return ok ? 0 : 1;
+}
+
+static void usage() {
+    fprintf(stderr,
+        "usage: graycode_decoder -n LEDS [-a ANGLE] [-t THRESHOLD] [-c CONTRAST] [-m MIN_PIXELS] frames...\n"
+        "       graycode_decoder gen -n LEDS [-a ANGLE] [-r WxH] [-b BLUR] [-e NOISE] [-x EXTRA_FRAMES] DIR\n"
+        "       graycode_decoder check -n LEDS [-r WxH] [-b BLUR] [-e NOISE] [-t ...] [-c ...] [-m ...]\n"
+        "  -n  number of LEDs on the strip (must match the controller)\n"
+        "  -a  camera angle in degrees around the tree, copied to the output (default 0)\n"
+        "  -t  minimum sync-minus-dark brightness for a pixel to count (default 0.25)\n"
+        "  -c  minimum |pattern - inverse| as a fraction of that brightness (default 0.3)\n"
+        "  -m  minimum decoded pixels for an LED to be reported (default 2)\n"
+        "  -r  rendered frame size (default 640x480)\n"
+        "  -b  rendered LED blur radius in pixels (default 2)\n"
+        "  -e  rendered sensor noise, 0..1 (default 0.03)\n"
+        "  -x  rendered frames before the sync frame (default 2)\n"
+        "Frames must be in capture order. Extra frames are allowed; the sync frame\n"
+        "is found as the brightest frame followed by the dark frame.\n");
+}
+
+int main(int argc, char** argv) {
+    int first = 1;
+    bool gen = argc > 1 && !strcmp(argv[1], "gen");
+    bool checking = argc > 1 && !strcmp(argv[1], "check");
+    if (gen || checking) first = 2;
+
+    int ledCount = 0;
+    float angle = 0;
+    DecodeOptions options;
+    Scene scene;
+    std::vector<const char*> files;
+
+    for (int i = first; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) ledCount = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-a") && i + 1 < argc) angle = (float)atof(argv[++i]);
+        else if (!strcmp(argv[i], "-t") && i + 1 < argc) options.threshold = (float)atof(argv[++i]);
+        else if (!strcmp(argv[i], "-c") && i + 1 < argc) options.contrast = (float)atof(argv[++i]);
+        else if (!strcmp(argv[i], "-m") && i + 1 < argc) options.minPixels = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-b") && i + 1 < argc) scene.blur = (float)atof(argv[++i]);
+        else if (!strcmp(argv[i], "-e") && i + 1 < argc) scene.noise = (float)atof(argv[++i]);
+        else if (!strcmp(argv[i], "-x") && i + 1 < argc) scene.extraFrames = (unsigned)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc) sscanf(argv[++i], "%dx%d", &scene.width, &scene.height);
+        else if (argv[i][0] == '-') { usage(); return 2; }
+        else files.push_back(argv[i]);
+    }
+    if (ledCount <= 0 || ledCount > 65535 || scene.blur <= 0 || scene.width <= 0 || scene.height <= 0) {
+        usage();
+        return 2;
+    }
+    uint16_t count = (uint16_t)ledCount;
+
+    srand(1);
+    if (checking) {
+        return check(count, scene, options);
+    }
+    if (gen) {
+        if (files.size() != 1) {
+            usage();
+            return 2;
+        }
+        return generate(count, angle, scene, files[0]);
+    }
+
+    size_t needed = grayCodeFrameCount(count);
+    if (files.size() < needed) {
+        fprintf(stderr, "need %zu frames for %d LEDs, got %zu\n", needed, ledCount, files.size());
+        return 1;
+    }
+
+    std::vector<Image> frames(files.size());
+    for (size_t i = 0; i < files.size(); i++) {
+        if (!loadImage(files[i], frames[i])) return 1;
+        if (frames[i].width != frames[0].width || frames[i].height != frames[0].height) {
+            fprintf(stderr, "%s: size differs from the first frame\n", files[i]);
+            return 1;
+        }
+    }
+
+    DecodeResult result;
+    decode(frames, count, options, result);
+    if (frames.size() > needed) {
+        fprintf(stderr, "sync frame: %s\n", files[result.start]);
+    }
+
+    printf("{\"angle\":%g,\"width\":%d,\"height\":%d,\"points\":[", angle, frames[0].width, frames[0].height);
+    int found = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        if (i > 0) printf(",");
+        if (result.found(i, options)) {
+            printf("[%.2f,%.2f]", result.points[i].u, result.points[i].v);
+            found++;
+        } else {
+            printf("null");
+        }
+    }
+    printf("]}\n");
+
+    fprintf(stderr, "found %d of %d LEDs (%zu ambiguous pixels ignored)\n", found, ledCount, result.rejected);
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Just enough of Arduino and FastLED to build the output stage and the pixel
+// kernels on a computer for tools/output_tool and tools/pixel_tool. Put this
+// directory before ../../include on the include path.
+
+#ifndef HOST_FASTLED_H
+#define HOST_FASTLED_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+
+using std::max;
+using std::min;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+inline uint32_t micros() {
+    static const auto start = std::chrono::steady_clock::now();
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+struct HostSerial {
+    template <typename... Args>
+    void printf(const char* format, Args... args) { ::printf(format, args...); }
+    void println(const char* text) { ::puts(text); }
+};
+static HostSerial Serial;
+
+inline uint8_t scale8(uint8_t i, uint8_t scale) {
+    return ((uint16_t)i * (1 + (uint16_t)scale)) >> 8;
+}
+
+struct CHSV {
+    uint8_t h, s, v;
+    CHSV(uint8_t hue, uint8_t sat, uint8_t val) : h(hue), s(sat), v(val) {}
+};
+
+struct CRGB {
+    union {
+        struct { uint8_t r, g, b; };
+        uint8_t raw[3];
+    };
+
+    CRGB() = default;
+    CRGB(uint8_t red, uint8_t green, uint8_t blue) : r(red), g(green), b(blue) {}
+    CRGB(uint32_t code) : r((code >> 16) & 0xFF), g((code >> 8) & 0xFF), b(code & 0xFF) {}
+    CRGB(const CHSV& hsv) {
+        // Plain six-segment hue wheel; only used to make test frames
+        uint8_t segment = hsv.h / 43;
+        uint8_t rise = (uint8_t)((hsv.h - segment * 43) * 6);
+        uint8_t fall = 255 - rise;
+        uint8_t c[3];
+        switch (segment) {
+            case 0:  c[0] = 255;  c[1] = rise; c[2] = 0;    break;
+            case 1:  c[0] = fall; c[1] = 255;  c[2] = 0;    break;
+            case 2:  c[0] = 0;    c[1] = 255;  c[2] = rise; break;
+            case 3:  c[0] = 0;    c[1] = fall; c[2] = 255;  break;
+            case 4:  c[0] = rise; c[1] = 0;    c[2] = 255;  break;
+            default: c[0] = 255;  c[1] = 0;    c[2] = fall; break;
+        }
+        for (uint8_t i = 0; i < 3; i++) {
+            uint8_t white = 255 - hsv.s;
+            raw[i] = scale8(white + scale8(c[i], hsv.s), hsv.v);
+        }
+    }
+
+    CRGB& nscale8(uint8_t scale) {
+        r = scale8(r, scale);
+        g = scale8(g, scale);
+        b = scale8(b, scale);
+        return *this;
+    }
+
+    bool operator==(const CRGB& o) const { return r == o.r && g == o.g && b == o.b; }
+    bool operator!=(const CRGB& o) const { return !(*this == o); }
+};
+
+#endif // HOST_FASTLED_H
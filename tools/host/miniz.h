@@ -0,0 +1,99 @@
+// The part of miniz's tinfl API that FseqReader uses, on top of zlib's
+// inflate, so tools/fseq_tool can read zlib-compressed sequences on a
+// computer (the controller uses the miniz copy in ROM). Put this directory
+// on the include path and link with -lz.
+//
+// zlib keeps its own history, so unlike tinfl it doesn't need the output
+// buffer to be the 32 KB circular window; it simply fills whatever space
+// the caller hands it, which is all FseqReader relies on.
+
+#ifndef HOST_MINIZ_H
+#define HOST_MINIZ_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <zlib.h>
+
+typedef uint8_t mz_uint8;
+typedef uint32_t mz_uint32;
+
+#define TINFL_LZ_DICT_SIZE 32768
+
+enum {
+    TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
+    TINFL_FLAG_HAS_MORE_INPUT = 2,
+    TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4,
+    TINFL_FLAG_COMPUTE_ADLER32 = 8
+};
+
+typedef enum {
+    TINFL_STATUS_FAILED_CANNOT_MAKE_PROGRESS = -4,
+    TINFL_STATUS_BAD_PARAM = -3,
+    TINFL_STATUS_ADLER32_MISMATCH = -2,
+    TINFL_STATUS_FAILED = -1,
+    TINFL_STATUS_DONE = 0,
+    TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+    TINFL_STATUS_HAS_MORE_OUTPUT = 2
+} tinfl_status;
+
+struct tinfl_decompressor {
+    z_stream stream;
+    bool active;   // inflateInit has run
+    bool started;  // Reset by tinfl_init; the stream is (re)opened on first use
+
+    tinfl_decompressor() : active(false), started(false) { memset(&stream, 0, sizeof(stream)); }
+    ~tinfl_decompressor() {
+        if (active) inflateEnd(&stream);
+    }
+};
+
+inline void tinfl_init(tinfl_decompressor* r) {
+    r->started = false;
+}
+
+inline tinfl_status tinfl_decompress(tinfl_decompressor* r, const mz_uint8* pIn_buf_next, size_t* pIn_buf_size,
+                                     mz_uint8* pOut_buf_start, mz_uint8* pOut_buf_next, size_t* pOut_buf_size,
+                                     const mz_uint32 decomp_flags) {
+    (void)pOut_buf_start;
+    if (!r->started) {
+        if (r->active) {
+            inflateEnd(&r->stream);
+            r->active = false;
+        }
+        memset(&r->stream, 0, sizeof(r->stream));
+        int windowBits = (decomp_flags & TINFL_FLAG_PARSE_ZLIB_HEADER) ? 15 : -15;
+        if (inflateInit2(&r->stream, windowBits) != Z_OK) {
+            *pIn_buf_size = 0;
+            *pOut_buf_size = 0;
+            return TINFL_STATUS_BAD_PARAM;
+        }
+        r->active = true;
+        r->started = true;
+    }
+
+    z_stream& s = r->stream;
+    s.next_in = const_cast<Bytef*>(pIn_buf_next);
+    s.avail_in = (uInt)*pIn_buf_size;
+    s.next_out = pOut_buf_next;
+    s.avail_out = (uInt)*pOut_buf_size;
+    int result = inflate(&s, Z_NO_FLUSH);
+    *pIn_buf_size -= s.avail_in;
+    *pOut_buf_size -= s.avail_out;
+
+    switch (result) {
+        case Z_STREAM_END:
+            return TINFL_STATUS_DONE;
+        case Z_OK:
+        case Z_BUF_ERROR:
+            if (s.avail_out == 0) return TINFL_STATUS_HAS_MORE_OUTPUT;
+            if (!(decomp_flags & TINFL_FLAG_HAS_MORE_INPUT) && s.avail_in == 0) {
+                return TINFL_STATUS_FAILED_CANNOT_MAKE_PROGRESS;
+            }
+            return TINFL_STATUS_NEEDS_MORE_INPUT;
+        default:
+            return TINFL_STATUS_FAILED;
+    }
+}
+
+#endif // HOST_MINIZ_H
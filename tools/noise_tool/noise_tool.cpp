@@ -0,0 +1,130 @@
+// Host-side benchmark and check for the noise animations.
+//
+// Lays NUM_LEDS out on a cone like a calibrated tree, prepares the same
+// NoiseField the controller uses and times a frame both ways: cached
+// (prepare once, then setTime + sample per LED) and uncached (sampleAt,
+// the full simplex lookup per LED). It then checks that both give the same
+// values, that the output spreads over the palette and that the field is
+// smooth in space and from one frame to the next.
+//
+// Build:  g++ -O2 -std=c++17 -I../../include noise_tool.cpp ../../src/noise_field.cpp -o noise_tool
+// Usage:  noise_tool [-f FRAMES] [-s SCALE]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "noise_field.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double nanosSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+static float randomUnit() {
+    return (float)rand() / RAND_MAX * 2.0f - 1.0f;
+}
+
+int main(int argc, char** argv) {
+    uint32_t frames = 2000;
+    float scale = NOISE_SCALE;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-f") && i + 1 < argc) frames = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc) scale = (float)atof(argv[++i]);
+        else {
+            fprintf(stderr, "usage: noise_tool [-f FRAMES] [-s SCALE]\n");
+            return 2;
+        }
+    }
+    if (frames < 2) frames = 2;
+
+    // A spiral up a cone, as the strip is wound round a tree
+    std::vector<LEDPosition> positions(NUM_LEDS);
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        float h = (float)i / NUM_LEDS;
+        float angle = h * 6.0f * 6.2831853f;
+        float radius = 1.0f - h;
+        positions[i] = { radius * cosf(angle), h * 2.0f - 1.0f, radius * sinf(angle) };
+    }
+
+    static NoiseField field;
+    auto start = Clock::now();
+    field.prepare(positions.data(), NUM_LEDS, scale);
+    double prepareNanos = nanosSince(start);
+
+    std::vector<uint8_t> cached(NUM_LEDS), previous(NUM_LEDS), uncached(NUM_LEDS);
+    double timeNanos = 0, cachedNanos = 0, uncachedNanos = 0;
+    uint32_t mismatches = 0, histogram[256] = {};
+    int maxStep = 0;
+
+    for (uint32_t f = 0; f < frames; f++) {
+        start = Clock::now();
+        field.setTime(f * NOISE_FLOW_STEP);
+        timeNanos += nanosSince(start);
+
+        start = Clock::now();
+        for (uint16_t i = 0; i < NUM_LEDS; i++) cached[i] = field.sample(i);
+        cachedNanos += nanosSince(start);
+
+        start = Clock::now();
+        for (uint16_t i = 0; i < NUM_LEDS; i++) uncached[i] = field.sampleAt(positions[i], scale);
+        uncachedNanos += nanosSince(start);
+
+        for (uint16_t i = 0; i < NUM_LEDS; i++) {
+            if (cached[i] != uncached[i]) mismatches++;
+            histogram[cached[i]]++;
+            if (f > 0) maxStep = std::max(maxStep, abs(cached[i] - previous[i]));
+        }
+        previous.swap(cached);
+    }
+
+    // Nearby points must have nearby values: a fiftieth of a cell of the finest octave apart
+    srand(1);
+    int maxSpatial = 0;
+    const float apart = 0.02f / (scale * (1 << (NOISE_OCTAVES - 1)));
+    for (uint32_t n = 0; n < 20000; n++) {
+        LEDPosition a = { randomUnit(), randomUnit(), randomUnit() };
+        LEDPosition b = { a.x + apart * randomUnit(), a.y + apart * randomUnit(), a.z + apart * randomUnit() };
+        maxSpatial = std::max(maxSpatial, abs(field.sampleAt(a, scale) - field.sampleAt(b, scale)));
+    }
+
+    uint64_t samples = (uint64_t)frames * NUM_LEDS;
+    uint64_t seen = 0;
+    int p1 = -1, p99 = -1;
+    double mean = 0;
+    for (int v = 0; v < 256; v++) {
+        mean += (double)v * histogram[v];
+        seen += histogram[v];
+        if (p1 < 0 && seen * 100 >= samples) p1 = v;
+        if (p99 < 0 && seen * 100 >= samples * 99) p99 = v;
+    }
+    mean /= samples;
+
+    printf("%u LEDs, %u frames, scale %.2f, %u octaves\n", NUM_LEDS, frames, scale, NOISE_OCTAVES);
+    printf("prepare        %8.1f us (once per calibration change)\n", prepareNanos / 1000);
+    printf("setTime        %8.1f us per frame\n", timeNanos / frames / 1000);
+    printf("cached sample  %8.1f ns per LED\n", cachedNanos / samples);
+    printf("sampleAt       %8.1f ns per LED (no cache)\n", uncachedNanos / samples);
+    printf("values: mean %.1f, 1%% %d, 99%% %d\n", mean, p1, p99);
+    printf("largest change: %d per frame, %d across %.4f units\n", maxStep, maxSpatial, apart);
+
+    bool ok = true;
+    if (mismatches) {
+        printf("MISMATCH: cached and uncached differ at %u samples\n", mismatches);
+        ok = false;
+    }
+    if (p99 - p1 < 128) {
+        printf("NARROW: values use too little of the palette\n");
+        ok = false;
+    }
+    if (maxStep > 16 || maxSpatial > 16) {
+        printf("ROUGH: field jumps between neighbouring samples\n");
+        ok = false;
+    }
+    if (ok) printf("noise ok\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,255 @@
+// Host-side benchmark and check for the fused output stage.
+//
+// Times OutputStage::render() in each specialization (dithering on and off,
+// normal, reversed and mirrored mapping) against the same stages run as
+// five separate passes over the frame, the way they were applied before the
+// fused pass. Then checks the output:
+//
+//   - without dithering every code is the rounded gamma / brightness /
+//     correction value, within half a step
+//   - with dithering the average over many refreshes is the 16-bit value
+//   - reversed and mirrored output is the normal output reordered
+//   - a frame over the power budget is brought within it on the next
+//     refresh, and the limiter lets go again once the frame is dark
+//
+// Build:  g++ -O2 -std=c++17 -I../host -I../../include output_tool.cpp ../../src/output_stage.cpp
+//             -o output_tool
+// Usage:  output_tool [-f FRAMES]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include "output_stage.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static const uint8_t BRIGHTNESS = 200;
+static const uint32_t CORRECTION = 0xFFB0F0;  // FastLED's TypicalLEDStrip
+
+static double nanosSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+// What the LUT approximates: the exact output level for one channel
+static double exactLevel(const OutputStage& stage, uint8_t channel, uint8_t value) {
+    CRGB correction = stage.getColorCorrection();
+    return pow(value / 255.0, stage.getGamma(channel)) * 255.0 *
+           (stage.getBrightness() / 255.0) * (correction.raw[channel] / 255.0);
+}
+
+// Brightness, correction, gamma, limiter and reversal as one pass each
+static double benchmarkStaged(const OutputStage& stage, const CRGB* frame, uint32_t frames, uint32_t& checksum) {
+    static CRGB work[NUM_LEDS];
+    static CRGB out[NUM_LEDS];
+    static uint8_t gamma8[3][256];
+    for (uint8_t c = 0; c < 3; c++) {
+        for (uint16_t i = 0; i < 256; i++) {
+            gamma8[c][i] = (uint8_t)(powf(i / 255.0f, stage.getGamma(c)) * 255.0f + 0.5f);
+        }
+    }
+    const CRGB correction(CORRECTION);
+    const uint8_t limit = 230;
+
+    auto start = Clock::now();
+    for (uint32_t f = 0; f < frames; f++) {
+        memcpy(work, frame, sizeof(work));
+        for (uint16_t i = 0; i < NUM_LEDS; i++) {
+            work[i].nscale8(BRIGHTNESS);
+        }
+        for (uint16_t i = 0; i < NUM_LEDS; i++) {
+            work[i].r = scale8(work[i].r, correction.r);
+            work[i].g = scale8(work[i].g, correction.g);
+            work[i].b = scale8(work[i].b, correction.b);
+        }
+        for (uint16_t i = 0; i < NUM_LEDS; i++) {
+            work[i].r = gamma8[0][work[i].r];
+            work[i].g = gamma8[1][work[i].g];
+            work[i].b = gamma8[2][work[i].b];
+        }
+        for (uint16_t i = 0; i < NUM_LEDS; i++) {
+            work[i].nscale8(limit);
+        }
+        for (uint16_t i = 0; i < NUM_LEDS; i++) {
+            out[NUM_LEDS - 1 - i] = work[i];
+        }
+        checksum += out[f % NUM_LEDS].r;
+    }
+    return nanosSince(start);
+}
+
+static double benchmarkFused(OutputStage& stage, const CRGB* frame, uint32_t frames, uint32_t& checksum) {
+    stage.render(frame);  // LUT rebuild outside the timed loop
+    auto start = Clock::now();
+    for (uint32_t f = 0; f < frames; f++) {
+        stage.render(frame);
+        checksum += stage.getOutput()[f % NUM_LEDS].r;
+    }
+    return nanosSince(start);
+}
+
+static OutputStage* configured(bool dither, OutputMapping mapping, uint32_t budgetMa) {
+    OutputStage* stage = new OutputStage();
+    stage->setBrightness(BRIGHTNESS);
+    stage->setColorCorrection(CRGB(CORRECTION));
+    stage->setDithering(dither);
+    stage->setMapping(mapping);
+    stage->setPowerOutputCount(1);
+    stage->setPowerOutput(0, 0, NUM_LEDS, budgetMa);
+    return stage;
+}
+
+static bool checkRounding() {
+    OutputStage* stage = configured(false, OUTPUT_MAP_NORMAL, 0);
+    static CRGB frame[NUM_LEDS];
+    double worst = 0;
+    for (uint16_t base = 0; base < 256; base += NUM_LEDS) {
+        for (uint16_t i = 0; i < NUM_LEDS; i++) {
+            uint8_t v = (uint8_t)min(base + i, 255);
+            frame[i] = CRGB(v, v, v);
+        }
+        stage->render(frame);
+        for (uint16_t i = 0; i < NUM_LEDS; i++) {
+            for (uint8_t c = 0; c < 3; c++) {
+                double error = fabs(stage->getOutput()[i].raw[c] - exactLevel(*stage, c, frame[i].raw[c]));
+                worst = max(worst, error);
+            }
+        }
+    }
+    delete stage;
+    printf("rounding: worst %.3f codes from the exact level\n", worst);
+    return worst <= 0.5 + 0.5 / 256;  // Rounded twice: into the 8.8 LUT, then to 8 bits
+}
+
+static bool checkDithering() {
+    const uint32_t refreshes = 1024;
+    OutputStage* stage = configured(true, OUTPUT_MAP_NORMAL, 0);
+    static CRGB frame[NUM_LEDS];
+    static uint32_t sum[NUM_LEDS][3];
+    memset(sum, 0, sizeof(sum));
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        uint8_t v = (uint8_t)(i * 5 + 1);  // Mostly the dim end, where 8-bit steps show
+        frame[i] = CRGB(v, (uint8_t)(v / 2), (uint8_t)(255 - v));
+    }
+    for (uint32_t n = 0; n < refreshes; n++) {
+        stage->render(frame);
+        for (uint16_t i = 0; i < NUM_LEDS; i++) {
+            for (uint8_t c = 0; c < 3; c++) {
+                sum[i][c] += stage->getOutput()[i].raw[c];
+            }
+        }
+    }
+    double worst = 0;
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        for (uint8_t c = 0; c < 3; c++) {
+            double error = fabs((double)sum[i][c] / refreshes - exactLevel(*stage, c, frame[i].raw[c]));
+            worst = max(worst, error);
+        }
+    }
+    delete stage;
+    // LUT rounding (half of 1/256) plus at most one code over the whole run
+    double allowed = 0.5 / 256 + 1.0 / refreshes;
+    printf("dithering: average over %u refreshes within %.4f codes of the exact level\n", refreshes, worst);
+    return worst <= allowed;
+}
+
+static bool checkMapping() {
+    static CRGB frame[NUM_LEDS];
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        frame[i] = CHSV((uint8_t)(i * 5), 255, 255);
+    }
+    static CRGB normal[NUM_LEDS];
+    OutputStage* stage = configured(false, OUTPUT_MAP_NORMAL, 0);
+    stage->render(frame);
+    memcpy(normal, stage->getOutput(), sizeof(normal));
+    delete stage;
+
+    bool ok = true;
+    stage = configured(false, OUTPUT_MAP_REVERSE, 0);
+    stage->render(frame);
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        ok &= stage->getOutput()[i] == normal[NUM_LEDS - 1 - i];
+    }
+    delete stage;
+
+    stage = configured(false, OUTPUT_MAP_MIRROR, 0);
+    stage->render(frame);
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        ok &= stage->getOutput()[i] == normal[i < (NUM_LEDS + 1) / 2 ? i : NUM_LEDS - 1 - i];
+    }
+    delete stage;
+    printf("mapping: reversed and mirrored output %s the normal output\n", ok ? "match" : "DON'T match");
+    return ok;
+}
+
+static bool checkLimiter() {
+    const uint32_t budget = 600;
+    OutputStage* stage = configured(false, OUTPUT_MAP_NORMAL, budget);
+    stage->setBrightness(255);
+    static CRGB frame[NUM_LEDS];
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        frame[i] = CRGB(255, 255, 255);
+    }
+    stage->render(frame);  // The estimate lags one refresh
+    stage->render(frame);
+    uint32_t requested = stage->getRequestedMilliamps(0);
+    uint32_t drawn = stage->getEstimatedMilliamps();
+    bool limited = stage->isLimiting() && drawn <= budget;
+
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        frame[i] = CRGB(0, 0, 0);
+    }
+    uint16_t frames = 0;
+    while (stage->isLimiting() && frames < 1000) {
+        stage->render(frame);
+        frames++;
+    }
+    bool released = !stage->isLimiting();
+    delete stage;
+    printf("limiter: white asks for %u mA, drew %u mA on a %u mA budget, released %u frames after going dark\n",
+           requested, drawn, budget, frames);
+    return limited && released;
+}
+
+int main(int argc, char** argv) {
+    uint32_t frames = 20000;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-f") && i + 1 < argc) frames = (uint32_t)atoi(argv[++i]);
+        else {
+            fprintf(stderr, "usage: output_tool [-f FRAMES]\n");
+            return 2;
+        }
+    }
+
+    static CRGB frame[NUM_LEDS];
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        frame[i] = CHSV((uint8_t)(i * 7), 200, 255);
+    }
+    printf("%u LEDs, %u frames\n", NUM_LEDS, frames);
+
+    uint32_t checksum = 0;
+    double perLed = 1.0 / ((double)frames * NUM_LEDS);
+    OutputStage* reference = configured(false, OUTPUT_MAP_REVERSE, POWER_BUDGET_MA);
+    printf("  %-24s %6.2f ns/LED\n", "staged (5 passes)", benchmarkStaged(*reference, frame, frames, checksum) * perLed);
+    delete reference;
+
+    static const char* mappings[OUTPUT_MAP_COUNT] = { "normal", "reversed", "mirrored" };
+    for (uint8_t d = 0; d < 2; d++) {
+        for (uint8_t m = 0; m < OUTPUT_MAP_COUNT; m++) {
+            OutputStage* stage = configured(d == 1, (OutputMapping)m, POWER_BUDGET_MA);
+            char name[32];
+            snprintf(name, sizeof(name), "fused %s%s", mappings[m], d ? " + dither" : "");
+            printf("  %-24s %6.2f ns/LED\n", name, benchmarkFused(*stage, frame, frames, checksum) * perLed);
+            delete stage;
+        }
+    }
+    printf("  (checksum %u)\n", checksum);
+
+    bool ok = checkRounding();
+    ok &= checkDithering();
+    ok &= checkMapping();
+    ok &= checkLimiter();
+    if (ok) printf("output ok\n");
+    return ok ? 0 : 1;
+}
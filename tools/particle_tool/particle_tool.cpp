@@ -0,0 +1,141 @@
+// Host-side benchmark and check for the particle system.
+//
+// Lays NUM_LEDS out on a cone like a calibrated tree, builds the same
+// SpatialIndex the controller uses and runs each built-in effect on the
+// frame clock, timing the integrator and the splat per particle. A stress
+// run then fills the whole pool. Two checks: fresh snow must light the
+// top of the tree first and work its way down, and the pool must fill to
+// its capacity and never past it.
+//
+// Build:  g++ -O2 -std=c++17 -I../../include particle_tool.cpp ../../src/particle_system.cpp
+//             ../../src/spatial_index.cpp -o particle_tool
+// Usage:  particle_tool [-t SECONDS] [-c CAPACITY]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include "particle_system.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static const uint32_t FRAME_MS = 50;  // DEFAULT_ANIMATION_SPEED
+
+static uint32_t clockMs = 0;  // The frame clock only runs forwards
+
+static double nanosSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+struct RunStats {
+    double updateNanos = 0;
+    double splatNanos = 0;
+    uint64_t particleFrames = 0;  // Sum of live particles over frames
+    uint16_t peak = 0;
+    bool overflow = false;
+};
+
+static RunStats run(ParticleSystem& particles, uint8_t emitter, uint32_t seconds,
+                    const SpatialIndex& index, const LEDPosition* positions) {
+    RunStats stats;
+    particles.clear();
+    for (uint32_t end = clockMs + seconds * 1000; clockMs <= end; clockMs += FRAME_MS) {
+        auto start = Clock::now();
+        particles.update(clockMs);
+        stats.updateNanos += nanosSince(start);
+        start = Clock::now();
+        particles.splat(emitter, index, positions);
+        stats.splatNanos += nanosSince(start);
+
+        uint16_t count = particles.getCount();
+        stats.particleFrames += count;
+        if (count > stats.peak) stats.peak = count;
+        if (count > particles.getCapacity()) stats.overflow = true;
+    }
+    return stats;
+}
+
+static void report(const char* name, const RunStats& stats, uint32_t seconds) {
+    uint32_t frames = seconds * 1000 / FRAME_MS + 1;
+    double perParticle = stats.particleFrames ? 1.0 / stats.particleFrames : 0;
+    printf("%-10s %6.0f live, %5u peak   update %6.1f us/frame %5.1f ns/particle   splat %6.1f us/frame %5.1f ns/particle\n",
+           name, (double)stats.particleFrames / frames, stats.peak,
+           stats.updateNanos / frames / 1000, stats.updateNanos * perParticle,
+           stats.splatNanos / frames / 1000, stats.splatNanos * perParticle);
+}
+
+int main(int argc, char** argv) {
+    uint32_t seconds = 30;
+    uint16_t capacity = PARTICLE_CAPACITY;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-t") && i + 1 < argc) seconds = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-c") && i + 1 < argc) capacity = (uint16_t)atoi(argv[++i]);
+        else {
+            fprintf(stderr, "usage: particle_tool [-t SECONDS] [-c CAPACITY]\n");
+            return 2;
+        }
+    }
+
+    // A spiral up a cone, as the strip is wound round a tree
+    static LEDPosition positions[NUM_LEDS];
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        float h = (float)i / NUM_LEDS;
+        float angle = h * 6.0f * 6.2831853f;
+        float radius = 1.0f - h;
+        positions[i] = { radius * cosf(angle), h * 2.0f - 1.0f, radius * sinf(angle) };
+    }
+    static SpatialIndex index;
+    index.build(positions);
+
+    static ParticleSystem particles;
+    if (!particles.begin(capacity)) {
+        fprintf(stderr, "cannot allocate %u particles\n", capacity);
+        return 1;
+    }
+    printf("%u LEDs, pool of %u, %u s at %u ms per frame\n", NUM_LEDS, capacity, seconds, FRAME_MS);
+
+    bool ok = true;
+    static const char* names[PARTICLE_EMITTERS] = { "snow", "fireworks", "embers" };
+    for (uint8_t e = 0; e < PARTICLE_EMITTERS; e++) {
+        RunStats stats = run(particles, e, seconds, index, positions);
+        report(names[e], stats, seconds);
+        ok &= !stats.overflow;
+    }
+
+    // Stress: snow fast enough to keep the pool full
+    ParticleEmitter blizzard = particles.getEmitter(PARTICLE_EMITTER_SNOW);
+    blizzard.rate = 4.0f * capacity;
+    particles.setEmitter(PARTICLE_EMITTER_SNOW, blizzard);
+    RunStats stress = run(particles, PARTICLE_EMITTER_SNOW, 5, index, positions);
+    report("full pool", stress, 5);
+    ok &= !stress.overflow && stress.peak == capacity;
+    particles.resetEmitter(PARTICLE_EMITTER_SNOW);
+
+    // Fresh snowfall: the lit region must start at the top and move down the tree
+    static ParticleSystem fresh;
+    fresh.begin(capacity);
+    float startY = 0, laterY = 0;
+    for (uint32_t now = 0; now <= 8000; now += FRAME_MS) {
+        fresh.update(now);
+        fresh.splat(PARTICLE_EMITTER_SNOW, index, positions);
+        if (now != 2000 && now != 8000) continue;
+        double sum = 0, weighted = 0;
+        for (uint16_t led = 0; led < NUM_LEDS; led++) {
+            const uint16_t* light = fresh.getLight(led);
+            double level = light[0] + light[1] + light[2];
+            sum += level;
+            weighted += level * positions[led].y;
+        }
+        float y = sum > 0 ? (float)(weighted / sum) : 0;
+        (now == 2000 ? startY : laterY) = y;
+    }
+    bool falls = startY > laterY + 0.3f;
+    printf("snow light centred at y %.2f after 2 s, y %.2f after 8 s\n", startY, laterY);
+
+    if (!falls) printf("SNOW: the snow didn't fall\n");
+    if (!ok) printf("POOL: count went past capacity or never filled\n");
+    ok &= falls;
+    if (ok) printf("particles ok\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+// Host-side check and benchmark for the pixel kernels.
+//
+// Built with PIXEL_KERNELS_EMULATE_PIE, so the vector path runs on C++
+// models of the PIE instructions that, like the real loads and stores, drop
+// the low address bits. Every kernel is run on both paths over every
+// length up to a few blocks plus a long one, every start offset within a
+// block and independent source offsets, and the bytes are compared with
+// the scalar path and with a plain per-channel reference of the FastLED
+// operation each one stands in for. Then the scalar path is timed here;
+// device numbers come from pixelKernelsBenchmark() (RUN_BENCHMARKS).
+//
+// Build:  g++ -O2 -std=c++17 -DPIXEL_KERNELS_EMULATE_PIE -I../host -I../../include pixel_tool.cpp
+//             ../../src/pixel_kernels.cpp -o pixel_tool
+// Usage:  pixel_tool [-p PIXELS] [-r ROUNDS]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "pixel_kernels.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static const uint16_t MAX_PIXELS = 400;
+static const uint8_t AMOUNTS[] = { 0, 1, 2, 77, 127, 128, 129, 200, 254, 255 };
+
+enum Kernel { KERNEL_SCALE, KERNEL_FADE, KERNEL_ADD, KERNEL_BLEND, KERNEL_FILL, KERNEL_COUNT };
+static const char* KERNEL_NAMES[KERNEL_COUNT] = { "scale", "fade", "add", "blend", "fill" };
+
+static uint32_t randomState = 12345;
+static uint8_t randomByte() {
+    randomState = randomState * 1664525UL + 1013904223UL;
+    return randomState >> 24;
+}
+
+// What each kernel stands in for, one channel at a time
+static uint8_t reference(Kernel kernel, uint8_t d, uint8_t s, uint8_t amount, uint8_t fill) {
+    switch (kernel) {
+        case KERNEL_SCALE: return scale8(d, amount);                                 // nscale8
+        case KERNEL_FADE:  return scale8(d, 255 - amount);                           // fadeToBlackBy
+        case KERNEL_ADD:   return d + s > 255 ? 255 : d + s;                         // qadd8
+        case KERNEL_BLEND: return amount == 0 ? d : ((d * (256 - amount)) >> 8) + ((s * amount) >> 8);
+        default:           return fill;
+    }
+}
+
+static void run(Kernel kernel, CRGB* dst, const CRGB* src, uint16_t count, uint8_t amount, CRGB color) {
+    switch (kernel) {
+        case KERNEL_SCALE: pixelScale(dst, count, amount); break;
+        case KERNEL_FADE:  pixelFade(dst, count, amount); break;
+        case KERNEL_ADD:   pixelAddSaturate(dst, src, count); break;
+        case KERNEL_BLEND: pixelBlend(dst, src, count, amount); break;
+        default:           pixelFill(dst, count, color); break;
+    }
+}
+
+// CRGB is three bytes, so a pixel pointer can start at any byte in a block
+static CRGB* at(uint8_t* base, size_t offset) {
+    return (CRGB*)(base + offset);
+}
+
+int main(int argc, char** argv) {
+    uint32_t pixels = PIXEL_BENCHMARK_PIXELS;
+    uint32_t rounds = 2000;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-p") && i + 1 < argc) pixels = (uint32_t)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc) rounds = (uint32_t)atoi(argv[++i]);
+        else {
+            fprintf(stderr, "usage: pixel_tool [-p PIXELS] [-r ROUNDS]\n");
+            return 2;
+        }
+    }
+
+    bool ok = pixelKernelsBegin();  // The same self-check the device runs at boot
+
+    // Buffers with room for any start offset, aligned to 16 bytes
+    const size_t bytes = MAX_PIXELS * 3 + 32;
+    PIXEL_ALIGN static uint8_t original[bytes];
+    PIXEL_ALIGN static uint8_t source[bytes];
+    PIXEL_ALIGN static uint8_t vector[bytes];
+    PIXEL_ALIGN static uint8_t scalar[bytes];
+    for (size_t i = 0; i < bytes; i++) {
+        original[i] = randomByte();
+        source[i] = randomByte();
+    }
+
+    std::vector<uint16_t> counts;
+    for (uint16_t n = 0; n <= 70; n++) counts.push_back(n);
+    counts.push_back(MAX_PIXELS);
+
+    uint64_t cases = 0, mismatches = 0;
+    for (uint8_t k = 0; k < KERNEL_COUNT; k++) {
+        Kernel kernel = (Kernel)k;
+        uint64_t kernelCases = 0, kernelMismatches = 0;
+        for (uint16_t count : counts) {
+            for (uint8_t dOffset = 0; dOffset < 16; dOffset++) {
+                // Source at the same and at a different offset (the latter can't vectorize)
+                for (uint8_t sOffset : { dOffset, (uint8_t)((dOffset + 5) & 15) }) {
+                    for (uint8_t amount : AMOUNTS) {
+                        CRGB color(amount, (uint8_t)(amount * 3), (uint8_t)~amount);
+                        memcpy(vector, original, bytes);
+                        memcpy(scalar, original, bytes);
+
+                        pixelKernelsSetSimd(true);
+                        run(kernel, at(vector, dOffset), at(source, sOffset), count, amount, color);
+                        pixelKernelsSetSimd(false);
+                        run(kernel, at(scalar, dOffset), at(source, sOffset), count, amount, color);
+
+                        // Same bytes both ways, the reference inside the range, nothing touched outside it
+                        bool same = memcmp(vector, scalar, bytes) == 0;
+                        for (size_t i = 0; i < bytes && same; i++) {
+                            uint8_t expected = original[i];
+                            if (i >= dOffset && i < dOffset + count * 3u) {
+                                size_t byte = i - dOffset;
+                                expected = reference(kernel, original[i], source[sOffset + byte], amount,
+                                                     color.raw[byte % 3]);
+                            }
+                            same = scalar[i] == expected;
+                        }
+                        kernelCases++;
+                        if (!same) {
+                            if (kernelMismatches == 0) {
+                                printf("MISMATCH: %s of %u pixels at offset %u (source %u), amount %u\n",
+                                       KERNEL_NAMES[k], count, dOffset, sOffset, amount);
+                            }
+                            kernelMismatches++;
+                        }
+                    }
+                }
+            }
+        }
+        printf("%-6s %6llu cases, %llu mismatches\n", KERNEL_NAMES[k],
+               (unsigned long long)kernelCases, (unsigned long long)kernelMismatches);
+        cases += kernelCases;
+        mismatches += kernelMismatches;
+    }
+    ok &= mismatches == 0;
+
+    // Throughput of the scalar path on this machine
+    std::vector<uint8_t> a(pixels * 3 + 16), b(pixels * 3 + 16);
+    CRGB* pa = at(a.data(), (16 - ((uintptr_t)a.data() & 15)) & 15);
+    CRGB* pb = at(b.data(), (16 - ((uintptr_t)b.data() & 15)) & 15);
+    for (size_t i = 0; i < a.size(); i++) {
+        a[i] = randomByte();
+        b[i] = randomByte();
+    }
+    pixelKernelsSetSimd(false);
+    printf("scalar path, %u pixels x %u rounds:\n", pixels, rounds);
+    for (uint8_t k = 0; k < KERNEL_COUNT; k++) {
+        auto start = Clock::now();
+        for (uint32_t r = 0; r < rounds; r++) {
+            run((Kernel)k, pa, pb, (uint16_t)pixels, (uint8_t)(100 + (r & 63)), CRGB(255, 128, 0));
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        printf("  %-6s %8.1f MB/s   (byte %u)\n", KERNEL_NAMES[k],
+               pixels * 3.0 * rounds / seconds / 1e6, pa[pixels / 2].r);
+    }
+
+    if (ok) printf("pixel kernels ok (%llu cases)\n", (unsigned long long)cases);
+    return ok ? 0 : 1;
+}
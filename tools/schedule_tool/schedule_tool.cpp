@@ -0,0 +1,363 @@
+// Host-side check for the show scheduler, driven by a fake clock.
+//
+//   - playlist changes stay on their due times (start + sum of durations)
+//     while update() runs at jittery intervals, for hours of show time
+//   - a 22:00-02:00 rule wraps midnight, counting the early hours as part
+//     of the day it started on
+//   - when a rule ends the playlist picks up at the scene it was on
+//   - isValid() refuses modes without content and rules pointing at scenes
+//     that don't exist
+//   - a second submit() before update() replaces the first, and configs
+//     submitted from another thread are never seen half-written
+//
+// Build:  g++ -O2 -std=c++17 -pthread -I../../include schedule_tool.cpp ../../src/show_scheduler.cpp
+//             -o schedule_tool
+// Usage:  schedule_tool [-h HOURS]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "show_scheduler.h"
+
+static const uint16_t MINUTES_PER_DAY = 24 * 60;
+static const uint8_t FRIDAY = 5;
+
+// Wall clock that runs with millis(), from a minute of the week (0 = Sunday 00:00)
+class FakeClock : public ShowClock {
+public:
+    uint32_t now = 0;
+    uint32_t startMinute = 0;
+    bool set = true;
+
+    uint32_t millis() override { return now; }
+    bool localTime(uint16_t& minuteOfDay, uint8_t& weekday) override {
+        if (!set) return false;
+        uint32_t minute = startMinute + now / 60000;
+        minuteOfDay = minute % MINUTES_PER_DAY;
+        weekday = (minute / MINUTES_PER_DAY) % 7;
+        return true;
+    }
+};
+
+struct Change {
+    uint32_t at;
+    int8_t scene;  // -1 = off
+    uint32_t color;
+};
+
+static ShowScheduler* current = nullptr;
+static FakeClock* clockNow = nullptr;
+static std::vector<Change> changes;
+
+static void record(const Scene* scene, void*) {
+    changes.push_back({ clockNow->now, current->getActiveScene(), scene ? scene->color : 0 });
+}
+
+static uint32_t randomState = 12345;
+static uint32_t randomBelow(uint32_t n) {
+    randomState = randomState * 1664525UL + 1013904223UL;
+    return (randomState >> 8) % n;
+}
+
+static Scene scene(uint8_t mode, uint32_t color, uint32_t durationMs) {
+    Scene s;
+    s.mode = mode;
+    s.color = color;
+    s.speed = 50;
+    s.brightness = 128;
+    s.durationMs = durationMs;
+    return s;
+}
+
+static ScheduleConfig playlist(const uint32_t* durations, uint8_t count) {
+    ScheduleConfig config;
+    memset(&config, 0, sizeof(config));
+    config.enabled = true;
+    config.sceneCount = count;
+    for (uint8_t i = 0; i < count; i++) {
+        config.scenes[i] = scene(ANIMATION_RAINBOW + i, 0x100000 * (i + 1), durations[i]);
+    }
+    return config;
+}
+
+static ScheduleRule rule(uint16_t start, uint16_t end, uint8_t days, int8_t sceneIndex) {
+    ScheduleRule r;
+    r.startMinute = start;
+    r.endMinute = end;
+    r.days = days;
+    r.scene = sceneIndex;
+    r.enabled = true;
+    return r;
+}
+
+// Changes land on the first update at or after their due time; lateness never adds up
+static bool checkDrift(uint32_t hours) {
+    FakeClock clock;
+    clock.set = false;  // Playlist only
+    ShowScheduler scheduler(clock, record, nullptr);
+    current = &scheduler;
+    clockNow = &clock;
+    changes.clear();
+
+    const uint32_t durations[] = { 1000, 1500, 700, 2300 };
+    const uint8_t count = 4;
+    scheduler.submit(playlist(durations, count));
+
+    const uint32_t maxGap = 45;
+    uint32_t end = hours * 3600000UL;
+    while (clock.now < end) {
+        scheduler.update();
+        clock.now += 5 + randomBelow(maxGap - 5 + 1);  // 5..45 ms between frames
+    }
+
+    uint32_t due = 0, worst = 0;
+    bool ok = !changes.empty() && changes[0].at == 0;
+    for (size_t i = 0; i < changes.size() && ok; i++) {
+        uint8_t index = (uint8_t)(i % count);
+        ok = changes[i].scene == index && changes[i].at >= due && changes[i].at - due < maxGap;
+        if (changes[i].at - due > worst) worst = changes[i].at - due;
+        due += durations[index];
+    }
+    printf("drift: %zu changes over %u h, each at most %u ms after its due time, %s\n",
+           changes.size(), hours, worst, ok ? "none accumulated" : "DRIFTED");
+    return ok;
+}
+
+// 22:00-02:00 on Fridays only: the early hours belong to Friday, so they fall on Saturday
+static bool checkMidnight() {
+    ScheduleRule r = rule(22 * 60, 2 * 60, 1 << FRIDAY, 0);
+    struct Case {
+        uint8_t weekday;
+        uint16_t minute;
+        bool expected;
+    };
+    const Case cases[] = {
+        { FRIDAY, 21 * 60 + 59, false },
+        { FRIDAY, 22 * 60, true },
+        { FRIDAY, 23 * 60 + 59, true },
+        { FRIDAY + 1, 0, true },
+        { FRIDAY + 1, 1 * 60 + 59, true },
+        { FRIDAY + 1, 2 * 60, false },   // End is exclusive
+        { FRIDAY + 1, 23 * 60, false },  // Saturday night isn't in the rule
+        { FRIDAY, 1 * 60, false },       // Friday's early hours belong to Thursday
+        { 0, 0, false },                 // Sunday 00:00 follows Saturday, not Friday
+    };
+    bool ok = true;
+    for (const Case& c : cases) {
+        if (ShowScheduler::ruleMatches(r, c.minute, c.weekday) != c.expected) {
+            printf("  day %u %02u:%02u should %smatch\n", c.weekday, c.minute / 60, c.minute % 60,
+                   c.expected ? "" : "not ");
+            ok = false;
+        }
+    }
+
+    // Same rule through the scheduler: on at 22:00 Friday, off at 02:00 Saturday
+    FakeClock clock;
+    clock.startMinute = FRIDAY * MINUTES_PER_DAY + 21 * 60 + 59;
+    ShowScheduler scheduler(clock, record, nullptr);
+    current = &scheduler;
+    clockNow = &clock;
+    changes.clear();
+    ScheduleConfig config;
+    memset(&config, 0, sizeof(config));
+    config.enabled = true;
+    config.sceneCount = 1;
+    config.scenes[0] = scene(ANIMATION_FIRE, 0xFF4000, 0);
+    config.rules[0] = rule(22 * 60, 2 * 60, 1 << FRIDAY, 0);
+    scheduler.submit(config);
+    uint32_t on = 0, off = 0;
+    for (clock.now = 0; clock.now < 6 * 3600000UL; clock.now += 1000) {
+        int8_t before = scheduler.getActiveRule();
+        scheduler.update();
+        if (before < 0 && scheduler.getActiveRule() == 0) on = clock.now;
+        if (before == 0 && scheduler.getActiveRule() < 0) off = clock.now;
+    }
+    ok &= on == 60000 && off == (4 * 60 + 1) * 60000UL;
+    printf("midnight: 22:00-02:00 Friday rule %s (on after %u min, off after %u min)\n",
+           ok ? "wraps into Saturday morning" : "WRONG", on / 60000, off / 60000);
+    return ok;
+}
+
+// A rule takes over mid-playlist and hands back to the scene it interrupted
+static bool checkHandBack() {
+    FakeClock clock;
+    clock.startMinute = 12 * 60;  // Sunday noon
+    ShowScheduler scheduler(clock, record, nullptr);
+    current = &scheduler;
+    clockNow = &clock;
+    changes.clear();
+
+    const uint32_t durations[] = { 40000, 40000, 40000 };
+    ScheduleConfig config = playlist(durations, 3);
+    config.rules[0] = rule(12 * 60 + 1, 12 * 60 + 3, 0x7F, -1);  // Lights off 12:01-12:03
+    scheduler.submit(config);
+
+    for (clock.now = 0; clock.now <= 4 * 60000UL; clock.now += 100) {
+        scheduler.update();
+    }
+    // Scene 0 at 0 s, scene 1 at 40 s, off at 60 s, scene 1 again at 180 s, scene 2 40 s later
+    bool ok = changes.size() == 5 &&
+              changes[0].scene == 0 && changes[0].at == 0 &&
+              changes[1].scene == 1 && changes[1].at == 40000 &&
+              changes[2].scene == -1 && changes[2].at == 60000 &&
+              changes[3].scene == 1 && changes[3].at == 180000 &&
+              changes[4].scene == 2 && changes[4].at == 220000;
+    printf("hand-back: playlist %s after the rule ends\n", ok ? "resumes the interrupted scene" : "DIDN'T resume");
+    if (!ok) {
+        for (const Change& c : changes) printf("  %u ms: scene %d\n", c.at, c.scene);
+    }
+    return ok;
+}
+
+static bool checkValidation() {
+    const uint32_t durations[] = { 1000, 1000 };
+    const ScheduleConfig base = playlist(durations, 2);
+    struct Case {
+        const char* what;
+        ScheduleConfig config;
+        bool expected;
+    };
+    std::vector<Case> cases;
+    cases.push_back({ "two plain scenes", base, true });
+    for (uint8_t mode : { (uint8_t)ANIMATION_CUSTOM, (uint8_t)ANIMATION_SEQUENCE, (uint8_t)MAX_ANIMATIONS }) {
+        ScheduleConfig c = base;
+        c.scenes[1].mode = mode;
+        cases.push_back({ mode == ANIMATION_CUSTOM ? "Custom scene" : mode == ANIMATION_SEQUENCE ? "Sequence scene"
+                                                                                                   : "unknown mode",
+                          c, false });
+    }
+    ScheduleConfig last = base;
+    last.scenes[1].mode = ANIMATION_PARTICLE_EMBERS;
+    cases.push_back({ "last mode", last, true });
+    ScheduleConfig offRule = base;
+    offRule.rules[0] = rule(60, 120, 0x7F, -1);
+    cases.push_back({ "lights-off rule", offRule, true });
+    ScheduleConfig missing = base;
+    missing.rules[0] = rule(60, 120, 0x7F, 2);
+    cases.push_back({ "rule past the last scene", missing, false });
+    ScheduleConfig negative = base;
+    negative.rules[0] = rule(60, 120, 0x7F, -2);
+    cases.push_back({ "rule scene -2", negative, false });
+    ScheduleConfig late = base;
+    late.rules[0] = rule(MINUTES_PER_DAY, 120, 0x7F, 0);
+    cases.push_back({ "start at 24:00", late, false });
+    ScheduleConfig disabled = base;
+    disabled.rules[0] = rule(MINUTES_PER_DAY, 120, 0x7F, 9);
+    disabled.rules[0].enabled = false;
+    cases.push_back({ "disabled rule slot", disabled, true });
+    ScheduleConfig many = base;
+    many.sceneCount = SCHEDULE_MAX_SCENES + 1;
+    cases.push_back({ "too many scenes", many, false });
+
+    FakeClock clock;
+    ShowScheduler scheduler(clock, record, nullptr);
+    bool ok = true;
+    for (const Case& c : cases) {
+        bool valid = ShowScheduler::isValid(c.config);
+        bool submitted = scheduler.submit(c.config);
+        if (valid != c.expected || submitted != c.expected) {
+            printf("  %s: %s\n", c.what, valid ? "accepted" : "refused");
+            ok = false;
+        }
+    }
+    printf("validation: %zu configs %s\n", cases.size(), ok ? "accepted or refused as expected" : "MISJUDGED");
+    return ok;
+}
+
+// Two submits before update(): the second replaces the first, which never plays
+static bool checkPending() {
+    FakeClock clock;
+    clock.set = false;
+    ShowScheduler scheduler(clock, record, nullptr);
+    current = &scheduler;
+    clockNow = &clock;
+    changes.clear();
+
+    const uint32_t durations[] = { 1000 };
+    ScheduleConfig first = playlist(durations, 1);
+    first.scenes[0].color = 0x111111;
+    ScheduleConfig second = first;
+    second.scenes[0].color = 0x222222;
+    bool ok = scheduler.submit(first) && scheduler.submit(second);
+    ScheduleConfig seen;
+    scheduler.getConfig(seen);
+    ok &= seen.scenes[0].color == 0x222222;
+    ok &= changes.empty();  // Nothing happens until update()
+    scheduler.update();
+    ok &= changes.size() == 1 && changes[0].color == 0x222222;
+    scheduler.update();
+    ok &= changes.size() == 1;  // Taken once
+    printf("pending: a second submit %s the first\n", ok ? "replaces" : "DOESN'T replace");
+    return ok;
+}
+
+// A writer thread submits configs whose scenes all carry the same tag while
+// update() runs through them a scene per call; every scene that plays must
+// carry the tag of the config its playlist started with
+static uint32_t playingTag = 0;
+static uint32_t tornScenes = 0;
+
+static void checkTag(const Scene* s, void*) {
+    if (!s) return;
+    if (current->getActiveScene() == 0) playingTag = s->color;  // A new config starts at scene 0
+    if (s->color != playingTag || s->speed != (uint16_t)s->color) tornScenes++;
+}
+
+static bool checkConcurrent() {
+    FakeClock clock;
+    clock.set = false;
+    ShowScheduler scheduler(clock, checkTag, nullptr);
+    current = &scheduler;
+
+    std::atomic<bool> done(false);
+    uint32_t accepted = 0, busy = 0;
+    std::thread writer([&]() {
+        for (uint32_t tag = 1; tag <= 1000000; tag++) {
+            ScheduleConfig config;
+            memset(&config, 0, sizeof(config));
+            config.enabled = true;
+            config.sceneCount = SCHEDULE_MAX_SCENES;
+            for (uint8_t i = 0; i < SCHEDULE_MAX_SCENES; i++) {
+                config.scenes[i] = scene(ANIMATION_STATIC, tag, 1);
+                config.scenes[i].speed = (uint16_t)tag;
+            }
+            if (scheduler.submit(config)) accepted++;
+            else busy++;
+        }
+        done = true;
+    });
+    uint32_t updates = 0;
+    while (!done) {
+        scheduler.update();
+        clock.now++;
+        updates++;
+    }
+    writer.join();
+    bool ok = tornScenes == 0 && accepted > 0;
+    printf("concurrent: %u submits taken, %u refused as busy, %u updates, %u torn scenes\n",
+           accepted, busy, updates, tornScenes);
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    uint32_t hours = 6;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-h") && i + 1 < argc) hours = (uint32_t)atoi(argv[++i]);
+        else {
+            fprintf(stderr, "usage: schedule_tool [-h HOURS]\n");
+            return 2;
+        }
+    }
+
+    bool ok = checkDrift(hours);
+    ok &= checkMidnight();
+    ok &= checkHandBack();
+    ok &= checkValidation();
+    ok &= checkPending();
+    ok &= checkConcurrent();
+    if (ok) printf("schedule ok\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,150 @@
+// Host-side round-trip check for the multi-view triangulation import.
+//
+// Winds NUM_LEDS up a helix like a strip on a tree, renders it into
+// orthographic views at the given angles (each with its own pixel scale,
+// offset and a share of LEDs hidden behind the tree), adds pixel noise and
+// feeds the views to the same TriangulationSolver /api/calibration/import
+// uses. The result is compared with the helix normalized the same way
+// (bounding-box centre, one scale for all axes). Checks: every run lands
+// within the error limit, four views beat two, and views that all look
+// from the same direction are refused rather than given a flat answer.
+//
+// Build:  g++ -O2 -std=c++17 -I../../include triangulation_tool.cpp ../../src/triangulation.cpp
+//             -o triangulation_tool
+// Usage:  triangulation_tool [-n NOISE_PIXELS] [-d DROP_FRACTION]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "triangulation.h"
+
+static const float PI_F = 3.14159265f;
+static const float MAX_ERROR = 0.05f;  // In normalized units (the tree spans -1..1)
+
+static LEDPosition helix[NUM_LEDS];
+static LEDPosition expected[NUM_LEDS];
+
+static float randomUnit() {
+    return (float)rand() / RAND_MAX * 2.0f - 1.0f;
+}
+
+// The normalization solve() applies, so results compare directly
+static void normalize(const LEDPosition* in, LEDPosition* out) {
+    float lo[3] = { in[0].x, in[0].y, in[0].z };
+    float hi[3] = { in[0].x, in[0].y, in[0].z };
+    for (uint16_t i = 1; i < NUM_LEDS; i++) {
+        float v[3] = { in[i].x, in[i].y, in[i].z };
+        for (uint8_t a = 0; a < 3; a++) {
+            if (v[a] < lo[a]) lo[a] = v[a];
+            if (v[a] > hi[a]) hi[a] = v[a];
+        }
+    }
+    float center[3];
+    float halfExtent = 0;
+    for (uint8_t a = 0; a < 3; a++) {
+        center[a] = (lo[a] + hi[a]) * 0.5f;
+        halfExtent = fmaxf(halfExtent, (hi[a] - lo[a]) * 0.5f);
+    }
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        out[i] = { (in[i].x - center[0]) / halfExtent,
+                   (in[i].y - center[1]) / halfExtent,
+                   (in[i].z - center[2]) / halfExtent };
+    }
+}
+
+// A photo from angleDegrees: pixels with v downward, at an arbitrary zoom and
+// framing, with LEDs on the far side sometimes hidden
+static void render(float angleDegrees, float noise, float drop, ImagePoint* points) {
+    float a = angleDegrees * PI_F / 180.0f;
+    float pixelsPerUnit = 300.0f + 200.0f * (randomUnit() + 1.0f);
+    float offsetU = 640.0f + 100.0f * randomUnit();
+    float offsetV = 480.0f + 100.0f * randomUnit();
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        const LEDPosition& p = helix[i];
+        float u = p.x * cosf(a) - p.z * sinf(a);
+        float depth = p.x * sinf(a) + p.z * cosf(a);  // Away from the camera
+        points[i].u = offsetU + u * pixelsPerUnit + noise * randomUnit();
+        points[i].v = offsetV - p.y * pixelsPerUnit + noise * randomUnit();
+        points[i].seen = !(depth > 0 && (randomUnit() + 1.0f) * 0.5f < drop);
+    }
+}
+
+// Solve from the given views; max error against the helix, or -1 if refused
+static float roundTrip(const char* name, const float* angles, uint8_t views, float noise, float drop) {
+    static ImagePoint points[NUM_LEDS];
+    static LEDPosition solved[NUM_LEDS];
+    TriangulationSolver solver(NUM_LEDS);
+    for (uint8_t k = 0; k < views; k++) {
+        render(angles[k], noise, drop, points);
+        solver.addView(angles[k], points);
+    }
+    if (!solver.solve(solved)) {
+        printf("%-16s refused\n", name);
+        return -1;
+    }
+
+    float maxError = 0, sumSq = 0;
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        float dx = solved[i].x - expected[i].x;
+        float dy = solved[i].y - expected[i].y;
+        float dz = solved[i].z - expected[i].z;
+        float d = sqrtf(dx * dx + dy * dy + dz * dz);
+        maxError = fmaxf(maxError, d);
+        sumSq += d * d;
+    }
+    printf("%-16s %3u triangulated, %3u interpolated, reprojection rms %.4f, error rms %.4f max %.4f\n",
+           name, solver.getTriangulatedCount(), solver.getInterpolatedCount(), solver.getRmsError(),
+           sqrtf(sumSq / NUM_LEDS), maxError);
+    return maxError;
+}
+
+int main(int argc, char** argv) {
+    float noise = 0.5f;
+    float drop = 0.3f;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) noise = (float)atof(argv[++i]);
+        else if (!strcmp(argv[i], "-d") && i + 1 < argc) drop = (float)atof(argv[++i]);
+        else {
+            fprintf(stderr, "usage: triangulation_tool [-n NOISE_PIXELS] [-d DROP_FRACTION]\n");
+            return 2;
+        }
+    }
+    srand(1);
+
+    // Six turns up a cone, narrowing towards the top
+    for (uint16_t i = 0; i < NUM_LEDS; i++) {
+        float h = (float)i / (NUM_LEDS - 1);
+        float angle = h * 6.0f * 2.0f * PI_F;
+        float radius = 0.6f * (1.0f - 0.8f * h);
+        helix[i] = { radius * cosf(angle), 1.6f * h, radius * sinf(angle) };
+    }
+    normalize(helix, expected);
+    printf("%u LEDs, %.1f px noise, %.0f%% of the far side hidden\n", NUM_LEDS, noise, drop * 100);
+
+    static const float FOUR[] = { 0, 90, 180, 270 };
+    static const float TWO[] = { 0, 90 };
+    static const float UNEVEN[] = { 10, 75, 160, 230, 300 };
+    static const float SAME[] = { 45, 45, 45 };
+
+    bool ok = true;
+    float four = roundTrip("4 views", FOUR, 4, noise, drop);
+    float two = roundTrip("2 views", TWO, 2, 0, 0);
+    float uneven = roundTrip("5 uneven views", UNEVEN, 5, noise, drop);
+    float same = roundTrip("3 same-angle", SAME, 3, noise, 0);
+
+    if (four < 0 || four > MAX_ERROR || uneven < 0 || uneven > MAX_ERROR) {
+        printf("ERROR: noisy round trip is off by more than %.2f\n", MAX_ERROR);
+        ok = false;
+    }
+    if (two < 0 || two > MAX_ERROR / 5) {
+        printf("ERROR: two clean views should be near exact\n");
+        ok = false;
+    }
+    if (same >= 0) {
+        printf("ERROR: views from one direction can't fix depth but were accepted\n");
+        ok = false;
+    }
+    if (ok) printf("triangulation ok\n");
+    return ok ? 0 : 1;
+}